@@ -19,31 +19,10 @@ INCLUDE_LOWERCASE=false
 INCLUDE_DIGITS=false
 INCLUDE_SPECIAL=false
 
-# Detect a sane default thread count (1-16 range, default to 4 if detection fails)
-detect_threads() {
-    local detected
-    if detected=$(getconf _NPROCESSORS_ONLN 2>/dev/null); then
-        :
-    elif detected=$(sysctl -n hw.ncpu 2>/dev/null); then
-        :
-    else
-        detected=4
-    fi
-
-    if ! [[ "$detected" =~ ^[0-9]+$ ]]; then
-        detected=4
-    fi
-
-    if (( detected < 1 )); then
-        detected=4
-    elif (( detected > 16 )); then
-        detected=16
-    fi
-
-    printf '%s' "$detected"
-}
-
-THREADS="$(detect_threads)"
+# Empty means "let the executable decide": it sizes the pool from the CPUs this
+# process may use (affinity mask and cgroup quota) and --autotune refines it.
+THREADS=""
+AUTOTUNE=1
 
 print_usage() {
     cat <<'USAGE'
@@ -52,7 +31,9 @@ Usage: full_speed_build_and_run.sh [options] [-- <extra args>]
 Options:
   --pdf <path>              Path to the encrypted PDF file (default: file.pdf)
   --wordlist <path>         Path to a password wordlist
-  --threads <n>             Number of worker threads (clamped to 1-16, default: auto)
+  --threads <n>             Number of worker threads (default: auto)
+  --autotune                Calibrate threads and batch size, cached per CPU (default)
+  --no-autotune             Skip calibration and use the automatic thread count
   --min-length <n>          Minimum password length (default: 6)
   --max-length <n>          Maximum password length (default: 6)
   --include-uppercase       Require uppercase letters in the search space (default: on)
@@ -101,6 +82,12 @@ while [[ $# -gt 0 ]]; do
             ensure_numeric "--threads" "$1"
             THREADS="$1"
             ;;
+        --autotune)
+            AUTOTUNE=1
+            ;;
+        --no-autotune)
+            AUTOTUNE=0
+            ;;
         --min-length)
             shift
             [[ $# -gt 0 ]] || { echo "Missing value for --min-length" >&2; exit 1; }
@@ -172,11 +159,8 @@ while [[ $# -gt 0 ]]; do
     shift || true
 done
 
-ensure_numeric "--threads" "$THREADS"
-if (( THREADS < 1 )); then
+if [[ -n "$THREADS" ]] && (( THREADS < 1 )); then
     THREADS=1
-elif (( THREADS > 16 )); then
-    THREADS=16
 fi
 
 if (( MIN_LENGTH < 0 || MAX_LENGTH < 0 )); then
@@ -229,7 +213,13 @@ if [[ ! -x "$EXECUTABLE" ]]; then
     exit 1
 fi
 
-RUN_ARGS=("--threads" "$THREADS" "--pdf" "$PDF")
+RUN_ARGS=("--pdf" "$PDF")
+if [[ -n "$THREADS" ]]; then
+    RUN_ARGS+=("--threads" "$THREADS")
+fi
+if (( AUTOTUNE )); then
+    RUN_ARGS+=("--autotune")
+fi
 if [[ -n "$WORDLIST" ]]; then
     RUN_ARGS+=("--wordlist" "$WORDLIST")
 fi
@@ -264,7 +254,7 @@ if (( ${#EXTRA_ARGS[@]} )); then
 fi
 
 echo
-printf 'Launching %s with %s thread(s):\n' "$TARGET" "$THREADS"
+printf 'Launching %s with %s thread(s):\n' "$TARGET" "${THREADS:-auto}"
 echo "    ${RUN_ARGS[*]}"
 echo
 
@@ -11,6 +11,7 @@ same while providing a more welcoming interface and easier to follow code.
 
 from __future__ import annotations
 
+import json
 import os
 import shlex
 import subprocess
@@ -413,8 +414,8 @@ class UnlockPDFGui:
         if args is None:
             return
         pdf = self.pdf_var.get().strip()
-        command = args[:1] + ["--pdf", pdf] + args[1:]
-        self._execute(command, f"Starting crack for: {pdf}\n")
+        command = args[:1] + ["--pdf", pdf, "--progress-format", "jsonl"] + args[1:]
+        self._execute(command, f"Starting crack for: {pdf}\n", structured_progress=True)
 
     def _run_device_probe(self) -> None:
         device_probe = self._validate_device_probe()
@@ -430,7 +431,7 @@ class UnlockPDFGui:
             header += "Using default settings\n\n"
         self._execute(command, header)
 
-    def _execute(self, command: list[str], header: str) -> None:
+    def _execute(self, command: list[str], header: str, structured_progress: bool = False) -> None:
         if self._runner and self._runner.is_alive():
             messagebox.showinfo("Process running", "Another operation is already in progress.")
             return
@@ -459,6 +460,7 @@ class UnlockPDFGui:
                 self._toggle_buttons(running=False)
                 return
 
+            final_status: str | None = None
             with process.stdout:
                 for line in iter(process.stdout.readline, ""):
                     if self._stop_event.is_set():
@@ -466,18 +468,116 @@ class UnlockPDFGui:
                         self._append_output("Process terminated by user.\n")
                         self._set_status("Stopped by user")
                         break
-                    self._append_output(line)
+                    event = self._parse_event(line) if structured_progress else None
+                    if event is None:
+                        self._append_output(line)
+                        continue
+                    final_status = self._handle_event(event) or final_status
             return_code = process.wait()
             if return_code is not None and return_code != 0 and not self._stop_event.is_set():
                 self._append_output(f"\nProcess exited with code {return_code}.\n")
-                self._set_status(f"Process exited with code {return_code}")
+                self._set_status(final_status or f"Process exited with code {return_code}")
             elif not self._stop_event.is_set():
-                self._set_status("Completed")
+                self._set_status(final_status or "Completed")
             self._toggle_buttons(running=False)
 
         self._runner = threading.Thread(target=worker, daemon=True)
         self._runner.start()
 
+    # ------------------------------------------------------------------
+    # Structured progress events (--progress-format jsonl)
+    # ------------------------------------------------------------------
+    @staticmethod
+    def _parse_event(line: str) -> dict | None:
+        """Return the event carried by ``line`` or ``None`` for ordinary output."""
+
+        if not line.startswith("{"):
+            return None
+        try:
+            event = json.loads(line)
+        except json.JSONDecodeError:
+            return None
+        if not isinstance(event, dict) or "event" not in event:
+            return None
+        return event
+
+    @staticmethod
+    def _format_rate(per_second: float) -> str:
+        for suffix, scale in (("G", 1e9), ("M", 1e6), ("k", 1e3)):
+            if per_second >= scale:
+                return f"{per_second / scale:.2f}{suffix}"
+        return f"{per_second:.0f}"
+
+    @staticmethod
+    def _format_duration(seconds: float) -> str:
+        total = int(seconds + 0.5)
+        days, remainder = divmod(total, 86400)
+        hours, remainder = divmod(remainder, 3600)
+        minutes, secs = divmod(remainder, 60)
+        text = f"{hours:02d}:{minutes:02d}:{secs:02d}"
+        return f"{days}d {text}" if days else text
+
+    def _handle_event(self, event: dict) -> str | None:
+        """Update the output and status from one event; returns a final status if any."""
+
+        kind = event.get("event")
+        if kind == "start":
+            keyspace = event.get("keyspace")
+            keyspace_text = f"{keyspace:,}" if isinstance(keyspace, int) else "unknown"
+            self._append_output(
+                f"Started {event.get('mode', 'crack')} run: {event.get('threads')} thread(s), "
+                f"keyspace {keyspace_text}\n"
+            )
+            self._set_progress(0.0 if isinstance(keyspace, int) else None)
+        elif kind == "progress":
+            tried = event.get("tried", 0)
+            total = event.get("total")
+            percent = event.get("percent")
+            status = f"Tried {tried:,}"
+            if isinstance(total, int) and isinstance(percent, (int, float)):
+                status += f" of {total:,} ({percent:.1f}%)"
+            status += f" | {self._format_rate(float(event.get('rate', 0.0)))}/s"
+            eta = event.get("eta")
+            if isinstance(eta, (int, float)):
+                status += f" | ETA {self._format_duration(float(eta))}"
+            self._set_status(status)
+            if isinstance(percent, (int, float)):
+                self._set_progress(float(percent))
+        elif kind == "found":
+            self._append_output(f"\nPASSWORD FOUND [{event.get('variant', '')}]: {event.get('password', '')}\n")
+            return "Password found"
+        elif kind == "finished":
+            tried = event.get("tried", 0)
+            elapsed = float(event.get("elapsed", 0.0))
+            success = bool(event.get("success"))
+            self._append_output(
+                f"Finished after {tried:,} candidates in {self._format_duration(elapsed)}"
+                f" - password {'found' if success else 'not found'}.\n"
+            )
+            self._set_progress(100.0)
+            return "Password found" if success else "Completed - password not found"
+        elif kind == "error":
+            message = event.get("message", "unknown error")
+            self._append_output(f"Error: {message}\n")
+            return f"Error: {message}"
+        return None
+
+    def _set_progress(self, percent: float | None) -> None:
+        """Show a determinate bar for ``percent`` or the busy animation for ``None``."""
+
+        def update() -> None:
+            if percent is None:
+                if str(self.progress.cget("mode")) != "indeterminate":
+                    self.progress.configure(mode="indeterminate", maximum=80)
+                    self.progress.start(12)
+                return
+            if str(self.progress.cget("mode")) != "determinate":
+                self.progress.stop()
+                self.progress.configure(mode="determinate", maximum=100)
+            self.progress["value"] = max(0.0, min(percent, 100.0))
+
+        self.master.after(0, update)
+
     def _stop_process(self) -> None:
         if self._runner and self._runner.is_alive():
             self._stop_event.set()
@@ -492,6 +592,7 @@ class UnlockPDFGui:
                 widget.configure(state=state_run)
             self.stop_button.configure(state=state_stop)
             if running:
+                self.progress.configure(mode="indeterminate", maximum=80)
                 self.progress.start(12)
             else:
                 self.progress.stop()
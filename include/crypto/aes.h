@@ -17,6 +17,17 @@ private:
     bool valid_ = false;
 };
 
+class AES256Encryptor {
+public:
+    explicit AES256Encryptor(const std::vector<unsigned char>& key);
+    bool valid() const;
+    void encrypt_block(const unsigned char* input, unsigned char* output) const;
+
+private:
+    std::array<std::array<unsigned char, 16>, 15> round_keys_{};
+    bool valid_ = false;
+};
+
 class AES256Decryptor {
 public:
     explicit AES256Decryptor(const std::vector<unsigned char>& key);
@@ -33,6 +44,11 @@ bool aes128_cbc_encrypt(const std::vector<unsigned char>& key,
                         const std::vector<unsigned char>& plaintext,
                         std::vector<unsigned char>& ciphertext);
 
+bool aes256_cbc_encrypt(const std::vector<unsigned char>& key,
+                        const std::vector<unsigned char>& iv,
+                        const std::vector<unsigned char>& plaintext,
+                        std::vector<unsigned char>& ciphertext);
+
 bool aes256_cbc_decrypt(const std::vector<unsigned char>& key,
                         const std::vector<unsigned char>& iv,
                         const std::vector<unsigned char>& ciphertext,
@@ -2,6 +2,7 @@
 #define UNLOCK_PDF_CRYPTO_SHA2_H
 
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace unlock_pdf::crypto {
@@ -10,6 +11,24 @@ std::vector<unsigned char> sha256_bytes(const std::vector<unsigned char>& data);
 void sha256_digest(const unsigned char* data, std::size_t len, unsigned char* out);
 std::vector<unsigned char> sha2_hash(const std::vector<unsigned char>& data, std::size_t bits);
 
+// Incremental SHA-256 for data that is not in memory at once.
+class Sha256Context {
+public:
+    Sha256Context();
+    ~Sha256Context();
+
+    Sha256Context(const Sha256Context&) = delete;
+    Sha256Context& operator=(const Sha256Context&) = delete;
+
+    void update(const unsigned char* data, std::size_t len);
+    // Writes the 32-byte digest; the context starts over afterwards.
+    void finalize(unsigned char* out);
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
 }  // namespace unlock_pdf::crypto
 
 #endif  // UNLOCK_PDF_CRYPTO_SHA2_H
@@ -0,0 +1,36 @@
+#ifndef UNLOCK_PDF_PDF_AUTOTUNE_H
+#define UNLOCK_PDF_PDF_AUTOTUNE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "pdf/encryption/encryption_handler.h"
+#include "pdf/pdf_types.h"
+
+namespace unlock_pdf::pdf {
+
+struct AutotuneResult {
+    unsigned int thread_count = 1;
+    std::size_t batch_size = 1;
+    std::string kernel_variant = "scalar";
+    double candidates_per_second = 0.0;
+    bool from_cache = false;
+};
+
+// Picks the worker thread count, candidate batch size and kernel variant for
+// `info` by timing the real password handlers for a short calibration window
+// per thread count (1, 2, 4, ... up to `max_threads`). Results are cached per
+// CPU model and security handler revision in the user cache directory, so only
+// the first run on a machine pays for the calibration.
+AutotuneResult autotune_cracking(const PDFEncryptInfo& info,
+                                 const std::vector<const EncryptionHandler*>& handlers,
+                                 unsigned int max_threads);
+
+// Default candidates per source fetch when no tuning was requested. Expensive
+// revisions take small batches so the tail of a wordlist stays balanced.
+std::size_t default_batch_size(const PDFEncryptInfo& info);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_AUTOTUNE_H
@@ -0,0 +1,184 @@
+#ifndef UNLOCK_PDF_PDF_CRACK_METRICS_H
+#define UNLOCK_PDF_PDF_CRACK_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Build with -DUNLOCK_PDF_ENABLE_METRICS=OFF to remove the instrumentation:
+// the hot-path types below then collapse to empty inline no-ops.
+#if defined(UNLOCK_PDF_ENABLE_METRICS) && UNLOCK_PDF_ENABLE_METRICS
+#define UNLOCK_PDF_METRICS_ENABLED 1
+#else
+#define UNLOCK_PDF_METRICS_ENABLED 0
+#endif
+
+namespace unlock_pdf::pdf {
+
+constexpr bool kMetricsEnabled = UNLOCK_PDF_METRICS_ENABLED != 0;
+
+// Handlers beyond this index share the last slot; a real file never has more
+// than a handful of password handlers.
+constexpr std::size_t kMaxMetricHandlers = 8;
+
+enum class MetricPhase : std::size_t {
+    Generation = 0,    // producing candidates (wordlist reads, brute-force stepping)
+    Verification,      // password handler calls
+    QueueWait,         // waiting for the shared candidate source
+};
+constexpr std::size_t kMetricPhaseCount = 3;
+
+struct MetricsOptions {
+    std::string jsonl_path;          // append one JSON object per snapshot
+    std::string prometheus_path;     // node-exporter textfile collector format
+    std::chrono::milliseconds interval{5000};
+
+    bool requested() const { return !jsonl_path.empty() || !prometheus_path.empty(); }
+};
+
+#if UNLOCK_PDF_METRICS_ENABLED
+
+// Single-writer counter, same scheme as ThreadCounter: only the owning worker
+// stores, the snapshot writer only loads.
+struct MetricCounter {
+    std::atomic<std::uint64_t> value{0};
+
+    void add(std::uint64_t count) {
+        value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+    std::uint64_t load() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Per-worker counters on their own cache lines. Phase times are sampled: only
+// one work unit (a batch, or a single brute-force candidate) in
+// kSampleInterval is timed, and totals are extrapolated from the samples.
+struct alignas(64) ThreadMetrics {
+    static constexpr std::uint32_t kSampleInterval = 16;
+
+    MetricCounter generated;
+    MetricCounter units;
+    MetricCounter sampled_units;
+    MetricCounter batch_filled;
+    MetricCounter batch_capacity;
+    std::array<MetricCounter, kMaxMetricHandlers> verified;
+    std::array<MetricCounter, kMetricPhaseCount> sampled_nanoseconds;
+
+    // Starts a work unit and decides whether its phases are timed.
+    void begin_unit() {
+        units.add(1);
+        sampling_ = (tick_++ % kSampleInterval) == 0;
+        if (sampling_) {
+            sampled_units.add(1);
+        }
+    }
+    bool sampling() const { return sampling_; }
+
+    void add_generated(std::uint64_t count) { generated.add(count); }
+    void add_batch(std::size_t filled, std::size_t capacity) {
+        batch_filled.add(filled);
+        batch_capacity.add(capacity);
+    }
+    void add_verified(std::size_t handler_index) {
+        verified[handler_index < kMaxMetricHandlers ? handler_index : kMaxMetricHandlers - 1].add(1);
+    }
+    void add_phase_time(MetricPhase phase, std::uint64_t nanoseconds) {
+        sampled_nanoseconds[static_cast<std::size_t>(phase)].add(nanoseconds);
+    }
+
+private:
+    std::uint32_t tick_ = 0;
+    bool sampling_ = false;
+};
+
+// Times the enclosing scope into `phase` when the current unit is sampled.
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(ThreadMetrics& metrics, MetricPhase phase) : metrics_(metrics), phase_(phase) {
+        if (metrics_.sampling()) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedPhaseTimer() {
+        if (metrics_.sampling()) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            metrics_.add_phase_time(
+                phase_, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    ThreadMetrics& metrics_;
+    MetricPhase phase_;
+    std::chrono::steady_clock::time_point start_{};
+};
+
+// Owns the per-thread metrics of one cracking run and writes the periodic
+// snapshots. Snapshots are driven by the progress reporter thread, so workers
+// never perform I/O.
+class CrackMetrics {
+public:
+    CrackMetrics(std::size_t thread_count, std::vector<std::string> handler_names, const MetricsOptions& options);
+
+    CrackMetrics(const CrackMetrics&) = delete;
+    CrackMetrics& operator=(const CrackMetrics&) = delete;
+
+    ThreadMetrics& thread(std::size_t thread_index) { return threads_[thread_index]; }
+
+    // `tried` holds the per-thread verified-candidate counts of the progress
+    // reporter. A snapshot is written when the interval has elapsed, or
+    // always when `final` is set.
+    void on_report(std::chrono::steady_clock::time_point now, const std::vector<std::uint64_t>& tried, bool final);
+
+private:
+    void write_snapshot(std::chrono::steady_clock::time_point now, const std::vector<std::uint64_t>& tried, bool final);
+
+    std::vector<ThreadMetrics> threads_;
+    std::vector<std::string> handler_names_;
+    MetricsOptions options_;
+    std::ofstream jsonl_;
+    bool active_ = false;
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point previous_snapshot_;
+    std::vector<std::uint64_t> previous_tried_;
+};
+
+#else  // !UNLOCK_PDF_METRICS_ENABLED
+
+struct ThreadMetrics {
+    void begin_unit() {}
+    bool sampling() const { return false; }
+    void add_generated(std::uint64_t) {}
+    void add_batch(std::size_t, std::size_t) {}
+    void add_verified(std::size_t) {}
+    void add_phase_time(MetricPhase, std::uint64_t) {}
+};
+
+class ScopedPhaseTimer {
+public:
+    ScopedPhaseTimer(ThreadMetrics&, MetricPhase) {}
+};
+
+class CrackMetrics {
+public:
+    CrackMetrics(std::size_t, std::vector<std::string>, const MetricsOptions&) {}
+
+    ThreadMetrics& thread(std::size_t) { return thread_; }
+    void on_report(std::chrono::steady_clock::time_point, const std::vector<std::uint64_t>&, bool) {}
+
+private:
+    ThreadMetrics thread_;
+};
+
+#endif  // UNLOCK_PDF_METRICS_ENABLED
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_CRACK_METRICS_H
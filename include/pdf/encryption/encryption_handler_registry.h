@@ -9,6 +9,10 @@ namespace unlock_pdf::pdf {
 
 std::vector<EncryptionHandlerPtr> create_default_encryption_handlers();
 
+// Handlers that accept the document and need a password, in registry order.
+std::vector<const EncryptionHandler*> collect_password_handlers(const PDFEncryptInfo& info,
+                                                                const std::vector<EncryptionHandlerPtr>& handlers);
+
 }  // namespace unlock_pdf::pdf
 
 #endif  // UNLOCK_PDF_ENCRYPTION_HANDLER_REGISTRY_H
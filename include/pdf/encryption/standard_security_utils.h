@@ -1,6 +1,7 @@
 #ifndef UNLOCK_PDF_STANDARD_SECURITY_UTILS_H
 #define UNLOCK_PDF_STANDARD_SECURITY_UTILS_H
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -8,6 +9,14 @@
 
 namespace unlock_pdf::pdf::standard_security {
 
+// Bytes of a password that take part in key derivation: R2-R4 pad or cut the
+// password to 32 bytes, R5/R6 truncate it to 127 bytes.
+constexpr std::size_t kLegacyPasswordLimit = 32;
+constexpr std::size_t kAes256PasswordLimit = 127;
+
+// Effective password length for `revision`, 0 when it is not known.
+std::size_t max_password_length(int revision);
+
 std::vector<unsigned char> pad_password(const std::string& password);
 std::string unpad_password(const std::vector<unsigned char>& padded);
 
@@ -26,6 +35,26 @@ bool check_owner_password(const std::string& password,
                           int revision,
                           int key_length_bits);
 
+// Revision 5/6 password hash (ISO 32000-2 algorithm 2.B; plain SHA-256 for R5).
+// `user_data` is the 48-byte /U entry when hashing an owner password and empty
+// for user passwords. Returns an empty vector on failure.
+std::vector<unsigned char> compute_hash_v5(const std::string& password,
+                                           const unsigned char* salt,
+                                           std::size_t salt_size,
+                                           const unsigned char* user_data,
+                                           std::size_t user_data_size,
+                                           int revision);
+
+// True when the document opens with an empty user password, i.e. only the
+// owner password (the permission restrictions) protects it. Standard
+// security handler revisions 2-6 only.
+bool user_password_is_empty(const PDFEncryptInfo& info);
+
+// File encryption key unlocked by `password` (user or owner) on a Standard
+// security handler document, or empty when the password does not match or
+// the key cannot be unwrapped (R5/R6 records without /UE or /OE).
+std::vector<unsigned char> derive_file_key(const std::string& password, const PDFEncryptInfo& info);
+
 }  // namespace unlock_pdf::pdf::standard_security
 
 #endif  // UNLOCK_PDF_STANDARD_SECURITY_UTILS_H
@@ -0,0 +1,43 @@
+#ifndef UNLOCK_PDF_PDF_HANDLER_BENCHMARK_H
+#define UNLOCK_PDF_PDF_HANDLER_BENCHMARK_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pdf/encryption/encryption_handler.h"
+#include "pdf/pdf_types.h"
+
+namespace unlock_pdf::pdf {
+
+struct HandlerBenchmarkResult {
+    std::size_t password_length = 0;
+    unsigned int thread_count = 1;
+    std::uint64_t attempts = 0;
+    double duration_seconds = 0.0;
+    double attempts_per_second = 0.0;
+};
+
+// Runs the real password handlers against `info` on the calling thread for a
+// fixed number of candidates of `length` characters drawn from `charset`.
+HandlerBenchmarkResult run_handler_benchmark(std::size_t length,
+                                             std::uint64_t attempts,
+                                             const std::string& charset,
+                                             const PDFEncryptInfo& info,
+                                             const std::vector<const EncryptionHandler*>& handlers);
+
+// Runs the same kernel on `thread_count` threads for roughly `window` and
+// reports the combined throughput. Each thread walks its own part of the
+// candidate space so no state is shared while the clock is running.
+HandlerBenchmarkResult run_handler_benchmark_timed(std::size_t length,
+                                                   const std::string& charset,
+                                                   const PDFEncryptInfo& info,
+                                                   const std::vector<const EncryptionHandler*>& handlers,
+                                                   unsigned int thread_count,
+                                                   std::chrono::milliseconds window);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_HANDLER_BENCHMARK_H
@@ -0,0 +1,40 @@
+#ifndef UNLOCK_PDF_PDF_INFO_BATCH_H
+#define UNLOCK_PDF_PDF_INFO_BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace unlock_pdf::pdf {
+
+enum class InfoFormat {
+    Text,  // the --info report, one block per file
+    Jsonl, // one JSON object per file and line
+    Hash   // "path:$pdf$..." records for --hash-file; unencrypted files are skipped
+};
+
+bool parse_info_format(const std::string& value, InfoFormat& format);
+
+struct InfoBatchOptions {
+    unsigned int thread_count = 0;  // 0 selects the CPUs available to the process
+    InfoFormat format = InfoFormat::Jsonl;
+    bool verbose = false;           // keyword dump in the text report
+};
+
+// Expands --info arguments into file paths. A directory contributes every
+// *.pdf below it (recursively, sorted), a pattern with * or ? in its last
+// component the matching files next to it, and @list (or @- for stdin) one
+// path per line. Anything else is taken as a file path.
+bool expand_info_targets(const std::vector<std::string>& specs,
+                         std::vector<std::string>& paths,
+                         std::string& error);
+
+// Reads every file on a pool of worker threads and writes each result to
+// stdout as soon as it is ready, so output order follows completion rather
+// than input order; JSON lines carry the path. Returns the number of files
+// that could not be read.
+std::size_t run_info_batch(const std::vector<std::string>& paths, const InfoBatchOptions& options);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_INFO_BATCH_H
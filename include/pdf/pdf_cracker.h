@@ -5,7 +5,16 @@
 #include <string>
 #include <vector>
 
+#include "pdf/crack_metrics.h"
+#include "pdf/potfile.h"
+#include "pdf/progress_events.h"
 #include "pdf/pdf_types.h"
+#include "pdf/session_coverage.h"
+#include "util/keyspace.h"
+#include "util/mask.h"
+#include "util/pcfg.h"
+#include "util/rule_engine.h"
+#include "util/thread_affinity.h"
 #include "util/wordlist_generator.h"
 
 namespace unlock_pdf::pdf {
@@ -18,20 +27,130 @@ struct CrackResult {
     std::size_t total_passwords = 0;
 };
 
+// Hybrid and combinator runs join every wordlist word with each word of a
+// second list or each expansion of a mask, and Prince runs chain several
+// wordlist words into each candidate; with Mode::None the words are the
+// candidates.
+struct WordlistCombination {
+    enum class Mode { None, Combinator, AppendMask, PrependMask, Prince };
+
+    Mode mode = Mode::None;
+    std::string right_path;          // Combinator: the list whose words follow the wordlist's
+    unlock_pdf::util::Mask mask;     // AppendMask, PrependMask
+    std::size_t chain_elements = 4;  // Prince: most words per candidate
+    std::size_t min_length = 1;      // Prince: candidate bytes
+    std::size_t max_length = 0;      // Prince: candidate bytes, 0 = the PDF's limit
+};
+
+struct CrackOptions {
+    unsigned int thread_count = 0;
+    unsigned int progress_interval_ms = 500;
+    unlock_pdf::util::AffinityPolicy affinity = unlock_pdf::util::AffinityPolicy::None;
+    std::size_t batch_size = 0;  // candidates fetched per source access, 0 = automatic
+    bool autotune = false;       // calibrate (or load cached) thread count and batch size
+    MetricsOptions metrics;      // periodic JSON lines / Prometheus snapshots, off when no path is set
+    ProgressEventSink* events = nullptr;  // structured events instead of the progress line, not owned
+    bool verbose = false;        // dump the PDF structure while reading the file
+    Potfile* potfile = nullptr;  // consulted before the search and updated after it, not owned
+    SessionCoverage* coverage = nullptr;  // finished candidate ranges to skip and extend, not owned
+    const unlock_pdf::util::RuleSet* rules = nullptr;  // applied to every wordlist word, not owned
+    WordlistCombination combination;                   // joins wordlist words with a second list or a mask
+};
+
+// Expected cost of exhausting the candidates of one length.
+struct LengthEstimate {
+    std::size_t length = 0;
+    unlock_pdf::util::Keyspace candidates;
+    double rate = 0.0;     // calibrated candidates/s across all threads
+    double seconds = 0.0;  // negative when the rate could not be measured
+};
+
+struct CrackEstimate {
+    unsigned int thread_count = 0;
+    unlock_pdf::util::Keyspace total;
+    double seconds = 0.0;
+    std::vector<LengthEstimate> lengths;
+};
+
+// Reads the encryption parameters of `pdf_path` into a target labelled with
+// the path.
+bool load_crack_target(const std::string& pdf_path, CrackTarget& target, const CrackOptions& crack_options = {});
+
 bool crack_pdf(const std::vector<std::string>& passwords,
                const std::string& pdf_path,
                CrackResult& result,
-               unsigned int thread_count = 0);
+               const CrackOptions& crack_options = {});
 
 bool crack_pdf_from_file(const std::string& wordlist_path,
                          const std::string& pdf_path,
                          CrackResult& result,
-                         unsigned int thread_count = 0);
+                         const CrackOptions& crack_options = {});
 
 bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
                           const std::string& pdf_path,
                           CrackResult& result,
-                          unsigned int thread_count = 0);
+                          const CrackOptions& crack_options = {});
+
+// Same runs against parameters already in memory, e.g. from a hash record, so
+// the PDF itself is not needed.
+bool crack_pdf_from_file(const std::string& wordlist_path,
+                         const CrackTarget& target,
+                         CrackResult& result,
+                         const CrackOptions& crack_options = {});
+
+bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                          const CrackTarget& target,
+                          CrackResult& result,
+                          const CrackOptions& crack_options = {});
+
+// Multi-target runs: one candidate stream is verified against every target
+// that is still unsolved, and the run ends when all are solved or the
+// candidates run out. Targets with identical parameters are checked once.
+// `results` is parallel to `targets`.
+bool crack_targets_from_file(const std::string& wordlist_path,
+                             const std::vector<CrackTarget>& targets,
+                             std::vector<CrackResult>& results,
+                             const CrackOptions& crack_options = {});
+
+bool crack_targets_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                              const std::vector<CrackTarget>& targets,
+                              std::vector<CrackResult>& results,
+                              const CrackOptions& crack_options = {});
+
+// Guesses of a trained grammar in descending probability. Generation is
+// sequential and runs on its own thread next to the verifier threads.
+bool crack_targets_pcfg(const unlock_pdf::util::PcfgGrammar& grammar,
+                        const std::vector<CrackTarget>& targets,
+                        std::vector<CrackResult>& results,
+                        const CrackOptions& crack_options = {});
+
+// Dry runs: compute the keyspace, calibrate the handlers for this PDF for a
+// few seconds and print the expected wall time per candidate length. Nothing
+// is cracked.
+bool estimate_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                             const std::string& pdf_path,
+                             CrackEstimate& estimate,
+                             const CrackOptions& crack_options = {});
+
+bool estimate_pdf_from_file(const std::string& wordlist_path,
+                            const std::string& pdf_path,
+                            CrackEstimate& estimate,
+                            const CrackOptions& crack_options = {});
+
+bool estimate_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                             const CrackTarget& target,
+                             CrackEstimate& estimate,
+                             const CrackOptions& crack_options = {});
+
+bool estimate_pdf_from_file(const std::string& wordlist_path,
+                            const CrackTarget& target,
+                            CrackEstimate& estimate,
+                            const CrackOptions& crack_options = {});
+
+bool estimate_pdf_pcfg(const unlock_pdf::util::PcfgGrammar& grammar,
+                       const CrackTarget& target,
+                       CrackEstimate& estimate,
+                       const CrackOptions& crack_options = {});
 
 }  // namespace unlock_pdf::pdf
 
@@ -0,0 +1,39 @@
+#ifndef UNLOCK_PDF_PDF_PDF_HASH_H
+#define UNLOCK_PDF_PDF_PDF_HASH_H
+
+#include <string>
+#include <vector>
+
+#include "pdf/pdf_types.h"
+
+namespace unlock_pdf::pdf {
+
+// Single-line record of everything the password handlers read from a
+// document, in the layout of John the Ripper's pdf2john:
+//
+//   $pdf$V*R*Length*P*EncryptMetadata*IDlen*ID*Ulen*U*Olen*O
+//
+// Binary fields are lowercase hex preceded by their length in bytes. For
+// revisions 5 and 6 the record continues with *OElen*OE*UElen*UE*Permslen*Perms;
+// records written by other tools stop after O, which still identifies the
+// password. Only the Standard security handler can be expressed.
+bool format_pdf_hash(const PDFEncryptInfo& info, std::string& record, std::string& error);
+
+// Accepts a bare record or "label:$pdf$..." as written by --extract-hash and
+// pdf2john; the label becomes the target label.
+bool parse_pdf_hash(const std::string& line, CrackTarget& target, std::string& error);
+
+// Loads every record of a hash file. Blank lines and lines starting with '#'
+// are skipped; a malformed line fails the whole file and `error` names it.
+bool load_pdf_hash_file(const std::string& path, std::vector<CrackTarget>& targets, std::string& error);
+
+// Stable identity of a document for the caches that outlive a run: the
+// SHA-256 (hex) of the V..O part of its record. OE, UE and Perms follow from
+// the password and the fields before them, so leaving them out keeps a
+// trimmed record on the same identity as the full document. Empty when the
+// document cannot be written as a record.
+std::string document_digest(const PDFEncryptInfo& info);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_PDF_HASH_H
@@ -1,13 +1,38 @@
 #ifndef UNLOCK_PDF_PDF_PARSER_H
 #define UNLOCK_PDF_PDF_PARSER_H
 
+#include <iosfwd>
 #include <string>
 
 #include "pdf/pdf_types.h"
 
 namespace unlock_pdf::pdf {
 
-bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info);
+// Maps the file and follows startxref, the newest cross-reference table and
+// the trailer to the /Encrypt dictionary, touching only the pages involved.
+// Files whose cross-reference data is unusable are scanned instead. `verbose`
+// adds a keyword dump of the whole file.
+bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info, bool verbose = false);
+
+// Same lookup and report, written to `out` instead of stdout; failures are
+// described in `error` rather than printed. Holds no shared state, so
+// different files can be read from several threads at once.
+bool read_pdf_encrypt_info(const std::string& filename,
+                           PDFEncryptInfo& info,
+                           std::ostream& out,
+                           std::string& error,
+                           bool verbose = false);
+
+// Algorithm and method names shown by the report, e.g. "AES-128" and
+// "AESV2 (crypt filter: StdCF)". `key_length` is /Length, or the default
+// implied by V and R when the dictionary omits it.
+struct EncryptionDescription {
+    std::string algorithm;
+    std::string method;
+    int key_length = 0;
+};
+
+EncryptionDescription describe_encryption(const PDFEncryptInfo& info);
 
 }  // namespace unlock_pdf::pdf
 
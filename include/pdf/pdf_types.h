@@ -1,6 +1,7 @@
 #ifndef UNLOCK_PDF_PDF_TYPES_H
 #define UNLOCK_PDF_PDF_TYPES_H
 
+#include <string>
 #include <vector>
 
 namespace unlock_pdf::pdf {
@@ -28,6 +29,13 @@ struct PDFEncryptInfo {
     bool has_recipients = false;
 };
 
+// A document to attack: its encryption parameters and a label for messages,
+// the file path or the label of a hash record.
+struct CrackTarget {
+    std::string label;
+    PDFEncryptInfo info;
+};
+
 }  // namespace unlock_pdf::pdf
 
 #endif  // UNLOCK_PDF_PDF_TYPES_H
@@ -0,0 +1,62 @@
+#ifndef UNLOCK_PDF_PDF_POTFILE_H
+#define UNLOCK_PDF_PDF_POTFILE_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pdf/pdf_types.h"
+
+namespace unlock_pdf::pdf {
+
+struct PotfileEntry {
+    std::string password;
+    std::string variant;
+    std::string file_key;  // lowercase hex, empty when it could not be derived
+};
+
+// Append-only store of cracked documents, one tab-separated line each:
+//
+//   digest <TAB> file key <TAB> variant <TAB> password
+//
+// The digest is document_digest() of the document, so a document
+// re-submitted as a PDF, a full record or a trimmed pdf2john record maps to
+// the same entry. The file is indexed in memory when opened;
+// torn or foreign lines are ignored.
+class Potfile {
+public:
+    // Reads `path` if it exists; a missing file is an empty potfile that is
+    // created on the first record.
+    bool open(const std::string& path, std::string& error);
+
+    const std::string& path() const { return path_; }
+
+    const PotfileEntry* find(const PDFEncryptInfo& info) const;
+
+    // Every distinct password on file, in file order, for the pre-pass that
+    // tries them against documents not on file.
+    const std::vector<std::string>& passwords() const { return passwords_; }
+
+    // Appends the document unless it is already on file. The file key is
+    // derived from `password` here.
+    bool record(const PDFEncryptInfo& info,
+                const std::string& password,
+                const std::string& variant,
+                std::string& error);
+
+private:
+    void index(const std::string& digest, PotfileEntry entry);
+
+    std::string path_;
+    std::unordered_map<std::string, PotfileEntry> entries_;
+    std::vector<std::string> passwords_;
+    std::unordered_set<std::string> distinct_passwords_;
+};
+
+// unlock_pdf.potfile in the user cache directory, empty when there is none.
+std::string default_potfile_path();
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_POTFILE_H
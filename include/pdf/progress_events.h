@@ -0,0 +1,86 @@
+#ifndef UNLOCK_PDF_PDF_PROGRESS_EVENTS_H
+#define UNLOCK_PDF_PDF_PROGRESS_EVENTS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "util/keyspace.h"
+
+namespace unlock_pdf::pdf {
+
+enum class ProgressFormat {
+    Text,   // human-readable `\r` progress line on stdout
+    Jsonl   // one JSON object per line, see ProgressEventSink; on stdout, the
+            // human-readable text goes to stderr instead
+};
+
+bool parse_progress_format(const std::string& text, ProgressFormat& format);
+
+// Details announced once before the workers start.
+struct StartEvent {
+    std::string pdf_path;
+    std::string mode;               // "wordlist", "rules", "combinator", "hybrid", "prince", "pcfg", "list" or
+                                    // "bruteforce"
+    int revision = 0;
+    unsigned int threads = 0;
+    std::size_t batch_size = 0;
+    bool keyspace_known = false;
+    unlock_pdf::util::Keyspace keyspace;  // candidates to try when known
+};
+
+struct ProgressEvent {
+    double elapsed_seconds = 0.0;
+    std::uint64_t tried = 0;
+    unlock_pdf::util::Keyspace total;     // zero = unknown
+    double rate = 0.0;              // candidates/s over the last interval
+    double eta_seconds = -1.0;      // negative = unknown
+    std::vector<double> thread_rates;
+};
+
+// Writes structured events as JSON lines:
+//   {"event": "start", ...}     once, with the keyspace when known
+//   {"event": "progress", ...}  from the progress reporter thread
+//   {"event": "found", ...}     when a password matched
+//   {"event": "finished", ...}  at the end of every run
+//   {"event": "error", ...}     for failures reported by the cracker
+// Progress events are dropped when they arrive faster than
+// kMinProgressInterval, so a small --progress-interval cannot flood a
+// front-end. Workers never call into the sink.
+class ProgressEventSink {
+public:
+    static constexpr std::chrono::milliseconds kMinProgressInterval{100};
+
+    // Writes to `fd` (1 = stdout). Errors are printed and leave the sink
+    // invalid.
+    explicit ProgressEventSink(int fd);
+    ~ProgressEventSink();
+
+    ProgressEventSink(const ProgressEventSink&) = delete;
+    ProgressEventSink& operator=(const ProgressEventSink&) = delete;
+
+    bool valid() const { return stream_ != nullptr; }
+
+    void start(const StartEvent& event);
+    void progress(const ProgressEvent& event);
+    void found(const std::string& password, const std::string& variant, std::uint64_t tried);
+    void finished(bool success, std::uint64_t tried, double elapsed_seconds);
+    void error(const std::string& message);
+
+private:
+    void write_line(const std::string& line);
+
+    std::FILE* stream_ = nullptr;
+    bool owns_stream_ = false;
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point last_progress_;
+    bool progress_written_ = false;
+};
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_PROGRESS_EVENTS_H
@@ -0,0 +1,89 @@
+#ifndef UNLOCK_PDF_PDF_PROGRESS_REPORTER_H
+#define UNLOCK_PDF_PDF_PROGRESS_REPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pdf/crack_metrics.h"
+#include "pdf/progress_events.h"
+#include "util/keyspace.h"
+
+namespace unlock_pdf::pdf {
+
+// Attempt counter owned by a single worker thread. Each counter sits on its own
+// cache line so that workers never contend with each other or with the reporter.
+struct alignas(64) ThreadCounter {
+    std::atomic<std::uint64_t> value{0};
+
+    // Only the owning worker writes, so a relaxed load/store pair is enough and
+    // avoids a locked read-modify-write in the hot loop.
+    void add(std::uint64_t count) {
+        value.store(value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    std::uint64_t load() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Aggregates the per-thread counters on a background thread and prints the
+// progress line (rate, ETA and per-thread rates) every interval. Workers only
+// bump their own counter and never perform I/O.
+class ProgressReporter {
+public:
+    // `total` is the keyspace of the run, zero when unknown.
+    ProgressReporter(std::size_t thread_count,
+                     const unlock_pdf::util::Keyspace& total,
+                     std::chrono::milliseconds interval);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    ThreadCounter& counter(std::size_t thread_index) { return counters_[thread_index]; }
+
+    // Snapshots of `metrics` are written from the reporter thread, plus a
+    // final one from stop(). Must be called before start().
+    void attach_metrics(CrackMetrics* metrics) { metrics_ = metrics; }
+
+    // Replaces the `\r` progress line with progress events. Must be called
+    // before start().
+    void attach_events(ProgressEventSink* events) { events_ = events; }
+
+    // For runs that learn their keyspace only after start(); safe to call
+    // from any thread.
+    void set_total(const unlock_pdf::util::Keyspace& total);
+
+    void start();
+    void stop();
+
+    std::uint64_t total_tried() const;
+
+private:
+    void run();
+    void report();
+
+    std::vector<ThreadCounter> counters_;
+    std::vector<std::uint64_t> previous_counts_;
+    unlock_pdf::util::Keyspace total_;  // guarded by mutex_
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point previous_time_;
+
+    CrackMetrics* metrics_ = nullptr;
+    ProgressEventSink* events_ = nullptr;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_requested_ = false;
+    bool printed_ = false;
+};
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_PROGRESS_REPORTER_H
@@ -0,0 +1,31 @@
+#ifndef UNLOCK_PDF_PDF_SELF_TEST_H
+#define UNLOCK_PDF_PDF_SELF_TEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace unlock_pdf::pdf {
+
+struct SelfTestOptions {
+    std::uint32_t seed = 0;                 // randomized inputs; 0 = non-deterministic
+    std::size_t random_iterations = 2000;   // inputs per cheap differential check
+    bool verbose = false;                   // print every passing group, not just the summary
+};
+
+struct SelfTestSummary {
+    std::size_t passed = 0;
+    std::size_t failed = 0;
+    std::uint32_t seed = 0;                 // seed actually used, for reproducing failures
+};
+
+// Checks the crypto primitives against published test vectors (RFC 1321,
+// FIPS 180-4, FIPS 197, RC4), cross-checks the alternative entry points of
+// each primitive on random inputs, compares the R6 password hash with a
+// straightforward reference implementation, and runs the password handlers
+// against freshly generated PDFs of every revision.
+SelfTestSummary run_self_tests(const SelfTestOptions& options, std::ostream& out);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_SELF_TEST_H
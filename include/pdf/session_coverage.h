@@ -0,0 +1,83 @@
+#ifndef UNLOCK_PDF_PDF_SESSION_COVERAGE_H
+#define UNLOCK_PDF_PDF_SESSION_COVERAGE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace unlock_pdf::pdf {
+
+// Sorted, disjoint half-open ranges [begin, end) of candidate positions.
+// Adjacent and overlapping ranges are merged on insertion.
+class IntervalSet {
+public:
+    using Range = std::pair<std::uint64_t, std::uint64_t>;
+
+    void add(std::uint64_t begin, std::uint64_t end);
+    void add(const IntervalSet& other);
+
+    bool empty() const { return ranges_.empty(); }
+    const std::vector<Range>& ranges() const { return ranges_; }
+
+    bool contains(std::uint64_t position) const;
+    bool covers(std::uint64_t begin, std::uint64_t end) const;
+    // Positions of [begin, end) inside the set.
+    std::uint64_t count_within(std::uint64_t begin, std::uint64_t end) const;
+
+    IntervalSet intersect(const IntervalSet& other) const;
+
+private:
+    std::vector<Range> ranges_;
+};
+
+// Candidate ranges each generator has already exhausted against each
+// document, kept across runs so that overlapping runs (lengths 6-8, then
+// 6-10) only test what is new. Documents are keyed by document_digest();
+// generators by a string that pins down the candidate order, such as the
+// alphabet and length for brute force or the digest of the candidate
+// sequence for a wordlist. What a position means is up to the generator.
+//
+// The file is a small text table rewritten on save, under a lock file and
+// merged with whatever other runs saved meanwhile:
+//
+//   document <TAB> generator <TAB> begin-end,begin-end,...
+class SessionCoverage {
+public:
+    // Reads `path` if it exists; a missing file is an empty database.
+    bool open(const std::string& path, std::string& error);
+
+    const std::string& path() const { return path_; }
+
+    // Positions done for `generator` on every one of `documents`.
+    IntervalSet covered(const std::vector<std::string>& documents, const std::string& generator) const;
+
+    // The kind of run behind a generator key: the name before the first ':'
+    // of each '+'-joined part, plus ":rules" for a rule-expanded list. So
+    // "wordlist:<digest>:rules:<digest>" is "wordlist:rules" and
+    // "mask:<digest>+wordlist:<digest>" is "mask+wordlist".
+    static std::string generator_kind(const std::string& generator);
+
+    // Whether `document` has a record of a generator of `kind`, i.e. whether
+    // a run of that kind could skip anything.
+    bool has_records(const std::string& document, const std::string& kind) const;
+
+    void add(const std::string& document, const std::string& generator, const IntervalSet& done);
+
+    // Merges the records on disk with these ones and writes the union
+    // through a temporary file, so an interrupted save keeps the previous
+    // contents.
+    bool save(std::string& error) const;
+
+private:
+    std::string path_;
+    std::map<std::pair<std::string, std::string>, IntervalSet> records_;
+};
+
+// coverage.tsv in the user cache directory, empty when there is none.
+std::string default_session_coverage_path();
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_SESSION_COVERAGE_H
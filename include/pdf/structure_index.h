@@ -0,0 +1,76 @@
+#ifndef UNLOCK_PDF_PDF_STRUCTURE_INDEX_H
+#define UNLOCK_PDF_PDF_STRUCTURE_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace unlock_pdf::pdf {
+
+// Tokens recorded by StructureIndex. The order of the first thirteen is the
+// order of the verbose structure dump.
+enum class StructureKeyword : std::uint8_t {
+    Encrypt,
+    Obj,
+    EndObj,
+    Filter,
+    V,
+    R,
+    O,
+    U,
+    Length,
+    CF,
+    StmF,
+    StrF,
+    AESV3,
+    ID,
+    Trailer,
+    Xref,
+    Startxref,
+    Count
+};
+
+constexpr std::size_t kStructureKeywordCount = static_cast<std::size_t>(StructureKeyword::Count);
+
+// Literal text of a keyword as it appears in the file.
+std::string_view structure_keyword_token(StructureKeyword keyword);
+
+// "N G obj" header; `offset` points at the first digit of N.
+struct ObjectHeader {
+    std::uint64_t number = 0;
+    std::uint64_t generation = 0;
+    std::size_t offset = 0;
+};
+
+// Every keyword offset and object header in a file, collected by a single
+// Aho-Corasick pass so full-file questions (where is /Encrypt, which object
+// is "12 0 obj", where is the last /ID) are answered without rescanning.
+// Tokens must stand alone as words except "/V " and "/R ", which carry their
+// own delimiter; "obj" inside "endobj" or "xref" inside "startxref" is
+// therefore not reported twice.
+class StructureIndex {
+public:
+    static StructureIndex build(std::string_view data);
+
+    // Ascending offsets of the first byte of each occurrence.
+    const std::vector<std::size_t>& occurrences(StructureKeyword keyword) const {
+        return offsets_[static_cast<std::size_t>(keyword)];
+    }
+
+    // Object headers in file order.
+    const std::vector<ObjectHeader>& objects() const { return objects_; }
+
+    // Offset of the last header for the object, so incremental updates win
+    // over the original definition; npos when the object is never defined.
+    std::size_t find_object(std::uint64_t number, std::uint64_t generation) const;
+
+private:
+    std::array<std::vector<std::size_t>, kStructureKeywordCount> offsets_;
+    std::vector<ObjectHeader> objects_;
+};
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_STRUCTURE_INDEX_H
@@ -0,0 +1,39 @@
+#ifndef UNLOCK_PDF_PDF_TEST_PDF_GENERATOR_H
+#define UNLOCK_PDF_PDF_TEST_PDF_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+#include "pdf/pdf_types.h"
+
+namespace unlock_pdf::pdf {
+
+enum class TestPdfCipher {
+    Rc4,  // RC4 for R2-R4
+    Aes   // AESV2 for R4, AESV3 for R5/R6
+};
+
+struct TestPdfOptions {
+    int revision = 6;                          // Standard security handler revision 2-6
+    TestPdfCipher cipher = TestPdfCipher::Aes; // only selectable for R4; R2/R3 use RC4, R5/R6 AES-256
+    int key_length_bits = 0;                   // 0 = revision default (40, 128 or 256)
+    std::string user_password;
+    std::string owner_password;                // empty = same as the user password
+    bool encrypt_metadata = true;              // /EncryptMetadata, R4 and later
+    std::int32_t permissions = -4;
+    std::uint32_t seed = 0;                    // salts, IDs and IVs; 0 = non-deterministic
+};
+
+// Builds a minimal single-page PDF encrypted with the Standard security
+// handler. `info` receives the encryption parameters exactly as the parser
+// would read them back from the file. Errors are printed and return false.
+bool build_test_pdf(const TestPdfOptions& options, std::string& pdf, PDFEncryptInfo& info);
+
+bool write_test_pdf(const TestPdfOptions& options, const std::string& path, PDFEncryptInfo& info);
+
+// Short description such as "R4 AESV2 128-bit" used in reports and file names.
+std::string describe_test_pdf(const TestPdfOptions& options);
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_PDF_TEST_PDF_GENERATOR_H
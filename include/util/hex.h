@@ -0,0 +1,16 @@
+#ifndef UNLOCK_PDF_UTIL_HEX_H
+#define UNLOCK_PDF_UTIL_HEX_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// Lowercase hex, two digits per byte.
+std::string to_hex(const unsigned char* data, std::size_t size);
+std::string to_hex(const std::vector<unsigned char>& data);
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_HEX_H
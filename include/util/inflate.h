@@ -0,0 +1,33 @@
+#ifndef UNLOCK_PDF_UTIL_INFLATE_H
+#define UNLOCK_PDF_UTIL_INFLATE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// Decodes /FlateDecode data: a zlib stream (RFC 1950) around deflate blocks
+// (RFC 1951). Input without a valid zlib header is decoded as raw deflate,
+// and the Adler-32 trailer is not checked, matching how PDF readers treat
+// sloppy writers. Output larger than `max_output` is an error so hostile
+// streams cannot exhaust memory.
+bool inflate_zlib(std::string_view input,
+                  std::vector<unsigned char>& output,
+                  std::size_t max_output,
+                  std::string& error);
+
+// Reverses the PNG row filters selected by /Predictor 10-15 in
+// /DecodeParms. Every row starts with its filter type byte; a trailing
+// partial row is dropped.
+bool undo_png_predictor(const std::vector<unsigned char>& input,
+                        std::size_t colors,
+                        std::size_t bits_per_component,
+                        std::size_t columns,
+                        std::vector<unsigned char>& output,
+                        std::string& error);
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_INFLATE_H
@@ -0,0 +1,16 @@
+#ifndef UNLOCK_PDF_UTIL_JSON_H
+#define UNLOCK_PDF_UTIL_JSON_H
+
+#include <string>
+
+namespace unlock_pdf::util {
+
+// Contents of a JSON string literal for `value`, without the quotes: quotes,
+// backslashes and control characters are escaped. Well-formed UTF-8 is kept;
+// any other byte (passwords and paths are arbitrary bytes) becomes \u0080 to
+// \u00ff, so the output is always valid JSON.
+std::string json_escape(const std::string& value);
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_JSON_H
@@ -0,0 +1,63 @@
+#ifndef UNLOCK_PDF_UTIL_KEYSPACE_H
+#define UNLOCK_PDF_UTIL_KEYSPACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace unlock_pdf::util {
+
+// Unsigned 128-bit candidate count with saturating arithmetic, built from two
+// 64-bit halves so it behaves the same on every compiler. Results that do not
+// fit saturate at 2^128 - 1 and are flagged as overflowed, which keeps
+// "astronomically large" distinguishable from an exact count.
+class Keyspace {
+public:
+    constexpr Keyspace() = default;
+    constexpr Keyspace(std::uint64_t value) : low_(value) {}  // NOLINT(google-explicit-constructor)
+
+    static Keyspace from_parts(std::uint64_t high, std::uint64_t low);
+    static Keyspace saturated();
+
+    std::uint64_t high() const { return high_; }
+    std::uint64_t low() const { return low_; }
+    bool overflowed() const { return overflowed_; }
+    bool is_zero() const { return high_ == 0 && low_ == 0; }
+    bool fits_uint64() const { return high_ == 0 && !overflowed_; }
+
+    Keyspace& operator+=(const Keyspace& other);
+    Keyspace& operator*=(const Keyspace& other);
+
+    // Difference clamped at zero.
+    Keyspace saturating_sub(const Keyspace& other) const;
+
+    double to_double() const;
+    // Decimal digits; overflowed values are prefixed with '>'.
+    std::string to_string() const;
+
+    friend Keyspace operator+(Keyspace lhs, const Keyspace& rhs) { return lhs += rhs; }
+    friend Keyspace operator*(Keyspace lhs, const Keyspace& rhs) { return lhs *= rhs; }
+    friend bool operator==(const Keyspace& lhs, const Keyspace& rhs) {
+        return lhs.high_ == rhs.high_ && lhs.low_ == rhs.low_ && lhs.overflowed_ == rhs.overflowed_;
+    }
+    friend bool operator!=(const Keyspace& lhs, const Keyspace& rhs) { return !(lhs == rhs); }
+    friend bool operator<(const Keyspace& lhs, const Keyspace& rhs) {
+        return lhs.high_ != rhs.high_ ? lhs.high_ < rhs.high_ : lhs.low_ < rhs.low_;
+    }
+
+private:
+    std::uint64_t high_ = 0;
+    std::uint64_t low_ = 0;
+    bool overflowed_ = false;
+};
+
+// base^exponent.
+Keyspace keyspace_power(std::uint64_t base, std::size_t exponent);
+
+// Candidates of every length from min_length to max_length over an alphabet of
+// `alphabet_size` characters.
+Keyspace charset_keyspace(std::size_t alphabet_size, std::size_t min_length, std::size_t max_length);
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_KEYSPACE_H
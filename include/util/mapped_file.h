@@ -0,0 +1,48 @@
+#ifndef UNLOCK_PDF_UTIL_MAPPED_FILE_H
+#define UNLOCK_PDF_UTIL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace unlock_pdf::util {
+
+enum class AccessPattern {
+    Random,     // a few scattered reads: no read-ahead
+    Sequential  // one front-to-back pass: aggressive read-ahead
+};
+
+// Read-only memory mapping of a whole file. Pages are only read from disk when
+// touched, so looking at the tail and a handful of objects of a multi-gigabyte
+// file costs a few page faults instead of a full copy. Empty files map to an
+// empty view.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps `path`; on failure returns false and describes the problem in `error`.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    // Hint for the kernel's read-ahead; ignored where unsupported.
+    void advise(AccessPattern pattern) const;
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if defined(_WIN32)
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_MAPPED_FILE_H
@@ -0,0 +1,77 @@
+#ifndef UNLOCK_PDF_UTIL_MARKOV_MODEL_H
+#define UNLOCK_PDF_UTIL_MARKOV_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace unlock_pdf::util {
+
+// How often each byte follows each byte at each position of a training
+// corpus; position 0 counts against a previous byte of 0. Positions past
+// kMaxPositions share the statistics of the last one.
+//
+// Saved as a small little-endian binary file holding only the pairs seen:
+//
+//   "UPDFMKV1", u32 positions, u64 words, u32 entries,
+//   entries x { u8 position, u8 previous, u8 next, u32 count }
+class MarkovStatistics {
+public:
+    static constexpr std::size_t kMaxPositions = 64;
+
+    void add(const std::string& word);
+
+    // Adds every line of `wordlist_path` (UTF-8, a BOM and CR line ends are
+    // accepted).
+    bool train(const std::string& wordlist_path, std::string& error);
+
+    bool save(const std::string& path, std::string& error) const;
+    bool load(const std::string& path, std::string& error);
+
+    std::uint64_t words() const { return words_; }
+    std::size_t positions() const { return positions_; }
+    std::uint64_t count(std::size_t position, unsigned char previous, unsigned char next) const;
+
+private:
+    static std::uint32_t key(std::size_t position, unsigned char previous, unsigned char next) {
+        return static_cast<std::uint32_t>(position) << 16 | static_cast<std::uint32_t>(previous) << 8 | next;
+    }
+
+    std::unordered_map<std::uint32_t, std::uint64_t> counts_;
+    std::uint64_t words_ = 0;
+    std::size_t positions_ = 0;
+};
+
+// An alphabet reordered for every position and previous character, most
+// frequent successor first; pairs the corpus never shows fall back to the
+// position's overall frequency, then to alphabet order. A brute-force
+// odometer whose digits are ranks into this table tries likely candidates
+// first while every candidate keeps a fixed index. With a threshold only the
+// most likely characters per position are kept.
+class MarkovOrder {
+public:
+    // `threshold` 0 keeps the whole alphabet.
+    MarkovOrder(const MarkovStatistics& statistics, const std::string& alphabet, std::size_t threshold);
+
+    std::size_t radix() const { return radix_; }
+
+    // Character of rank `rank` at `position` after `previous` (0 at
+    // position 0).
+    char at(std::size_t position, unsigned char previous, std::size_t rank) const {
+        std::size_t row = (position < positions_ ? position : positions_ - 1) * 256 + previous;
+        return table_[row * radix_ + rank];
+    }
+
+    // The whole table, which pins down the candidate order.
+    const std::string& table() const { return table_; }
+
+private:
+    std::size_t positions_ = 1;
+    std::size_t radix_ = 0;
+    std::string table_;
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_MARKOV_MODEL_H
@@ -0,0 +1,42 @@
+#ifndef UNLOCK_PDF_UTIL_MASK_H
+#define UNLOCK_PDF_UTIL_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// hashcat-style mask with one character set per position:
+//
+//   ?l a-z   ?u A-Z   ?d 0-9   ?s printable symbols and space   ?a ?l?u?d?s
+//   ?h 0-9a-f   ?H 0-9A-F   ?b every byte   ?? a literal '?'
+//
+// Any other character stands for itself, so "19?d?d" covers 1900-1999.
+// Expansions are numbered in odometer order with the last position turning
+// fastest, so an index identifies one candidate without generating the
+// ones before it.
+class Mask {
+public:
+    // False with `error` set for an unknown placeholder or a mask with more
+    // than 2^64 expansions.
+    static bool parse(const std::string& text, Mask& mask, std::string& error);
+
+    const std::string& text() const { return text_; }
+    bool empty() const { return positions_.empty(); }
+    std::size_t length() const { return positions_.size(); }
+    std::uint64_t size() const { return size_; }
+
+    // Expansion number `index`, which must be below size().
+    void expansion(std::uint64_t index, std::string& out) const;
+
+private:
+    std::string text_;
+    std::vector<std::string> positions_;
+    std::uint64_t size_ = 0;
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_MASK_H
@@ -0,0 +1,112 @@
+#ifndef UNLOCK_PDF_UTIL_PCFG_H
+#define UNLOCK_PDF_UTIL_PCFG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// Probabilistic context-free grammar of passwords in the manner of Weir et
+// al.: a password is a base structure of letter (L), digit (D) and symbol (S)
+// runs, e.g. L6D2S1 for "monkey12!", and every run is a terminal seen for its
+// class and length in the training data. A guess is as likely as its
+// structure times its terminals.
+//
+// Saved as text, one count per line, the terminal last so that it may hold
+// any byte but a line break:
+//
+//   S <TAB> count <TAB> L6D2S1
+//   T <TAB> D2 <TAB> count <TAB> 12
+class PcfgGrammar {
+public:
+    struct Terminal {
+        std::string text;
+        double probability = 0.0;
+    };
+
+    struct Structure {
+        std::string text;                   // e.g. "L6D2S1"
+        std::vector<std::size_t> segments;  // indices into classes()
+        std::size_t length = 0;             // bytes of every guess
+        double probability = 0.0;
+    };
+
+    struct TerminalClass {
+        std::string name;                 // e.g. "D2"
+        std::vector<Terminal> terminals;  // most probable first
+    };
+
+    void add(const std::string& password);
+
+    // Adds every line of `wordlist_path` (UTF-8, a BOM and CR line ends are
+    // accepted).
+    bool train(const std::string& wordlist_path, std::string& error);
+
+    bool save(const std::string& path, std::string& error) const;
+    bool load(const std::string& path, std::string& error);
+
+    std::uint64_t passwords() const { return passwords_; }
+    bool empty() const { return structures_.empty(); }
+
+    // Most probable first; valid after train() or load().
+    const std::vector<Structure>& structures() const { return structures_; }
+    const std::vector<TerminalClass>& classes() const { return classes_; }
+
+    // Guesses of at most `max_length` bytes (0 = any), saturating at 2^64 - 1.
+    std::uint64_t guess_count(std::size_t max_length) const;
+    std::map<std::size_t, std::uint64_t> guess_lengths(std::size_t max_length) const;
+
+private:
+    void finalize();
+
+    std::uint64_t passwords_ = 0;
+    std::map<std::string, std::uint64_t> structure_counts_;
+    std::map<std::string, std::map<std::string, std::uint64_t>> terminal_counts_;
+    std::vector<Structure> structures_;
+    std::vector<TerminalClass> classes_;
+};
+
+// Guesses of a grammar in descending probability, using the "next" function
+// of Weir et al.: a priority queue of terminal choices where each popped
+// entry pushes its successors from its pivot on, so every guess is produced
+// once. The queue is capped; past the cap its least probable half is
+// dropped, which keeps memory bounded at the price of never producing the
+// guesses below the dropped entries.
+class PcfgGenerator {
+public:
+    static constexpr std::size_t kDefaultQueueLimit = std::size_t{1} << 20;
+
+    PcfgGenerator(const PcfgGrammar& grammar, std::size_t max_length, std::size_t queue_limit = kDefaultQueueLimit);
+
+    bool next(std::string& guess);
+
+    // Queue entries dropped to stay under the limit.
+    std::uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Entry {
+        double probability = 0.0;
+        std::size_t structure = 0;
+        std::size_t pivot = 0;
+        std::vector<std::uint32_t> choices;  // terminal index per segment
+    };
+
+    struct LessProbable {
+        bool operator()(const Entry& a, const Entry& b) const { return a.probability < b.probability; }
+    };
+
+    double probability(const Entry& entry) const;
+    void push(Entry entry);
+
+    const PcfgGrammar& grammar_;
+    std::size_t queue_limit_;
+    std::vector<Entry> heap_;  // max-heap on probability
+    std::uint64_t dropped_ = 0;
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_PCFG_H
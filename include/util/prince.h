@@ -0,0 +1,65 @@
+#ifndef UNLOCK_PDF_UTIL_PRINCE_H
+#define UNLOCK_PDF_UTIL_PRINCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// Candidates of the PRINCE attack: chains of one to N words of a single list,
+// concatenated. A chain is a sequence of element lengths, e.g. 4+3 for a
+// 4-byte word followed by a 3-byte word, and expands to every combination of
+// words of those lengths.
+//
+// Chains are ordered by element count, then by size, smallest first. Within a
+// chain the leftmost element turns slowest and words keep their list order,
+// so a list sorted by probability leads with its likeliest words. Every
+// candidate has a fixed index. Only the words and the chain table are held;
+// candidates are built from their index on demand.
+class PrinceChains {
+public:
+    static constexpr std::size_t kMaxElements = 8;
+    static constexpr std::size_t kMaxChains = std::size_t{1} << 20;
+
+    // Empty words and repeats are ignored.
+    void add(const std::string& word);
+
+    // Lays out the chains of 1..`max_elements` words whose candidates are
+    // `min_length`..`max_length` bytes long. Chains that would take the
+    // keyspace past 2^64 - 1 are left out together with all later ones; see
+    // truncated().
+    bool build(std::size_t min_length, std::size_t max_length, std::size_t max_elements, std::string& error);
+
+    std::size_t words() const { return word_count_; }
+    std::size_t chains() const { return chains_.size(); }
+    bool truncated() const { return truncated_; }
+
+    // Valid after build().
+    std::uint64_t size() const { return chains_.empty() ? 0 : chains_.back().offset + chains_.back().size; }
+    void candidate(std::uint64_t index, std::string& out) const;
+    std::map<std::size_t, std::uint64_t> length_counts() const;
+
+private:
+    struct Chain {
+        std::uint64_t offset = 0;  // index of the chain's first candidate
+        std::uint64_t size = 0;
+        std::size_t length = 0;    // bytes of every candidate
+        std::size_t first = 0;     // into element_lengths_
+        std::size_t count = 0;     // elements
+    };
+
+    std::vector<std::vector<std::string>> by_length_;  // words in list order, per length
+    std::unordered_set<std::string> seen_;             // only while adding
+    std::size_t word_count_ = 0;
+    std::vector<Chain> chains_;
+    std::vector<std::size_t> element_lengths_;
+    bool truncated_ = false;
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_PRINCE_H
@@ -0,0 +1,69 @@
+#ifndef UNLOCK_PDF_UTIL_RULE_ENGINE_H
+#define UNLOCK_PDF_UTIL_RULE_ENGINE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace unlock_pdf::util {
+
+// One word-mangling rule in the hashcat/John syntax shared by both tools,
+// e.g. "c $1 $9" or "sa@ so0 ]". Functions are single characters followed by
+// their fixed arguments; whitespace between functions is ignored. Positions
+// are 0-9 then A-Z for 10-35. Supported:
+//
+//   :  l u c C t TN E eX       no-op and case changes
+//   r d pN f { } q kK *NM      reversal, duplication, rotation, swaps
+//   $X ^X iNX oNX sXY @X       append, prepend, insert, overwrite, substitute, purge
+//   [ ] DN xNM ONM 'N          deletion, extraction, truncation
+//   zN ZN yN YN                duplicate leading or trailing characters
+//   LN RN +N -N .N ,N          per-character arithmetic and copies
+//   <N >N _N !X /X (X )X =NX %NX   rejections
+//
+// Functions whose position lies outside the word leave it unchanged, as in
+// hashcat.
+class Rule {
+public:
+    // Longest word a rule may produce; longer results are rejected.
+    static constexpr std::size_t kMaxWordLength = 256;
+
+    // False with `error` naming the offending function when `text` is not a
+    // valid rule.
+    static bool parse(const std::string& text, Rule& rule, std::string& error);
+
+    // Writes the mangled `word` to `out`; false when a rejection function
+    // drops the word.
+    bool apply(const std::string& word, std::string& out) const;
+
+    const std::string& text() const { return text_; }
+
+private:
+    struct Step {
+        char function = ':';
+        unsigned char first = 0;
+        unsigned char second = 0;
+    };
+
+    std::string text_;
+    std::vector<Step> steps_;
+};
+
+// Rules in file order. Blank lines and lines starting with '#' are skipped.
+class RuleSet {
+public:
+    // Appends the rules of `path`; errors are reported as "path:line: ...".
+    bool load(const std::string& path, std::string& error);
+
+    bool add(const std::string& text, std::string& error);
+
+    bool empty() const { return rules_.empty(); }
+    std::size_t size() const { return rules_.size(); }
+    const Rule& operator[](std::size_t index) const { return rules_[index]; }
+
+private:
+    std::vector<Rule> rules_;
+};
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_RULE_ENGINE_H
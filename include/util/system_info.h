@@ -3,9 +3,19 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace unlock_pdf::util {
 
+// One schedulable logical CPU as described by /sys/devices/system/cpu. Fields
+// that the platform does not expose are left at -1.
+struct LogicalCpu {
+    unsigned int id = 0;
+    int core_id = -1;
+    int package_id = -1;
+    int numa_node = -1;
+};
+
 struct SystemInfo {
     std::string os_name;
     std::string kernel_version;
@@ -13,11 +23,38 @@ struct SystemInfo {
     std::string cpu_model;
     std::string hostname;
     unsigned int cpu_threads = 0;
+    unsigned int affinity_cpus = 0;          // CPUs this process may be scheduled on
+    double cgroup_cpu_quota = 0.0;           // cgroup CPU quota in CPUs, 0 when unlimited
+    unsigned int effective_cpus = 0;         // min(hardware threads, affinity, quota)
+    unsigned int physical_cores = 0;
+    unsigned int numa_nodes = 0;
     std::uint64_t total_memory_bytes = 0;
     std::uint64_t available_memory_bytes = 0;
+    std::uint64_t cgroup_memory_limit_bytes = 0;  // 0 when unlimited
 };
 
 SystemInfo collect_system_info();
+
+// Number of CPUs the process can actually use, honouring the scheduler affinity
+// mask and cgroup v1/v2 CPU quotas. Always at least 1.
+unsigned int effective_cpu_count();
+
+// Logical CPUs in the process affinity mask with their core, package and NUMA
+// node, sorted by CPU id. Empty when the topology cannot be read.
+std::vector<LogicalCpu> read_cpu_topology();
+
+// CPU model string as reported by the platform, "Unknown" when unavailable.
+std::string cpu_model_name();
+
+// Per-user cache directory for unlock_pdf ($XDG_CACHE_HOME/unlock_pdf,
+// ~/.cache/unlock_pdf or %LOCALAPPDATA%\unlock_pdf). The directory is not
+// created. Empty when no suitable base directory is known.
+std::string user_cache_directory();
+
+// Id of the running process, for temporary file names that must not collide
+// with another run writing the same file.
+unsigned long current_process_id();
+
 std::string human_readable_bytes(std::uint64_t bytes);
 
 }  // namespace unlock_pdf::util
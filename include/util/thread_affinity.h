@@ -0,0 +1,40 @@
+#ifndef UNLOCK_PDF_UTIL_THREAD_AFFINITY_H
+#define UNLOCK_PDF_UTIL_THREAD_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+#include "util/system_info.h"
+
+namespace unlock_pdf::util {
+
+enum class AffinityPolicy {
+    None,          // let the OS scheduler place threads
+    Compact,       // fill every SMT sibling of a core before moving to the next core
+    Scatter,       // spread across packages and cores first, siblings last
+    PhysicalOnly   // one thread per physical core, never share a core
+};
+
+bool parse_affinity_policy(const std::string& text, AffinityPolicy& policy);
+const char* affinity_policy_name(AffinityPolicy policy);
+
+// CPU assigned to each worker thread, in thread order. Returns an empty plan for
+// AffinityPolicy::None or when no topology is available. Threads beyond the
+// number of usable CPUs wrap around the plan, except with PhysicalOnly, whose
+// plan stops at one thread per core and leaves the rest unplaced.
+std::vector<LogicalCpu> plan_thread_placement(const std::vector<LogicalCpu>& topology,
+                                              AffinityPolicy policy,
+                                              unsigned int thread_count);
+
+// Number of distinct physical cores in the topology.
+unsigned int count_physical_cores(const std::vector<LogicalCpu>& topology);
+
+// Pin the calling thread to one logical CPU. Returns false when unsupported.
+bool pin_current_thread(unsigned int cpu_id);
+
+// Human readable "t0->cpu0 (core 0, node 0), ..." summary of a plan.
+std::string describe_thread_placement(const std::vector<LogicalCpu>& placement);
+
+}  // namespace unlock_pdf::util
+
+#endif  // UNLOCK_PDF_UTIL_THREAD_AFFINITY_H
@@ -4,6 +4,8 @@
 #include <cstddef>
 #include <string>
 
+#include "util/markov_model.h"
+
 namespace unlock_pdf::util {
 
 struct WordlistOptions {
@@ -15,6 +17,10 @@ struct WordlistOptions {
     bool include_special = true;
     bool use_custom_characters = false;
     std::string custom_characters;
+    // Try likely characters first, in the order these statistics give for
+    // each position and previous character; not owned.
+    const MarkovStatistics* markov = nullptr;
+    std::size_t markov_threshold = 0;  // characters kept per position with statistics, 0 = all
 };
 
 }  // namespace unlock_pdf::util
@@ -167,6 +167,41 @@ void inv_mix_columns(std::array<unsigned char, 16>& state) {
     }
 }
 
+std::array<std::array<unsigned char, 16>, 15> expand_aes256_key(const std::vector<unsigned char>& key) {
+    std::array<uint32_t, 60> words{};
+    for (int i = 0; i < 8; ++i) {
+        words[i] = (static_cast<uint32_t>(key[i * 4]) << 24) |
+                   (static_cast<uint32_t>(key[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(key[i * 4 + 2]) << 8) |
+                   static_cast<uint32_t>(key[i * 4 + 3]);
+    }
+
+    static const unsigned char rcon[15] = {
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a};
+
+    for (int i = 8; i < 60; ++i) {
+        uint32_t temp = words[i - 1];
+        if (i % 8 == 0) {
+            temp = aes_sub_word(aes_rot_word(temp)) ^ (static_cast<uint32_t>(rcon[i / 8 - 1]) << 24);
+        } else if (i % 8 == 4) {
+            temp = aes_sub_word(temp);
+        }
+        words[i] = words[i - 8] ^ temp;
+    }
+
+    std::array<std::array<unsigned char, 16>, 15> round_keys{};
+    for (int round = 0; round < 15; ++round) {
+        for (int word = 0; word < 4; ++word) {
+            uint32_t value = words[round * 4 + word];
+            round_keys[round][word * 4 + 0] = static_cast<unsigned char>((value >> 24) & 0xff);
+            round_keys[round][word * 4 + 1] = static_cast<unsigned char>((value >> 16) & 0xff);
+            round_keys[round][word * 4 + 2] = static_cast<unsigned char>((value >> 8) & 0xff);
+            round_keys[round][word * 4 + 3] = static_cast<unsigned char>(value & 0xff);
+        }
+    }
+    return round_keys;
+}
+
 }  // namespace
 
 AES128Encryptor::AES128Encryptor(const std::vector<unsigned char>& key) {
@@ -226,44 +261,43 @@ void AES128Encryptor::encrypt_block(const unsigned char* input, unsigned char* o
     std::copy(state.begin(), state.end(), output);
 }
 
-AES256Decryptor::AES256Decryptor(const std::vector<unsigned char>& key) {
+AES256Encryptor::AES256Encryptor(const std::vector<unsigned char>& key) {
     if (key.size() != 32) {
         valid_ = false;
         return;
     }
+    round_keys_ = expand_aes256_key(key);
+    valid_ = true;
+}
 
-    std::array<uint32_t, 60> words{};
-    for (int i = 0; i < 8; ++i) {
-        words[i] = (static_cast<uint32_t>(key[i * 4]) << 24) |
-                   (static_cast<uint32_t>(key[i * 4 + 1]) << 16) |
-                   (static_cast<uint32_t>(key[i * 4 + 2]) << 8) |
-                   static_cast<uint32_t>(key[i * 4 + 3]);
-    }
+bool AES256Encryptor::valid() const { return valid_; }
 
-    static const unsigned char rcon[15] = {
-        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a};
+void AES256Encryptor::encrypt_block(const unsigned char* input, unsigned char* output) const {
+    std::array<unsigned char, 16> state{};
+    std::copy(input, input + 16, state.begin());
 
-    for (int i = 8; i < 60; ++i) {
-        uint32_t temp = words[i - 1];
-        if (i % 8 == 0) {
-            temp = aes_sub_word(aes_rot_word(temp)) ^ (static_cast<uint32_t>(rcon[i / 8 - 1]) << 24);
-        } else if (i % 8 == 4) {
-            temp = aes_sub_word(temp);
-        }
-        words[i] = words[i - 8] ^ temp;
+    add_round_key(state, round_keys_[0]);
+    for (int round = 1; round < 14; ++round) {
+        sub_bytes(state);
+        shift_rows(state);
+        mix_columns(state);
+        add_round_key(state, round_keys_[round]);
     }
+    sub_bytes(state);
+    shift_rows(state);
+    add_round_key(state, round_keys_[14]);
 
-    std::array<std::array<unsigned char, 16>, 15> enc_keys{};
-    for (int round = 0; round < 15; ++round) {
-        for (int word = 0; word < 4; ++word) {
-            uint32_t value = words[round * 4 + word];
-            enc_keys[round][word * 4 + 0] = static_cast<unsigned char>((value >> 24) & 0xff);
-            enc_keys[round][word * 4 + 1] = static_cast<unsigned char>((value >> 16) & 0xff);
-            enc_keys[round][word * 4 + 2] = static_cast<unsigned char>((value >> 8) & 0xff);
-            enc_keys[round][word * 4 + 3] = static_cast<unsigned char>(value & 0xff);
-        }
+    std::copy(state.begin(), state.end(), output);
+}
+
+AES256Decryptor::AES256Decryptor(const std::vector<unsigned char>& key) {
+    if (key.size() != 32) {
+        valid_ = false;
+        return;
     }
 
+    std::array<std::array<unsigned char, 16>, 15> enc_keys = expand_aes256_key(key);
+
     decrypt_round_keys_[0] = enc_keys[14];
     for (int round = 1; round < 14; ++round) {
         decrypt_round_keys_[round] = enc_keys[14 - round];
@@ -280,12 +314,14 @@ void AES256Decryptor::decrypt_block(const unsigned char* input, unsigned char* o
     std::array<unsigned char, 16> state{};
     std::copy(input, input + 16, state.begin());
 
+    // Equivalent inverse cipher (FIPS 197 section 5.3.5): the middle round keys
+    // already went through InvMixColumns, so it is applied before AddRoundKey.
     add_round_key(state, decrypt_round_keys_[0]);
     for (int round = 1; round < 14; ++round) {
         inv_shift_rows(state);
         inv_sub_bytes(state);
-        add_round_key(state, decrypt_round_keys_[round]);
         inv_mix_columns(state);
+        add_round_key(state, decrypt_round_keys_[round]);
     }
     inv_shift_rows(state);
     inv_sub_bytes(state);
@@ -326,6 +362,38 @@ bool aes128_cbc_encrypt(const std::vector<unsigned char>& key,
     return true;
 }
 
+bool aes256_cbc_encrypt(const std::vector<unsigned char>& key,
+                        const std::vector<unsigned char>& iv,
+                        const std::vector<unsigned char>& plaintext,
+                        std::vector<unsigned char>& ciphertext) {
+    if (key.size() != 32 || iv.size() != 16 || plaintext.empty() || plaintext.size() % 16 != 0) {
+        return false;
+    }
+
+    AES256Encryptor encryptor(key);
+    if (!encryptor.valid()) {
+        return false;
+    }
+
+    ciphertext.resize(plaintext.size());
+    std::array<unsigned char, 16> previous{};
+    std::copy(iv.begin(), iv.end(), previous.begin());
+    std::array<unsigned char, 16> block{};
+    std::array<unsigned char, 16> encrypted{};
+
+    for (std::size_t offset = 0; offset < plaintext.size(); offset += 16) {
+        std::copy(plaintext.begin() + offset, plaintext.begin() + offset + 16, block.begin());
+        for (std::size_t i = 0; i < 16; ++i) {
+            block[i] ^= previous[i];
+        }
+        encryptor.encrypt_block(block.data(), encrypted.data());
+        std::copy(encrypted.begin(), encrypted.end(), ciphertext.begin() + offset);
+        previous = encrypted;
+    }
+
+    return true;
+}
+
 bool aes256_cbc_decrypt(const std::vector<unsigned char>& key,
                         const std::vector<unsigned char>& iv,
                         const std::vector<unsigned char>& ciphertext,
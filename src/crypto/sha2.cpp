@@ -327,6 +327,25 @@ void sha256_digest(const unsigned char* data, std::size_t len, unsigned char* ou
     ctx.finalize(out);
 }
 
+struct Sha256Context::State {
+    SHA256 ctx;
+};
+
+Sha256Context::Sha256Context() : state_(std::make_unique<State>()) {}
+
+Sha256Context::~Sha256Context() = default;
+
+void Sha256Context::update(const unsigned char* data, std::size_t len) {
+    if (data != nullptr && len != 0) {
+        state_->ctx.update(data, len);
+    }
+}
+
+void Sha256Context::finalize(unsigned char* out) {
+    state_->ctx.finalize(out);
+    state_->ctx.reset();
+}
+
 std::vector<unsigned char> sha2_hash(const std::vector<unsigned char>& data, std::size_t bits) {
     if (bits == 256) {
         return sha256_bytes(data);
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define UNLOCK_PDF_HAVE_X86 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <x86intrin.h>
+#define UNLOCK_PDF_HAVE_X86 1
+#endif
+
+#include "crypto/aes.h"
+#include "crypto/md5.h"
+#include "crypto/rc4.h"
+#include "crypto/sha2.h"
+#include "pdf/encryption/standard_security_utils.h"
+#include "pdf/self_test.h"
+#include "util/system_info.h"
+#include "util/json.h"
+
+namespace {
+
+struct BenchConfig {
+    std::size_t min_time_ms = 200;
+    std::string filter;
+    std::string json_path;
+    bool verify = false;
+    std::uint32_t seed = 0;
+    bool verbose = false;
+};
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool avx2 = false;
+    bool aesni = false;
+    bool sha_ni = false;
+};
+
+// One timed kernel call. `bytes` is the input size a call processes and is
+// used for the cycles/byte and MB/s columns.
+struct BenchCase {
+    std::string name;
+    std::string variant;
+    std::size_t bytes = 0;
+    std::function<unsigned char()> run;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string variant;
+    std::size_t bytes = 0;
+    std::uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double megabytes_per_second = 0.0;
+    double cycles_per_byte = -1.0;  // negative when no cycle counter is available
+};
+
+CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+#if defined(UNLOCK_PDF_HAVE_X86)
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+#if defined(_MSC_VER)
+    int regs[4] = {0, 0, 0, 0};
+    __cpuid(regs, 0);
+    unsigned int max_leaf = static_cast<unsigned int>(regs[0]);
+    __cpuidex(regs, 1, 0);
+    ecx = static_cast<unsigned int>(regs[2]);
+    edx = static_cast<unsigned int>(regs[3]);
+#else
+    unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+    __cpuid_count(1, 0, eax, ebx, ecx, edx);
+#endif
+    features.sse2 = (edx & (1u << 26)) != 0;
+    features.ssse3 = (ecx & (1u << 9)) != 0;
+    features.sse41 = (ecx & (1u << 19)) != 0;
+    features.aesni = (ecx & (1u << 25)) != 0;
+    if (max_leaf >= 7) {
+#if defined(_MSC_VER)
+        __cpuidex(regs, 7, 0);
+        ebx = static_cast<unsigned int>(regs[1]);
+#else
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+#endif
+        features.avx2 = (ebx & (1u << 5)) != 0;
+        features.sha_ni = (ebx & (1u << 29)) != 0;
+    }
+    (void)eax;
+#endif
+    return features;
+}
+
+bool have_cycle_counter() {
+#if defined(UNLOCK_PDF_HAVE_X86)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t read_cycle_counter() {
+#if defined(UNLOCK_PDF_HAVE_X86)
+    return static_cast<std::uint64_t>(__rdtsc());
+#else
+    return 0;
+#endif
+}
+
+std::vector<unsigned char> make_input(std::size_t size, unsigned char seed) {
+    std::vector<unsigned char> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<unsigned char>(seed + i * 131u);
+    }
+    return data;
+}
+
+// The repository only ships portable scalar kernels. Every case is tagged with
+// its variant so the report keeps the same shape once accelerated paths exist.
+std::vector<BenchCase> build_cases() {
+    using namespace unlock_pdf::crypto;
+
+    std::vector<BenchCase> cases;
+    const char* scalar = "scalar";
+
+    for (std::size_t size : {16u, 84u, 1024u}) {
+        auto input = std::make_shared<std::vector<unsigned char>>(make_input(size, 0x11));
+        cases.push_back({"md5_bytes/" + std::to_string(size), scalar, size, [input]() {
+                             auto digest = md5_bytes(*input);
+                             (*input)[0] ^= digest[0];
+                             return digest[0];
+                         }});
+    }
+
+    for (std::size_t size : {5u, 16u}) {
+        auto key = std::make_shared<std::vector<unsigned char>>(make_input(size, 0x22));
+        auto rc4 = std::make_shared<RC4>();
+        cases.push_back({"rc4_set_key/" + std::to_string(size), scalar, size, [key, rc4]() {
+                             rc4->set_key(*key);
+                             unsigned char byte = 0;
+                             rc4->crypt(&byte, &byte, 1);
+                             (*key)[0] ^= byte;
+                             return byte;
+                         }});
+    }
+
+    for (std::size_t size : {32u, 1024u}) {
+        auto buffer = std::make_shared<std::vector<unsigned char>>(make_input(size, 0x33));
+        auto rc4 = std::make_shared<RC4>(make_input(16, 0x44));
+        cases.push_back({"rc4_crypt/" + std::to_string(size), scalar, size, [buffer, rc4]() {
+                             rc4->crypt(buffer->data(), buffer->data(), buffer->size());
+                             return (*buffer)[0];
+                         }});
+    }
+
+    {
+        auto encryptor = std::make_shared<AES128Encryptor>(make_input(16, 0x55));
+        auto block = std::make_shared<std::vector<unsigned char>>(make_input(16, 0x66));
+        cases.push_back({"aes128_encrypt_block/16", scalar, 16, [encryptor, block]() {
+                             encryptor->encrypt_block(block->data(), block->data());
+                             return (*block)[0];
+                         }});
+    }
+
+    for (std::size_t size : {32u, 1024u}) {
+        auto key = std::make_shared<std::vector<unsigned char>>(make_input(32, 0x77));
+        auto iv = std::make_shared<std::vector<unsigned char>>(16, 0);
+        auto ciphertext = std::make_shared<std::vector<unsigned char>>(make_input(size, 0x88));
+        auto plaintext = std::make_shared<std::vector<unsigned char>>();
+        cases.push_back({"aes256_cbc_decrypt/" + std::to_string(size), scalar, size,
+                         [key, iv, ciphertext, plaintext]() {
+                             aes256_cbc_decrypt(*key, *iv, *ciphertext, *plaintext, false);
+                             (*ciphertext)[0] ^= plaintext->empty() ? 0 : (*plaintext)[0];
+                             return (*ciphertext)[0];
+                         }});
+    }
+
+    // 64 bytes is a single block; 2560 bytes is the R6 inner-loop input for an
+    // 8 byte password (64 repetitions of password + 32 byte hash).
+    for (std::size_t bits : {256u, 384u, 512u}) {
+        for (std::size_t size : {64u, 2560u}) {
+            auto input = std::make_shared<std::vector<unsigned char>>(make_input(size, 0x99));
+            cases.push_back({"sha" + std::to_string(bits) + "/" + std::to_string(size), scalar, size,
+                             [input, bits]() {
+                                 auto digest = sha2_hash(*input, bits);
+                                 (*input)[0] ^= digest[0];
+                                 return digest[0];
+                             }});
+        }
+    }
+
+    for (int revision : {5, 6}) {
+        auto salt = std::make_shared<std::vector<unsigned char>>(make_input(8, 0xAA));
+        auto password = std::make_shared<std::string>("password");
+        cases.push_back({"compute_hash_v5/R" + std::to_string(revision), scalar, password->size(),
+                         [salt, password, revision]() {
+                             auto hash = unlock_pdf::pdf::standard_security::compute_hash_v5(
+                                 *password, salt->data(), salt->size(), nullptr, 0, revision);
+                             (*salt)[0] ^= hash.empty() ? 0 : hash[0];
+                             return (*salt)[0];
+                         }});
+    }
+
+    return cases;
+}
+
+BenchResult run_case(const BenchCase& bench, std::chrono::milliseconds min_time) {
+    volatile unsigned char sink = 0;
+    for (int i = 0; i < 3; ++i) {
+        sink = sink ^ bench.run();
+    }
+
+    // Double the batch until one batch takes at least `min_time`, so timer and
+    // loop overhead stay negligible for the fastest kernels.
+    std::uint64_t iterations = 1;
+    double elapsed_ns = 0.0;
+    std::uint64_t cycles = 0;
+    while (true) {
+        std::uint64_t start_cycles = read_cycle_counter();
+        auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            sink = sink ^ bench.run();
+        }
+        auto end = std::chrono::steady_clock::now();
+        cycles = read_cycle_counter() - start_cycles;
+        elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (elapsed_ns >= static_cast<double>(std::chrono::nanoseconds(min_time).count()) ||
+            iterations >= (std::uint64_t{1} << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    (void)sink;
+
+    BenchResult result;
+    result.name = bench.name;
+    result.variant = bench.variant;
+    result.bytes = bench.bytes;
+    result.iterations = iterations;
+    result.ns_per_op = elapsed_ns / static_cast<double>(iterations);
+    double total_bytes = static_cast<double>(bench.bytes) * static_cast<double>(iterations);
+    if (elapsed_ns > 0.0) {
+        result.megabytes_per_second = total_bytes / (elapsed_ns / 1e9) / 1e6;
+    }
+    if (have_cycle_counter() && total_bytes > 0.0) {
+        result.cycles_per_byte = static_cast<double>(cycles) / total_bytes;
+    }
+    return result;
+}
+
+void write_json(std::ostream& out,
+                const std::string& cpu_model,
+                const CpuFeatures& features,
+                const std::vector<BenchResult>& results) {
+    auto flag = [](bool value) { return value ? "true" : "false"; };
+    out << "{\n";
+    out << "  \"cpu_model\": \"" << unlock_pdf::util::json_escape(cpu_model) << "\",\n";
+    out << "  \"cpu_features\": {\"sse2\": " << flag(features.sse2) << ", \"ssse3\": " << flag(features.ssse3)
+        << ", \"sse4_1\": " << flag(features.sse41) << ", \"avx2\": " << flag(features.avx2)
+        << ", \"aes_ni\": " << flag(features.aesni) << ", \"sha_ni\": " << flag(features.sha_ni) << "},\n";
+    out << "  \"cycle_counter\": \"" << (have_cycle_counter() ? "tsc" : "none") << "\",\n";
+    out << "  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << unlock_pdf::util::json_escape(result.name)
+            << "\", \"variant\": \"" << result.variant << "\", \"bytes\": " << result.bytes
+            << ", \"iterations\": " << result.iterations
+            << std::fixed << std::setprecision(2) << ", \"ns_per_op\": " << result.ns_per_op
+            << ", \"mb_per_second\": " << result.megabytes_per_second << ", \"cycles_per_byte\": ";
+        if (result.cycles_per_byte >= 0.0) {
+            out << result.cycles_per_byte;
+        } else {
+            out << "null";
+        }
+        out.unsetf(std::ios::floatfield);
+        out << '}';
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Every kernel variant the benchmark can select has to pass the same checks;
+// today that is only the scalar code.
+int run_verification(const BenchConfig& config) {
+    unlock_pdf::pdf::SelfTestOptions options;
+    options.seed = config.seed;
+    options.verbose = config.verbose;
+
+    std::cout << "Verifying scalar kernels" << std::endl;
+    unlock_pdf::pdf::SelfTestSummary summary = unlock_pdf::pdf::run_self_tests(options, std::cout);
+    std::cout << (summary.failed == 0 ? "PASSED" : "FAILED") << ": " << summary.passed << " checks passed, "
+              << summary.failed << " failed (seed " << summary.seed << ")" << std::endl;
+    return summary.failed == 0 ? 0 : 1;
+}
+
+void print_help(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n\n"
+              << "Times the crypto primitives behind the PDF password checks.\n\n"
+              << "Options:\n"
+              << "  --filter <text>      Only run benchmarks whose name contains <text>\n"
+              << "  --min-time <ms>      Minimum measured time per benchmark (default: 200)\n"
+              << "  --json <path>        Also write the results as JSON to <path> (- for stdout)\n"
+              << "  --verify             Check the primitives and handlers against known answers\n"
+              << "                       instead of timing them; exits non-zero on any mismatch\n"
+              << "  --seed <n>           Seed for the randomized --verify inputs (default: random)\n"
+              << "  --verbose            List every --verify group, not only failures\n"
+              << "  --help               Show this help message\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        auto require_value = [&](std::string_view option) -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for option: " + std::string(option));
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--help" || arg == "-h") {
+            print_help(argv[0]);
+            return 0;
+        } else if (arg == "--filter") {
+            config.filter = require_value(arg);
+        } else if (arg == "--min-time") {
+            config.min_time_ms = static_cast<std::size_t>(std::stoull(require_value(arg)));
+        } else if (arg == "--json") {
+            config.json_path = require_value(arg);
+        } else if (arg == "--verify") {
+            config.verify = true;
+        } else if (arg == "--seed") {
+            config.seed = static_cast<std::uint32_t>(std::stoul(require_value(arg)));
+        } else if (arg == "--verbose") {
+            config.verbose = true;
+        } else {
+            throw std::runtime_error("Unknown option: " + std::string(arg));
+        }
+    }
+
+    if (config.verify) {
+        return run_verification(config);
+    }
+
+    const std::string cpu_model = unlock_pdf::util::cpu_model_name();
+    const CpuFeatures features = detect_cpu_features();
+    std::ostream& report = config.json_path == "-" ? std::cerr : std::cout;
+
+    report << "CPU Model:           " << cpu_model << '\n';
+    report << "CPU Features:       " << (features.sse2 ? " SSE2" : "") << (features.ssse3 ? " SSSE3" : "")
+           << (features.sse41 ? " SSE4.1" : "") << (features.avx2 ? " AVX2" : "") << (features.aesni ? " AES-NI" : "")
+           << (features.sha_ni ? " SHA-NI" : "") << '\n';
+    report << "Kernel variants:     scalar\n";
+    report << "Cycle counter:       " << (have_cycle_counter() ? "TSC (reference cycles)" : "unavailable") << "\n\n";
+
+    report << std::left << std::setw(28) << "Benchmark" << std::setw(10) << "Variant" << std::setw(16) << "ns/op"
+           << std::setw(14) << "MB/s" << "cycles/byte" << '\n';
+    report << std::string(80, '-') << '\n';
+
+    std::vector<BenchResult> results;
+    for (const auto& bench : build_cases()) {
+        if (!config.filter.empty() && bench.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult result = run_case(bench, std::chrono::milliseconds(config.min_time_ms));
+
+        std::ostringstream ns;
+        ns << std::fixed << std::setprecision(2) << result.ns_per_op;
+        std::ostringstream mbps;
+        mbps << std::fixed << std::setprecision(2) << result.megabytes_per_second;
+        std::ostringstream cpb;
+        if (result.cycles_per_byte >= 0.0) {
+            cpb << std::fixed << std::setprecision(2) << result.cycles_per_byte;
+        } else {
+            cpb << "n/a";
+        }
+        report << std::left << std::setw(28) << result.name << std::setw(10) << result.variant << std::setw(16)
+               << ns.str() << std::setw(14) << mbps.str() << cpb.str() << std::endl;
+        results.push_back(result);
+    }
+
+    if (config.json_path == "-") {
+        write_json(std::cout, cpu_model, features, results);
+    } else if (!config.json_path.empty()) {
+        std::ofstream out(config.json_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: Unable to write JSON report to " << config.json_path << std::endl;
+            return 1;
+        }
+        write_json(out, cpu_model, features, results);
+        report << "\nJSON report written to " << config.json_path << '\n';
+    }
+
+    return 0;
+}
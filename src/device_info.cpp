@@ -4,6 +4,7 @@
 #include <cctype>
 #include <cstdint>
 #include <functional>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -15,8 +16,11 @@
 #include "crypto/sha2.h"
 #include "pdf/encryption/encryption_handler_registry.h"
 #include "pdf/encryption/encryption_handler.h"
+#include "pdf/handler_benchmark.h"
 #include "pdf/pdf_parser.h"
+#include "pdf/test_pdf_generator.h"
 #include "util/system_info.h"
+#include "util/json.h"
 
 namespace {
 
@@ -37,6 +41,31 @@ struct BenchmarkConfig {
     Workload workload = Workload::Synthetic;
     HashMode hash_mode = HashMode::StdHash;
     std::string pdf_path;
+    std::vector<unsigned int> thread_counts;  // non-empty selects the scaling sweep
+    std::vector<int> revisions = {2, 3, 4, 5, 6};
+    std::size_t window_ms = 1000;
+    std::uint64_t min_attempts = 200;
+    std::string json_path;
+};
+
+// How many windows' worth of time a sweep point may run while it is short of
+// --min-attempts, so a very slow handler still finishes in bounded time.
+constexpr std::size_t kMaxWindowsPerPoint = 20;
+
+struct ScalingPoint {
+    unsigned int threads = 0;
+    std::uint64_t attempts = 0;
+    double attempts_per_second = 0.0;
+    double speedup = 0.0;
+    double efficiency = 0.0;
+    bool few_attempts = false;    // still below --min-attempts when its time ran out
+    bool oversubscribed = false;  // more threads than effective CPUs
+};
+
+struct ScalingSeries {
+    std::string label;
+    int revision = 0;
+    std::vector<ScalingPoint> points;
 };
 
 struct BenchmarkResult {
@@ -67,6 +96,13 @@ void print_help(const char* program) {
               << "  --custom <chars>     Use a custom character set (overrides other charset options)\n"
               << "  --hash <mode>        Synthetic hash mode: none or sha256 (default: none)\n"
               << "  --pdf <path>         Benchmark the real PDF password check using metadata from <path>\n"
+              << "  --threads <list>     Run a scaling sweep over the given thread counts, e.g. 1,2,4,8.\n"
+              << "                       A single number N expands to 1,2,4,...,N; \"auto\" sweeps up to the\n"
+              << "                       effective CPU count\n"
+              << "  --revisions <list>   Security handler revisions for the sweep summary (default: 2,3,4,5,6)\n"
+              << "  --window <ms>        Measurement window per sweep point (default: 1000)\n"
+              << "  --min-attempts <n>   Repeat a sweep point's window until n attempts completed (default: 200)\n"
+              << "  --json <path>        Also write the sweep results as JSON to <path> (- for stdout)\n"
               << "  --help               Show this help message\n";
 }
 
@@ -127,23 +163,6 @@ BenchmarkResult run_benchmark(std::size_t length,
     return BenchmarkResult{length, attempts, duration, throughput};
 }
 
-std::vector<const unlock_pdf::pdf::EncryptionHandler*> collect_password_handlers(
-    const unlock_pdf::pdf::PDFEncryptInfo& info,
-    const std::vector<unlock_pdf::pdf::EncryptionHandlerPtr>& handlers) {
-    std::vector<const unlock_pdf::pdf::EncryptionHandler*> password_handlers;
-    password_handlers.reserve(handlers.size());
-    for (const auto& handler : handlers) {
-        if (!handler) {
-            continue;
-        }
-        if (!handler->can_handle(info) || !handler->requires_password()) {
-            continue;
-        }
-        password_handlers.push_back(handler.get());
-    }
-    return password_handlers;
-}
-
 int effective_key_length_bits(const unlock_pdf::pdf::PDFEncryptInfo& info) {
     if (info.length > 0) {
         return info.length;
@@ -160,57 +179,229 @@ int effective_key_length_bits(const unlock_pdf::pdf::PDFEncryptInfo& info) {
     return 256;
 }
 
-BenchmarkResult run_pdf_benchmark(std::size_t length,
-                                  std::size_t attempts,
-                                  const std::string& charset,
-                                  const unlock_pdf::pdf::PDFEncryptInfo& info,
-                                  const std::vector<const unlock_pdf::pdf::EncryptionHandler*>& handlers) {
-    if (charset.empty() || length == 0 || attempts == 0 || handlers.empty()) {
-        return BenchmarkResult{length, attempts, 0.0, 0.0};
+std::vector<unsigned int> expand_thread_counts(const std::string& value) {
+    std::vector<unsigned int> counts;
+    if (value == "auto") {
+        counts = expand_thread_counts(std::to_string(unlock_pdf::util::effective_cpu_count()));
+        return counts;
     }
 
-    const std::size_t charset_size = charset.size();
-    const char first_char = charset.front();
-    const char* charset_data = charset.data();
-    std::string candidate(length, first_char);
-    std::vector<std::size_t> indices(length, 0);
-    std::string matched_variant;
+    for (const auto& token : split_lengths(value)) {
+        unsigned long count = std::stoul(token);
+        if (count == 0) {
+            throw std::runtime_error("Thread counts must be greater than zero.");
+        }
+        counts.push_back(static_cast<unsigned int>(count));
+    }
+    if (counts.size() == 1 && counts.front() > 1) {
+        unsigned int max_threads = counts.front();
+        counts.clear();
+        for (unsigned int threads = 1; threads < max_threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(max_threads);
+    }
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
 
-    volatile bool sink = false;
-    auto start = std::chrono::steady_clock::now();
-    for (std::size_t attempt = 0; attempt < attempts; ++attempt) {
-        bool matched = false;
-        matched_variant.clear();
-        for (const auto* handler : handlers) {
-            if (handler->check_password(candidate, info, matched_variant)) {
-                matched = true;
-                break;
-            }
+// Encryption parameters of a freshly generated document for `revision`, so
+// every handler runs on consistent entries. Benchmark candidates never equal
+// the generated password, so each check takes the full rejection path, which
+// is what dominates a real search.
+bool make_revision_encrypt_info(int revision, unlock_pdf::pdf::PDFEncryptInfo& info) {
+    unlock_pdf::pdf::TestPdfOptions options;
+    options.revision = revision;
+    options.user_password = "device_probe user";
+    options.owner_password = "device_probe owner";
+    options.seed = 0x5eed0000u + static_cast<std::uint32_t>(revision);
+    std::string pdf;
+    return unlock_pdf::pdf::build_test_pdf(options, pdf, info);
+}
+
+// A point is measured over whole windows until it has at least
+// --min-attempts attempts: with a slow handler, one window can hold so few
+// that a difference of a couple of attempts reads as scaling.
+ScalingSeries run_scaling_series(const std::string& label,
+                                 const unlock_pdf::pdf::PDFEncryptInfo& info,
+                                 const std::vector<const unlock_pdf::pdf::EncryptionHandler*>& handlers,
+                                 const BenchmarkConfig& config,
+                                 std::size_t length,
+                                 unsigned int effective_cpus) {
+    ScalingSeries series;
+    series.label = label;
+    series.revision = info.revision;
+
+    double per_thread_baseline = 0.0;
+    for (unsigned int threads : config.thread_counts) {
+        ScalingPoint point;
+        point.threads = threads;
+        double seconds = 0.0;
+        double budget_seconds = static_cast<double>(kMaxWindowsPerPoint * config.window_ms) / 1000.0;
+        do {
+            auto sample = unlock_pdf::pdf::run_handler_benchmark_timed(
+                length, config.charset, info, handlers, threads, std::chrono::milliseconds(config.window_ms));
+            point.attempts += sample.attempts;
+            seconds += sample.duration_seconds;
+        } while (point.attempts < config.min_attempts && seconds < budget_seconds);
+        point.attempts_per_second = seconds > 0.0 ? static_cast<double>(point.attempts) / seconds : 0.0;
+        point.few_attempts = point.attempts < config.min_attempts;
+        point.oversubscribed = effective_cpus > 0 && threads > effective_cpus;
+        if (series.points.empty()) {
+            per_thread_baseline = point.attempts_per_second / threads;
         }
-        sink = sink || matched;
+        if (per_thread_baseline > 0.0) {
+            point.speedup = point.attempts_per_second / per_thread_baseline;
+            point.efficiency = point.speedup / threads;
+        }
+        series.points.push_back(point);
+    }
+    return series;
+}
 
-        std::size_t pos = 0;
-        while (pos < length) {
-            std::size_t next_index = indices[pos] + 1;
-            if (next_index < charset_size) {
-                indices[pos] = next_index;
-                candidate[pos] = charset_data[next_index];
-                break;
-            }
-            indices[pos] = 0;
-            candidate[pos] = first_char;
-            ++pos;
+// Why a point's speedup should not be read as scaling, empty when it can.
+std::string point_notes(const ScalingPoint& point) {
+    std::string notes;
+    if (point.few_attempts) {
+        notes = "few attempts";
+    }
+    if (point.oversubscribed) {
+        notes += notes.empty() ? "more threads than CPUs" : ", more threads than CPUs";
+    }
+    return notes;
+}
+
+void print_scaling_series(const ScalingSeries& series) {
+    std::cout << series.label << '\n';
+    std::cout << std::left << std::setw(10) << "Threads" << std::setw(16) << "Attempts" << std::setw(18)
+              << "Candidates/s" << std::setw(12) << "Speedup" << std::setw(12) << "Efficiency" << "Notes" << '\n';
+    std::cout << std::string(90, '-') << '\n';
+    for (const auto& point : series.points) {
+        std::ostringstream rate;
+        rate << std::fixed << std::setprecision(2) << point.attempts_per_second;
+        std::ostringstream speedup;
+        speedup << std::fixed << std::setprecision(2) << point.speedup << 'x';
+        std::ostringstream efficiency;
+        efficiency << std::fixed << std::setprecision(1) << point.efficiency * 100.0 << '%';
+        std::cout << std::left << std::setw(10) << point.threads << std::setw(16) << point.attempts << std::setw(18)
+                  << rate.str() << std::setw(12) << speedup.str() << std::setw(12) << efficiency.str()
+                  << point_notes(point) << '\n';
+    }
+    std::cout << '\n';
+}
+
+const ScalingPoint* best_point(const ScalingSeries& series) {
+    const ScalingPoint* best = nullptr;
+    for (const auto& point : series.points) {
+        if (!best || point.attempts_per_second > best->attempts_per_second) {
+            best = &point;
         }
     }
-    auto end = std::chrono::steady_clock::now();
+    return best;
+}
 
-    std::chrono::duration<double> elapsed = end - start;
-    double duration = elapsed.count();
-    double throughput = duration > 0.0 ? static_cast<double>(attempts) / duration : 0.0;
+void print_scaling_summary(const std::vector<ScalingSeries>& all_series) {
+    std::cout << "Scaling Summary\n";
+    std::cout << std::left << std::setw(28) << "Workload" << std::setw(16) << "Baseline/s" << std::setw(16)
+              << "Best/s" << std::setw(10) << "Threads" << std::setw(12) << "Speedup" << std::setw(12) << "Efficiency"
+              << "Notes" << '\n';
+    std::cout << std::string(116, '-') << '\n';
+    for (const auto& series : all_series) {
+        const ScalingPoint* best = best_point(series);
+        if (!best) {
+            continue;
+        }
+        std::ostringstream first_rate;
+        first_rate << std::fixed << std::setprecision(2) << series.points.front().attempts_per_second;
+        std::ostringstream best_rate;
+        best_rate << std::fixed << std::setprecision(2) << best->attempts_per_second;
+        std::ostringstream speedup;
+        speedup << std::fixed << std::setprecision(2) << best->speedup << 'x';
+        std::ostringstream efficiency;
+        efficiency << std::fixed << std::setprecision(1) << best->efficiency * 100.0 << '%';
+        std::cout << std::left << std::setw(28) << series.label << std::setw(16) << first_rate.str() << std::setw(16)
+                  << best_rate.str() << std::setw(10) << best->threads << std::setw(12) << speedup.str()
+                  << std::setw(12) << efficiency.str() << point_notes(*best) << '\n';
+    }
+    std::cout << '\n';
+}
 
-    (void)sink;
+void write_scaling_json(std::ostream& out,
+                        const unlock_pdf::util::SystemInfo& info,
+                        const BenchmarkConfig& config,
+                        std::size_t length,
+                        const std::vector<ScalingSeries>& all_series) {
+    out << "{\n";
+    out << "  \"system\": {\"hostname\": \"" << unlock_pdf::util::json_escape(info.hostname) << "\", \"cpu_model\": \""
+        << unlock_pdf::util::json_escape(info.cpu_model) << "\", \"hardware_threads\": " << info.cpu_threads
+        << ", \"effective_cpus\": " << info.effective_cpus << ", \"physical_cores\": " << info.physical_cores
+        << "},\n";
+    out << "  \"config\": {\"password_length\": " << length << ", \"charset_size\": " << config.charset.size()
+        << ", \"window_ms\": " << config.window_ms << ", \"min_attempts\": " << config.min_attempts << "},\n";
+    out << "  \"series\": [";
+    for (std::size_t i = 0; i < all_series.size(); ++i) {
+        const auto& series = all_series[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"label\": \"" << unlock_pdf::util::json_escape(series.label)
+            << "\", \"revision\": " << series.revision << ", \"points\": [";
+        for (std::size_t j = 0; j < series.points.size(); ++j) {
+            const auto& point = series.points[j];
+            out << (j == 0 ? "" : ", ") << "{\"threads\": " << point.threads << ", \"attempts\": " << point.attempts
+                << std::fixed << std::setprecision(2) << ", \"candidates_per_second\": " << point.attempts_per_second
+                << std::setprecision(4) << ", \"speedup\": " << point.speedup << ", \"efficiency\": "
+                << point.efficiency << ", \"few_attempts\": " << (point.few_attempts ? "true" : "false")
+                << ", \"oversubscribed\": " << (point.oversubscribed ? "true" : "false") << '}';
+            out.unsetf(std::ios::floatfield);
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
 
-    return BenchmarkResult{length, attempts, duration, throughput};
+int run_scaling_benchmark(const BenchmarkConfig& config,
+                          std::size_t length,
+                          const unlock_pdf::util::SystemInfo& system_info,
+                          const unlock_pdf::pdf::PDFEncryptInfo* pdf_info,
+                          const std::vector<const unlock_pdf::pdf::EncryptionHandler*>& pdf_handlers) {
+    std::vector<ScalingSeries> all_series;
+    if (pdf_info) {
+        all_series.push_back(run_scaling_series(
+            config.pdf_path, *pdf_info, pdf_handlers, config, length, system_info.effective_cpus));
+        print_scaling_series(all_series.back());
+    }
+
+    auto handler_storage = unlock_pdf::pdf::create_default_encryption_handlers();
+    for (int revision : config.revisions) {
+        unlock_pdf::pdf::PDFEncryptInfo info;
+        if (!make_revision_encrypt_info(revision, info)) {
+            continue;
+        }
+        auto handlers = unlock_pdf::pdf::collect_password_handlers(info, handler_storage);
+        if (handlers.empty()) {
+            std::cerr << "Warning: no password handlers for revision R" << revision << ", skipping." << std::endl;
+            continue;
+        }
+        all_series.push_back(
+            run_scaling_series("R" + std::to_string(revision) + " (generated)", info, handlers, config, length,
+                               system_info.effective_cpus));
+        print_scaling_series(all_series.back());
+    }
+
+    print_scaling_summary(all_series);
+
+    if (config.json_path == "-") {
+        write_scaling_json(std::cout, system_info, config, length, all_series);
+    } else if (!config.json_path.empty()) {
+        std::ofstream out(config.json_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: Unable to write JSON report to " << config.json_path << std::endl;
+            return 1;
+        }
+        write_scaling_json(out, system_info, config, length, all_series);
+        std::cout << "JSON report written to " << config.json_path << '\n';
+    }
+    return 0;
 }
 
 }  // namespace
@@ -257,6 +448,23 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--pdf") {
             config.workload = Workload::Pdf;
             config.pdf_path = require_value(arg);
+        } else if (arg == "--threads") {
+            config.thread_counts = expand_thread_counts(require_value(arg));
+        } else if (arg == "--revisions") {
+            config.revisions.clear();
+            for (const auto& token : split_lengths(require_value(arg))) {
+                std::string revision = token;
+                if (!revision.empty() && (revision.front() == 'R' || revision.front() == 'r')) {
+                    revision.erase(0, 1);
+                }
+                config.revisions.push_back(std::stoi(revision));
+            }
+        } else if (arg == "--window") {
+            config.window_ms = static_cast<std::size_t>(std::stoull(require_value(arg)));
+        } else if (arg == "--min-attempts") {
+            config.min_attempts = std::stoull(require_value(arg));
+        } else if (arg == "--json") {
+            config.json_path = require_value(arg);
         } else {
             throw std::runtime_error("Unknown option: " + std::string(arg));
         }
@@ -302,7 +510,7 @@ int main(int argc, char* argv[]) {
         }
 
         handler_storage = unlock_pdf::pdf::create_default_encryption_handlers();
-        password_handlers = collect_password_handlers(pdf_info, handler_storage);
+        password_handlers = unlock_pdf::pdf::collect_password_handlers(pdf_info, handler_storage);
         if (password_handlers.empty()) {
             std::cerr << "Error: No password-based handlers are applicable to the provided PDF." << std::endl;
             return 1;
@@ -322,8 +530,30 @@ int main(int argc, char* argv[]) {
     std::cout << "Architecture:        " << info.architecture << '\n';
     std::cout << "CPU Model:           " << info.cpu_model << '\n';
     std::cout << "Hardware Threads:    " << info.cpu_threads << '\n';
+    if (info.affinity_cpus > 0) {
+        std::cout << "Affinity CPUs:       " << info.affinity_cpus << '\n';
+    }
+    std::cout << "cgroup CPU Quota:    ";
+    if (info.cgroup_cpu_quota > 0.0) {
+        std::cout << std::fixed << std::setprecision(2) << info.cgroup_cpu_quota << " CPUs" << '\n';
+        std::cout.unsetf(std::ios::floatfield);
+    } else {
+        std::cout << "unlimited" << '\n';
+    }
+    std::cout << "Effective CPUs:      " << info.effective_cpus << '\n';
+    if (info.physical_cores > 0) {
+        std::cout << "Physical Cores:      " << info.physical_cores << '\n';
+    }
+    if (info.numa_nodes > 0) {
+        std::cout << "NUMA Nodes:          " << info.numa_nodes << '\n';
+    }
     std::cout << "Total Memory:        " << unlock_pdf::util::human_readable_bytes(info.total_memory_bytes) << '\n';
-    std::cout << "Available Memory:    " << unlock_pdf::util::human_readable_bytes(info.available_memory_bytes) << "\n\n";
+    std::cout << "Available Memory:    " << unlock_pdf::util::human_readable_bytes(info.available_memory_bytes) << '\n';
+    std::cout << "cgroup Memory Limit: "
+              << (info.cgroup_memory_limit_bytes > 0
+                      ? unlock_pdf::util::human_readable_bytes(info.cgroup_memory_limit_bytes)
+                      : std::string("unlimited"))
+              << "\n\n";
 
     std::cout << "Benchmark Configuration\n";
     std::cout << "------------------------\n";
@@ -351,6 +581,26 @@ int main(int argc, char* argv[]) {
                   << (config.hash_mode == HashMode::Sha256 ? "SHA-256" : "None (std::hash)") << '\n';
         std::cout << "Note:               Use --pdf <file.pdf> to benchmark the real PDF password check." << '\n';
     }
+    if (!config.thread_counts.empty()) {
+        std::size_t length = 8;
+        for (std::size_t candidate_length : lengths) {
+            if (candidate_length > 0) {
+                length = candidate_length;
+                break;
+            }
+        }
+        std::cout << "Scaling sweep:       threads";
+        for (unsigned int threads : config.thread_counts) {
+            std::cout << ' ' << threads;
+        }
+        std::cout << ", " << config.window_ms << " ms per point (at least " << config.min_attempts
+                  << " attempts), password length " << length << "\n\n";
+        return run_scaling_benchmark(config,
+                                     length,
+                                     info,
+                                     config.workload == Workload::Pdf ? &pdf_info : nullptr,
+                                     password_handlers);
+    }
     std::cout << "Attempts per test:   " << config.attempts << "\n\n";
 
     std::cout << std::left << std::setw(12) << "Length" << std::setw(18) << "Attempts" << std::setw(18) << "Duration (s)"
@@ -363,7 +613,9 @@ int main(int argc, char* argv[]) {
         }
         BenchmarkResult result;
         if (config.workload == Workload::Pdf) {
-            result = run_pdf_benchmark(length, config.attempts, config.charset, pdf_info, password_handlers);
+            auto pdf_result = unlock_pdf::pdf::run_handler_benchmark(
+                length, config.attempts, config.charset, pdf_info, password_handlers);
+            result = BenchmarkResult{length, config.attempts, pdf_result.duration_seconds, pdf_result.attempts_per_second};
         } else {
             result = run_benchmark(length,
                                    config.attempts,
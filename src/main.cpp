@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "pdf/info_batch.h"
+#include "pdf/pdf_hash.h"
 #include "pdf/pdf_cracker.h"
 #include "pdf/pdf_parser.h"
+#include "util/prince.h"
 #include "util/wordlist_generator.h"
 
 namespace {
@@ -11,10 +20,60 @@ namespace {
 void print_usage(const char* program) {
     std::cout << "Usage: " << program << " [options]\n\n"
               << "PDF Password Retriever options:\n"
-              << "  --info <path>              Print PDF encryption details and exit\n"
-              << "  --pdf <path>                Path to the encrypted PDF file\n"
+              << "  --info <path>              Print PDF encryption details and exit. Repeatable; also\n"
+              << "                              takes directories (every *.pdf below them), file-name\n"
+              << "                              wildcards and @list files (@- reads stdin), which are\n"
+              << "                              read in parallel on --threads workers\n"
+              << "  --info-format <fmt>         text, jsonl (one JSON object per file with V, R, key\n"
+              << "                              length, filters, permissions, owner-only flag and cost\n"
+              << "                              class) or hash (as --extract-hash). Default: text for\n"
+              << "                              one file, jsonl for batches\n"
+              << "  --extract-hash <path>       Print a pdf2john-style \"path:$pdf$...\" line with the\n"
+              << "                              encryption parameters and exit; takes the same\n"
+              << "                              arguments as --info\n"
+              << "  --hash-file <path>          Crack the records of a hash file instead of a PDF\n"
+              << "                              (all records in one pass over the candidates)\n"
+              << "  --verbose                   Also dump the PDF keywords found while reading the file\n"
+              << "  --pdf <path>                Path to the encrypted PDF file; repeat it to crack\n"
+              << "                              several files in one pass over the candidates\n"
               << "  --wordlist <path>           Path to a password wordlist file (streamed on demand)\n"
-              << "  --threads <n>               Number of worker threads (default: auto)\n\n"
+              << "  --rules <path>              hashcat/John rule file applied to every wordlist word;\n"
+              << "                              the rules run on the worker threads\n"
+              << "  --combine <path>            Join every wordlist word with every word of a second\n"
+              << "                              list (word1word2); the smaller list is kept in memory\n"
+              << "  --append-mask <mask>        Append every expansion of a mask to each wordlist word,\n"
+              << "                              e.g. ?d?d?d?d for years (?l ?u ?d ?s ?a ?h ?H ?b, ?? = ?)\n"
+              << "  --prepend-mask <mask>       Same, with the mask in front of the word\n"
+              << "  --prince                    Chain 1 to N wordlist words into each candidate (PRINCE),\n"
+              << "                              fewest words first; the list is kept in memory\n"
+              << "  --prince-elements <n>       Most words per --prince candidate (default: 4, at most 8)\n"
+              << "  --prince-min-length <n>     Shortest --prince candidate (default: 1)\n"
+              << "  --prince-max-length <n>     Longest --prince candidate (default: the PDF's limit)\n"
+              << "  --estimate                  Print the keyspace and expected wall time per length after\n"
+              << "                              a short calibration, without cracking\n"
+              << "  --threads <n>               Number of worker threads (default: auto)\n"
+              << "  --progress-interval <ms>    Milliseconds between progress updates (default: 500)\n"
+              << "  --progress-format <fmt>     text (default) or jsonl: one JSON event per line for\n"
+              << "                              start, progress, found, finished and error\n"
+              << "  --progress-fd <n>           Write the jsonl events to file descriptor <n> instead of\n"
+              << "                              stdout (implies --progress-format jsonl)\n"
+              << "  --affinity <policy>         Pin worker threads: none, compact, scatter or physical-only\n"
+              << "                              (default: none)\n"
+              << "  --batch-size <n>            Wordlist candidates fetched per worker access (default: auto)\n"
+              << "  --autotune                  Calibrate thread count and batch size for this CPU and\n"
+              << "                              encryption revision (cached under ~/.cache/unlock_pdf)\n"
+              << "  --metrics-jsonl <path>      Append periodic metrics snapshots as JSON lines\n"
+              << "  --metrics-prom <path>       Write metrics in Prometheus text format (textfile collector)\n"
+              << "  --metrics-interval <ms>     Milliseconds between metrics snapshots (default: 5000)\n"
+              << "  --potfile <path>            Cache of cracked documents (default: unlock_pdf.potfile\n"
+              << "                              in the user cache directory)\n"
+              << "  --no-potfile                Neither consult nor update the potfile\n"
+              << "  --coverage-db <path>        Candidate ranges finished per document in earlier runs,\n"
+              << "                              skipped by later ones (default: coverage.tsv in the\n"
+              << "                              user cache directory)\n"
+              << "  --no-coverage-db            Test every candidate and record nothing\n"
+              << "  --show                      Print \"label:password\" for every target already in the\n"
+              << "                              potfile and exit without cracking\n\n"
               << "Brute-force configuration:\n"
               << "  --min-length <n>            Minimum password length (default: 6)\n"
               << "  --max-length <n>            Maximum password length (default: 32)\n"
@@ -27,11 +86,33 @@ void print_usage(const char* program) {
               << "  --include-special           Include special characters\n"
               << "  --exclude-special           Exclude special characters\n"
               << "  --custom-chars <chars>      Use the provided characters\n"
-              << "  --use-custom-only           Only use the provided custom characters\n\n"
+              << "  --use-custom-only           Only use the provided custom characters\n"
+              << "  --markov-stats <path>       Try likely characters first, ordered per position and\n"
+              << "                              previous character by these statistics\n"
+              << "  --markov-threshold <n>      Keep only the <n> likeliest characters per position\n"
+              << "                              (default: all)\n"
+              << "  --markov-train <wordlist>   Build --markov-stats from a wordlist and exit\n\n"
+              << "Grammar configuration:\n"
+              << "  --pcfg-grammar <path>       Try the guesses of a trained grammar, most probable first,\n"
+              << "                              instead of a wordlist or brute force\n"
+              << "  --pcfg-train <wordlist>     Build --pcfg-grammar from a wordlist and exit\n\n"
               << "Passwords are generated and tested on the fly, so even extremely large wordlists\n"
                  "can be processed without exhausting system memory.\n";
 }
 
+// Points std::cout at another stream buffer while it lives.
+class CoutRedirect {
+public:
+    explicit CoutRedirect(std::streambuf* target) : saved_(std::cout.rdbuf(target)) {}
+    ~CoutRedirect() { std::cout.rdbuf(saved_); }
+
+    CoutRedirect(const CoutRedirect&) = delete;
+    CoutRedirect& operator=(const CoutRedirect&) = delete;
+
+private:
+    std::streambuf* saved_;
+};
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -44,10 +125,29 @@ int main(int argc, char* argv[]) {
     word_options.min_length = 6;
     word_options.max_length = 32;
 
-    std::string pdf_path;
+    std::vector<std::string> pdf_paths;
     bool info_only = false;
+    std::vector<std::string> info_specs;
+    bool info_format_given = false;
+    unlock_pdf::pdf::InfoFormat info_format = unlock_pdf::pdf::InfoFormat::Jsonl;
+    bool estimate_only = false;
     std::string wordlist_path;
-    unsigned int thread_count = 0;
+    std::string rules_path;
+    unlock_pdf::pdf::WordlistCombination combination;
+    std::string mask_text;
+    std::string markov_path;
+    std::string markov_training_path;
+    std::string pcfg_path;
+    std::string pcfg_training_path;
+    std::string hash_file_path;
+    std::string potfile_path;
+    bool use_potfile = true;
+    std::string coverage_path;
+    bool use_coverage = true;
+    bool show_only = false;
+    unlock_pdf::pdf::CrackOptions crack_options;
+    unlock_pdf::pdf::ProgressFormat progress_format = unlock_pdf::pdf::ProgressFormat::Text;
+    int progress_fd = -1;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -62,12 +162,62 @@ int main(int argc, char* argv[]) {
             print_usage(argv[0]);
             return 0;
         } else if (arg == "--info") {
-            pdf_path = require_value(arg);
+            info_specs.push_back(require_value(arg));
+            info_only = true;
+        } else if (arg == "--extract-hash") {
+            info_specs.push_back(require_value(arg));
             info_only = true;
+            info_format = unlock_pdf::pdf::InfoFormat::Hash;
+            info_format_given = true;
+        } else if (arg == "--hash-file") {
+            hash_file_path = require_value(arg);
+        } else if (arg == "--info-format") {
+            std::string format = require_value(arg);
+            if (!unlock_pdf::pdf::parse_info_format(format, info_format)) {
+                throw std::runtime_error("unknown info format: " + format);
+            }
+            info_format_given = true;
+        } else if (arg == "--verbose") {
+            crack_options.verbose = true;
         } else if (arg == "--pdf") {
-            pdf_path = require_value(arg);
+            pdf_paths.push_back(require_value(arg));
         } else if (arg == "--wordlist") {
             wordlist_path = require_value(arg);
+        } else if (arg == "--rules") {
+            rules_path = require_value(arg);
+        } else if (arg == "--combine" || arg == "--append-mask" || arg == "--prepend-mask" || arg == "--prince") {
+            if (combination.mode != unlock_pdf::pdf::WordlistCombination::Mode::None) {
+                throw std::runtime_error(
+                    "only one of --combine, --append-mask, --prepend-mask and --prince can be used");
+            }
+            if (arg == "--prince") {
+                combination.mode = unlock_pdf::pdf::WordlistCombination::Mode::Prince;
+            } else if (arg == "--combine") {
+                combination.mode = unlock_pdf::pdf::WordlistCombination::Mode::Combinator;
+                combination.right_path = require_value(arg);
+            } else {
+                combination.mode = arg == "--append-mask" ? unlock_pdf::pdf::WordlistCombination::Mode::AppendMask
+                                                          : unlock_pdf::pdf::WordlistCombination::Mode::PrependMask;
+                mask_text = require_value(arg);
+            }
+        } else if (arg == "--prince-elements") {
+            combination.chain_elements = static_cast<std::size_t>(std::stoul(require_value(arg)));
+        } else if (arg == "--prince-min-length") {
+            combination.min_length = static_cast<std::size_t>(std::stoul(require_value(arg)));
+        } else if (arg == "--prince-max-length") {
+            combination.max_length = static_cast<std::size_t>(std::stoul(require_value(arg)));
+        } else if (arg == "--estimate") {
+            estimate_only = true;
+        } else if (arg == "--potfile") {
+            potfile_path = require_value(arg);
+        } else if (arg == "--no-potfile") {
+            use_potfile = false;
+        } else if (arg == "--coverage-db") {
+            coverage_path = require_value(arg);
+        } else if (arg == "--no-coverage-db") {
+            use_coverage = false;
+        } else if (arg == "--show") {
+            show_only = true;
         } else if (arg == "--min-length") {
             word_options.min_length = static_cast<std::size_t>(std::stoul(require_value(arg)));
         } else if (arg == "--max-length") {
@@ -91,6 +241,16 @@ int main(int argc, char* argv[]) {
         } else if (arg == "--custom-chars") {
             word_options.custom_characters = require_value(arg);
             word_options.use_custom_characters = true;
+        } else if (arg == "--markov-stats") {
+            markov_path = require_value(arg);
+        } else if (arg == "--markov-threshold") {
+            word_options.markov_threshold = static_cast<std::size_t>(std::stoul(require_value(arg)));
+        } else if (arg == "--markov-train") {
+            markov_training_path = require_value(arg);
+        } else if (arg == "--pcfg-grammar") {
+            pcfg_path = require_value(arg);
+        } else if (arg == "--pcfg-train") {
+            pcfg_training_path = require_value(arg);
         } else if (arg == "--use-custom-only") {
             word_options.use_custom_characters = true;
             word_options.include_uppercase = false;
@@ -98,34 +258,336 @@ int main(int argc, char* argv[]) {
             word_options.include_digits = false;
             word_options.include_special = false;
         } else if (arg == "--threads") {
-            thread_count = static_cast<unsigned int>(std::stoul(require_value(arg)));
+            crack_options.thread_count = static_cast<unsigned int>(std::stoul(require_value(arg)));
+        } else if (arg == "--affinity") {
+            std::string policy = require_value(arg);
+            if (!unlock_pdf::util::parse_affinity_policy(policy, crack_options.affinity)) {
+                throw std::runtime_error("unknown affinity policy: " + policy);
+            }
+        } else if (arg == "--batch-size") {
+            crack_options.batch_size = static_cast<std::size_t>(std::stoull(require_value(arg)));
+        } else if (arg == "--autotune") {
+            crack_options.autotune = true;
+        } else if (arg == "--progress-interval") {
+            crack_options.progress_interval_ms = static_cast<unsigned int>(std::stoul(require_value(arg)));
+        } else if (arg == "--progress-format") {
+            std::string format = require_value(arg);
+            if (!unlock_pdf::pdf::parse_progress_format(format, progress_format)) {
+                throw std::runtime_error("unknown progress format: " + format);
+            }
+        } else if (arg == "--progress-fd") {
+            progress_fd = std::stoi(require_value(arg));
+            if (progress_fd < 1) {
+                throw std::runtime_error("invalid progress file descriptor: " + std::to_string(progress_fd));
+            }
+            progress_format = unlock_pdf::pdf::ProgressFormat::Jsonl;
+        } else if (arg == "--metrics-jsonl") {
+            crack_options.metrics.jsonl_path = require_value(arg);
+        } else if (arg == "--metrics-prom") {
+            crack_options.metrics.prometheus_path = require_value(arg);
+        } else if (arg == "--metrics-interval") {
+            crack_options.metrics.interval = std::chrono::milliseconds(std::stoul(require_value(arg)));
         } else {
             throw std::runtime_error("unknown option: " + arg);
         }
     }
 
+    if (crack_options.metrics.requested() && !unlock_pdf::pdf::kMetricsEnabled) {
+        std::cerr << "Warning: this build has metrics disabled (UNLOCK_PDF_ENABLE_METRICS=OFF); "
+                     "--metrics-jsonl/--metrics-prom are ignored"
+                  << std::endl;
+    }
+
+    std::unique_ptr<unlock_pdf::pdf::ProgressEventSink> events;
+    std::optional<CoutRedirect> human_output;
+    if (progress_format == unlock_pdf::pdf::ProgressFormat::Jsonl) {
+        events = std::make_unique<unlock_pdf::pdf::ProgressEventSink>(progress_fd > 0 ? progress_fd : 1);
+        if (!events->valid()) {
+            return 1;
+        }
+        crack_options.events = events.get();
+        // Events on stdout get it to themselves: the text meant for people
+        // moves to stderr, so stdout stays one JSON object per line.
+        if (progress_fd <= 1 && !info_only) {
+            human_output.emplace(std::cerr.rdbuf());
+        }
+    }
+
     try {
         if (info_only) {
-            if (pdf_path.empty()) {
-                std::cerr << "Error: no PDF path provided for --info" << std::endl;
+            std::vector<std::string> info_paths;
+            std::string error;
+            if (!unlock_pdf::pdf::expand_info_targets(info_specs, info_paths, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            bool single_file = info_specs.size() == 1 && info_paths.size() == 1 && info_paths[0] == info_specs[0];
+            if (single_file && (!info_format_given || info_format == unlock_pdf::pdf::InfoFormat::Text)) {
+                unlock_pdf::pdf::PDFEncryptInfo info;
+                if (!unlock_pdf::pdf::read_pdf_encrypt_info(info_paths[0], info, crack_options.verbose)) {
+                    return 1;
+                }
+                return 0;
+            }
+            if (info_paths.empty()) {
+                std::cerr << "Error: no PDF files found for --info" << std::endl;
+                return 1;
+            }
+            unlock_pdf::pdf::InfoBatchOptions batch_options;
+            batch_options.thread_count = crack_options.thread_count;
+            batch_options.format = info_format;
+            batch_options.verbose = crack_options.verbose;
+            return unlock_pdf::pdf::run_info_batch(info_paths, batch_options) == 0 ? 0 : 1;
+        }
+
+        if (combination.mode != unlock_pdf::pdf::WordlistCombination::Mode::None) {
+            if (wordlist_path.empty()) {
+                std::cerr << "Error: --combine, --append-mask, --prepend-mask and --prince need --wordlist"
+                          << std::endl;
+                return 1;
+            }
+            if (!rules_path.empty()) {
+                std::cerr << "Error: --rules cannot be combined with --combine, a mask or --prince" << std::endl;
+                return 1;
+            }
+            if (combination.mode == unlock_pdf::pdf::WordlistCombination::Mode::Prince &&
+                (combination.chain_elements == 0 ||
+                 combination.chain_elements > unlock_pdf::util::PrinceChains::kMaxElements)) {
+                std::cerr << "Error: --prince-elements takes 1 to " << unlock_pdf::util::PrinceChains::kMaxElements
+                          << std::endl;
+                return 1;
+            }
+            bool masked = combination.mode == unlock_pdf::pdf::WordlistCombination::Mode::AppendMask ||
+                          combination.mode == unlock_pdf::pdf::WordlistCombination::Mode::PrependMask;
+            std::string error;
+            if (masked && !unlock_pdf::util::Mask::parse(mask_text, combination.mask, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            crack_options.combination = combination;
+        }
+
+        unlock_pdf::util::MarkovStatistics markov;
+        if (!markov_training_path.empty()) {
+            if (markov_path.empty()) {
+                std::cerr << "Error: --markov-train needs --markov-stats for the output file" << std::endl;
+                return 1;
+            }
+            std::string error;
+            if (!markov.train(markov_training_path, error) || !markov.save(markov_path, error)) {
+                std::cerr << "Error: " << error << std::endl;
                 return 1;
             }
-            unlock_pdf::pdf::PDFEncryptInfo info;
-            if (!unlock_pdf::pdf::read_pdf_encrypt_info(pdf_path, info)) {
+            std::cout << "Trained Markov statistics on " << markov.words() << " words ("
+                      << markov.positions() << " positions) into '" << markov_path << "'" << std::endl;
+            return 0;
+        }
+        if (!markov_path.empty()) {
+            if (!wordlist_path.empty() || !pcfg_path.empty()) {
+                std::cerr << "Error: --markov-stats only orders the brute-force search; it cannot be combined with "
+                             "--wordlist or --pcfg-grammar"
+                          << std::endl;
+                return 1;
+            }
+            std::string error;
+            if (!markov.load(markov_path, error)) {
+                std::cerr << "Error: " << error << std::endl;
                 return 1;
             }
+            word_options.markov = &markov;
+        }
+
+        unlock_pdf::util::PcfgGrammar grammar;
+        if (!pcfg_training_path.empty()) {
+            if (pcfg_path.empty()) {
+                std::cerr << "Error: --pcfg-train needs --pcfg-grammar for the output file" << std::endl;
+                return 1;
+            }
+            std::string error;
+            if (!grammar.train(pcfg_training_path, error) || !grammar.save(pcfg_path, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            std::cout << "Trained PCFG grammar on " << grammar.passwords() << " passwords ("
+                      << grammar.structures().size() << " base structures) into '" << pcfg_path << "'"
+                      << std::endl;
             return 0;
         }
+        bool pcfg = !pcfg_path.empty();
+        if (pcfg) {
+            if (!wordlist_path.empty()) {
+                std::cerr << "Error: --pcfg-grammar cannot be combined with --wordlist" << std::endl;
+                return 1;
+            }
+            if (pdf_paths.empty() && hash_file_path.empty()) {
+                std::cerr << "Error: no PDF path provided" << std::endl;
+                return 1;
+            }
+            std::string error;
+            if (!grammar.load(pcfg_path, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+        }
+
+        unlock_pdf::util::RuleSet rules;
+        if (!rules_path.empty()) {
+            if (wordlist_path.empty()) {
+                std::cerr << "Error: --rules needs --wordlist" << std::endl;
+                return 1;
+            }
+            std::string error;
+            if (!rules.load(rules_path, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            crack_options.rules = &rules;
+        }
+
+        unlock_pdf::pdf::Potfile potfile;
+        if (use_potfile && !estimate_only) {
+            if (potfile_path.empty()) {
+                potfile_path = unlock_pdf::pdf::default_potfile_path();
+            }
+            if (!potfile_path.empty()) {
+                std::string error;
+                if (!potfile.open(potfile_path, error)) {
+                    std::cerr << "Error: " << error << std::endl;
+                    return 1;
+                }
+                crack_options.potfile = &potfile;
+            }
+        }
+        unlock_pdf::pdf::SessionCoverage coverage;
+        if (use_coverage && !estimate_only && !show_only) {
+            if (coverage_path.empty()) {
+                coverage_path = unlock_pdf::pdf::default_session_coverage_path();
+            }
+            if (!coverage_path.empty()) {
+                std::string error;
+                if (!coverage.open(coverage_path, error)) {
+                    std::cerr << "Error: " << error << std::endl;
+                    return 1;
+                }
+                crack_options.coverage = &coverage;
+            }
+        }
+        if (show_only && crack_options.potfile == nullptr) {
+            std::cerr << "Error: --show needs a potfile" << std::endl;
+            return 1;
+        }
+
+        if (!hash_file_path.empty() || pdf_paths.size() > 1 || show_only || pcfg) {
+            std::vector<unlock_pdf::pdf::CrackTarget> targets;
+            if (!hash_file_path.empty()) {
+                std::string error;
+                if (!unlock_pdf::pdf::load_pdf_hash_file(hash_file_path, targets, error)) {
+                    std::cerr << "Error: " << error << std::endl;
+                    return 1;
+                }
+                if (targets.empty()) {
+                    std::cerr << "Error: no hash records in '" << hash_file_path << "'" << std::endl;
+                    return 1;
+                }
+            }
+            for (const auto& path : pdf_paths) {
+                unlock_pdf::pdf::CrackTarget target;
+                target.label = path;
+                std::ostringstream discard;
+                std::string error;
+                bool loaded = show_only
+                                  ? unlock_pdf::pdf::read_pdf_encrypt_info(path, target.info, discard, error)
+                                  : unlock_pdf::pdf::load_crack_target(path, target, crack_options);
+                if (!loaded) {
+                    if (!error.empty()) {
+                        std::cerr << "Error: " << path << ": " << error << std::endl;
+                    }
+                    return 1;
+                }
+                targets.push_back(std::move(target));
+            }
+            if (targets.empty()) {
+                std::cerr << "Error: no PDF path or hash file provided for --show" << std::endl;
+                return 1;
+            }
+
+            // Answers straight from the potfile index; nothing is verified.
+            if (show_only) {
+                bool all_found = true;
+                for (const auto& target : targets) {
+                    const unlock_pdf::pdf::PotfileEntry* entry = potfile.find(target.info);
+                    if (entry != nullptr) {
+                        std::cout << target.label << ':' << entry->password << '\n';
+                    }
+                    all_found &= entry != nullptr;
+                }
+                std::cout.flush();
+                return all_found ? 0 : 2;
+            }
+
+            if (estimate_only) {
+                bool all_ok = true;
+                for (const auto& target : targets) {
+                    std::cout << "\nTarget: " << target.label << " (revision " << target.info.revision << ")"
+                              << std::endl;
+                    unlock_pdf::pdf::CrackEstimate estimate;
+                    if (pcfg) {
+                        all_ok &= unlock_pdf::pdf::estimate_pdf_pcfg(grammar, target, estimate, crack_options);
+                    } else if (wordlist_path.empty()) {
+                        all_ok &= unlock_pdf::pdf::estimate_pdf_bruteforce(word_options, target, estimate,
+                                                                           crack_options);
+                    } else {
+                        all_ok &= unlock_pdf::pdf::estimate_pdf_from_file(wordlist_path, target, estimate,
+                                                                          crack_options);
+                    }
+                }
+                return all_ok ? 0 : 1;
+            }
+
+            std::vector<unlock_pdf::pdf::CrackResult> results;
+            bool ran = false;
+            if (pcfg) {
+                std::cout << "Generating guesses from PCFG grammar '" << pcfg_path << "'" << std::endl;
+                ran = unlock_pdf::pdf::crack_targets_pcfg(grammar, targets, results, crack_options);
+            } else if (wordlist_path.empty()) {
+                ran = unlock_pdf::pdf::crack_targets_bruteforce(word_options, targets, results, crack_options);
+            } else {
+                std::cout << "Streaming password list from '" << wordlist_path << "'" << std::endl;
+                ran = unlock_pdf::pdf::crack_targets_from_file(wordlist_path, targets, results, crack_options);
+            }
+            if (!ran) {
+                return 1;
+            }
+            bool all_found = std::all_of(results.begin(), results.end(), [](const auto& result) {
+                return result.success;
+            });
+            return all_found ? 0 : 2;
+        }
+
+        if (estimate_only) {
+            if (pdf_paths.empty()) {
+                std::cerr << "Error: no PDF path provided for --estimate" << std::endl;
+                return 1;
+            }
+            const std::string& pdf_path = pdf_paths.front();
+            unlock_pdf::pdf::CrackEstimate estimate;
+            bool estimated =
+                wordlist_path.empty()
+                    ? unlock_pdf::pdf::estimate_pdf_bruteforce(word_options, pdf_path, estimate, crack_options)
+                    : unlock_pdf::pdf::estimate_pdf_from_file(wordlist_path, pdf_path, estimate, crack_options);
+            return estimated ? 0 : 1;
+        }
 
-        if (!pdf_path.empty()) {
+        if (!pdf_paths.empty()) {
+            const std::string& pdf_path = pdf_paths.front();
             unlock_pdf::pdf::CrackResult result;
             if (wordlist_path.empty()) {
-                if (!unlock_pdf::pdf::crack_pdf_bruteforce(word_options, pdf_path, result, thread_count)) {
+                if (!unlock_pdf::pdf::crack_pdf_bruteforce(word_options, pdf_path, result, crack_options)) {
                     return 1;
                 }
             } else {
                 std::cout << "Streaming password list from '" << wordlist_path << "'" << std::endl;
-                if (!unlock_pdf::pdf::crack_pdf_from_file(wordlist_path, pdf_path, result, thread_count)) {
+                if (!unlock_pdf::pdf::crack_pdf_from_file(wordlist_path, pdf_path, result, crack_options)) {
                     return 1;
                 }
             }
@@ -136,6 +598,9 @@ int main(int argc, char* argv[]) {
         }
     } catch (const std::exception& ex) {
         std::cerr << "Error: " << ex.what() << std::endl;
+        if (events) {
+            events->error(ex.what());
+        }
         return 1;
     }
 
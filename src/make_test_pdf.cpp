@@ -0,0 +1,167 @@
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "pdf/encryption/encryption_handler_registry.h"
+#include "pdf/test_pdf_generator.h"
+
+namespace {
+
+void print_help(const char* program) {
+    std::cout << "Usage: " << program << " [options] --output <file.pdf>\n"
+              << "       " << program << " [options] --all <directory>\n\n"
+              << "Writes minimal PDFs encrypted with the Standard security handler.\n\n"
+              << "Options:\n"
+              << "  --revision <n>           Security handler revision 2-6 (default: 6)\n"
+              << "  --cipher <rc4|aes>       Cipher for revision 4 (default: aes)\n"
+              << "  --key-length <bits>      RC4 key length for R3/R4 (default: revision default)\n"
+              << "  --user <password>        User password (default: empty)\n"
+              << "  --owner <password>       Owner password (default: same as the user password)\n"
+              << "  --no-encrypt-metadata    Write /EncryptMetadata false (R4 and later)\n"
+              << "  --permissions <n>        /P value (default: -4)\n"
+              << "  --seed <n>               Seed for IDs, salts and IVs to get reproducible files\n"
+              << "  --output <path>          Output file\n"
+              << "  --all <directory>        Write one file per supported revision and cipher, creating\n"
+              << "                           <directory> if needed\n"
+              << "  --help                   Show this help message\n";
+}
+
+// The password handlers must accept the passwords the file was built with;
+// anything else means the generator and the handlers disagree.
+bool verify_passwords(const unlock_pdf::pdf::TestPdfOptions& options, const unlock_pdf::pdf::PDFEncryptInfo& info) {
+    auto handlers = unlock_pdf::pdf::create_default_encryption_handlers();
+    auto password_handlers = unlock_pdf::pdf::collect_password_handlers(info, handlers);
+
+    auto accepted = [&](const std::string& password, std::string& variant) {
+        for (const auto* handler : password_handlers) {
+            if (handler->check_password(password, info, variant)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::string variant;
+    if (!accepted(options.user_password, variant)) {
+        std::cerr << "Error: handlers reject the user password of the generated file" << std::endl;
+        return false;
+    }
+    std::cout << "  user password accepted [" << variant << "]\n";
+    if (!options.owner_password.empty() && options.owner_password != options.user_password) {
+        if (!accepted(options.owner_password, variant)) {
+            std::cerr << "Error: handlers reject the owner password of the generated file" << std::endl;
+            return false;
+        }
+        std::cout << "  owner password accepted [" << variant << "]\n";
+    }
+    return true;
+}
+
+bool generate(const unlock_pdf::pdf::TestPdfOptions& options, const std::string& path) {
+    unlock_pdf::pdf::PDFEncryptInfo info;
+    if (!unlock_pdf::pdf::write_test_pdf(options, path, info)) {
+        return false;
+    }
+    std::cout << "Wrote " << path << " (" << unlock_pdf::pdf::describe_test_pdf(options) << ")\n";
+    return verify_passwords(options, info);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    unlock_pdf::pdf::TestPdfOptions options;
+    std::string output_path;
+    std::string all_directory;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg(argv[i]);
+            auto require_value = [&](std::string_view option) -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Missing value for option: " + std::string(option));
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--help" || arg == "-h") {
+                print_help(argv[0]);
+                return 0;
+            } else if (arg == "--revision") {
+                options.revision = std::stoi(require_value(arg));
+            } else if (arg == "--cipher") {
+                std::string cipher = require_value(arg);
+                if (cipher == "rc4") {
+                    options.cipher = unlock_pdf::pdf::TestPdfCipher::Rc4;
+                } else if (cipher == "aes") {
+                    options.cipher = unlock_pdf::pdf::TestPdfCipher::Aes;
+                } else {
+                    throw std::runtime_error("Unknown cipher: " + cipher);
+                }
+            } else if (arg == "--key-length") {
+                options.key_length_bits = std::stoi(require_value(arg));
+            } else if (arg == "--user") {
+                options.user_password = require_value(arg);
+            } else if (arg == "--owner") {
+                options.owner_password = require_value(arg);
+            } else if (arg == "--no-encrypt-metadata") {
+                options.encrypt_metadata = false;
+            } else if (arg == "--permissions") {
+                options.permissions = static_cast<std::int32_t>(std::stol(require_value(arg)));
+            } else if (arg == "--seed") {
+                options.seed = static_cast<std::uint32_t>(std::stoul(require_value(arg)));
+            } else if (arg == "--output" || arg == "-o") {
+                output_path = require_value(arg);
+            } else if (arg == "--all") {
+                all_directory = require_value(arg);
+            } else {
+                throw std::runtime_error("Unknown option: " + std::string(arg));
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (all_directory.empty() && output_path.empty()) {
+        print_help(argv[0]);
+        return 1;
+    }
+
+    if (!all_directory.empty()) {
+        struct Variant {
+            int revision;
+            unlock_pdf::pdf::TestPdfCipher cipher;
+            const char* file_name;
+        };
+        const std::vector<Variant> variants = {
+            {2, unlock_pdf::pdf::TestPdfCipher::Rc4, "R2_RC4_40.pdf"},
+            {3, unlock_pdf::pdf::TestPdfCipher::Rc4, "R3_RC4_128.pdf"},
+            {4, unlock_pdf::pdf::TestPdfCipher::Rc4, "R4_RC4_128.pdf"},
+            {4, unlock_pdf::pdf::TestPdfCipher::Aes, "R4_AESV2_128.pdf"},
+            {5, unlock_pdf::pdf::TestPdfCipher::Aes, "R5_AESV3_256.pdf"},
+            {6, unlock_pdf::pdf::TestPdfCipher::Aes, "R6_AESV3_256.pdf"},
+        };
+        std::error_code ec;
+        std::filesystem::create_directories(all_directory, ec);
+        if (ec) {
+            std::cerr << "Error: cannot create " << all_directory << ": " << ec.message() << std::endl;
+            return 1;
+        }
+        for (const auto& variant : variants) {
+            unlock_pdf::pdf::TestPdfOptions variant_options = options;
+            variant_options.revision = variant.revision;
+            variant_options.cipher = variant.cipher;
+            variant_options.key_length_bits = 0;
+            if (!generate(variant_options, all_directory + "/" + variant.file_name)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    return generate(options, output_path) ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#include "pdf/autotune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "pdf/handler_benchmark.h"
+#include "util/system_info.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+constexpr std::chrono::milliseconds kCalibrationWindow(250);
+constexpr std::size_t kCalibrationLength = 8;
+constexpr double kMinimumGain = 1.05;
+// A batch should keep a worker busy for about this long between fetches.
+constexpr double kBatchTargetSeconds = 0.02;
+constexpr std::size_t kMaxBatchSize = 4096;
+constexpr const char* kCacheFileName = "autotune.tsv";
+
+const std::string kCalibrationCharset = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+// Only the scalar kernels exist today; the variant is recorded so cached
+// entries stay meaningful once alternatives are added.
+constexpr const char* kScalarVariant = "scalar";
+
+struct CacheEntry {
+    std::string cpu_model;
+    int revision = 0;
+    unsigned int max_threads = 0;
+    AutotuneResult result;
+};
+
+std::string sanitize_field(std::string value) {
+    std::replace(value.begin(), value.end(), '\t', ' ');
+    std::replace(value.begin(), value.end(), '\n', ' ');
+    return value;
+}
+
+std::filesystem::path cache_file_path() {
+    std::string directory = unlock_pdf::util::user_cache_directory();
+    if (directory.empty()) {
+        return std::filesystem::path();
+    }
+    return std::filesystem::path(directory) / kCacheFileName;
+}
+
+std::vector<CacheEntry> load_cache(const std::filesystem::path& path) {
+    std::vector<CacheEntry> entries;
+    std::ifstream input(path);
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::istringstream iss(line);
+        std::string field;
+        while (std::getline(iss, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 7) {
+            continue;
+        }
+        try {
+            CacheEntry entry;
+            entry.cpu_model = fields[0];
+            entry.revision = std::stoi(fields[1]);
+            entry.max_threads = static_cast<unsigned int>(std::stoul(fields[2]));
+            entry.result.thread_count = static_cast<unsigned int>(std::stoul(fields[3]));
+            entry.result.batch_size = static_cast<std::size_t>(std::stoull(fields[4]));
+            entry.result.kernel_variant = fields[5];
+            entry.result.candidates_per_second = std::stod(fields[6]);
+            if (entry.result.thread_count == 0 || entry.result.batch_size == 0) {
+                continue;
+            }
+            entries.push_back(std::move(entry));
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+    return entries;
+}
+
+void save_cache(const std::filesystem::path& path, const std::vector<CacheEntry>& entries) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // Write a sibling file named after this process and rename it so
+    // concurrent runs never observe a partially written cache, nor write into
+    // each other's temporary file.
+    std::filesystem::path temporary = path;
+    temporary += "." + std::to_string(unlock_pdf::util::current_process_id()) + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::trunc);
+        if (!output) {
+            return;
+        }
+        output << "# cpu_model\trevision\tmax_threads\tthreads\tbatch_size\tvariant\tcandidates_per_second\n";
+        for (const auto& entry : entries) {
+            output << sanitize_field(entry.cpu_model) << '\t' << entry.revision << '\t' << entry.max_threads << '\t'
+                   << entry.result.thread_count << '\t' << entry.result.batch_size << '\t'
+                   << entry.result.kernel_variant << '\t' << std::fixed << std::setprecision(2)
+                   << entry.result.candidates_per_second << '\n';
+        }
+        if (!output) {
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+    }
+}
+
+std::vector<unsigned int> candidate_thread_counts(unsigned int max_threads) {
+    std::vector<unsigned int> counts;
+    for (unsigned int threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+std::size_t batch_size_for_rate(double per_thread_rate) {
+    double target = per_thread_rate * kBatchTargetSeconds;
+    std::size_t batch = 1;
+    while (batch * 2 <= kMaxBatchSize && static_cast<double>(batch * 2) <= target) {
+        batch *= 2;
+    }
+    return batch;
+}
+
+AutotuneResult calibrate(const PDFEncryptInfo& info,
+                         const std::vector<const EncryptionHandler*>& handlers,
+                         unsigned int max_threads) {
+    AutotuneResult best;
+    best.kernel_variant = kScalarVariant;
+
+    std::cout << "Autotune: calibrating R" << info.revision << " handlers" << std::endl;
+    for (unsigned int threads : candidate_thread_counts(max_threads)) {
+        HandlerBenchmarkResult sample = run_handler_benchmark_timed(
+            kCalibrationLength, kCalibrationCharset, info, handlers, threads, kCalibrationWindow);
+        std::cout << "  " << std::setw(4) << threads << " thread(s): " << std::fixed << std::setprecision(1)
+                  << sample.attempts_per_second << " candidates/s" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+
+        if (sample.attempts_per_second > best.candidates_per_second * kMinimumGain) {
+            best.thread_count = threads;
+            best.candidates_per_second = sample.attempts_per_second;
+        } else if (threads > 1) {
+            // Throughput has flattened out (no more free cores, or SMT siblings
+            // not paying off); larger pools would only add contention.
+            break;
+        }
+    }
+
+    best.batch_size = batch_size_for_rate(best.candidates_per_second / best.thread_count);
+    return best;
+}
+
+}  // namespace
+
+std::size_t default_batch_size(const PDFEncryptInfo& info) {
+    return info.revision >= 5 ? 4 : 64;
+}
+
+AutotuneResult autotune_cracking(const PDFEncryptInfo& info,
+                                 const std::vector<const EncryptionHandler*>& handlers,
+                                 unsigned int max_threads) {
+    max_threads = std::max(max_threads, 1u);
+    std::string cpu_model = sanitize_field(unlock_pdf::util::cpu_model_name());
+    std::filesystem::path path = cache_file_path();
+
+    std::vector<CacheEntry> entries;
+    if (!path.empty()) {
+        entries = load_cache(path);
+        for (const auto& entry : entries) {
+            if (entry.cpu_model == cpu_model && entry.revision == info.revision &&
+                entry.max_threads == max_threads && entry.result.kernel_variant == kScalarVariant) {
+                AutotuneResult cached = entry.result;
+                cached.thread_count = std::min(cached.thread_count, max_threads);
+                cached.from_cache = true;
+                return cached;
+            }
+        }
+    }
+
+    AutotuneResult result = calibrate(info, handlers, max_threads);
+    if (path.empty()) {
+        return result;
+    }
+
+    entries.erase(std::remove_if(entries.begin(),
+                                 entries.end(),
+                                 [&](const CacheEntry& entry) {
+                                     return entry.cpu_model == cpu_model && entry.revision == info.revision &&
+                                            entry.max_threads == max_threads;
+                                 }),
+                  entries.end());
+    CacheEntry entry;
+    entry.cpu_model = cpu_model;
+    entry.revision = info.revision;
+    entry.max_threads = max_threads;
+    entry.result = result;
+    entries.push_back(entry);
+    save_cache(path, entries);
+    return result;
+}
+
+}  // namespace unlock_pdf::pdf
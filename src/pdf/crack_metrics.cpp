@@ -0,0 +1,236 @@
+#include "pdf/crack_metrics.h"
+
+#if UNLOCK_PDF_METRICS_ENABLED
+
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+#include "util/json.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+const char* const kPhaseNames[kMetricPhaseCount] = {"generation", "verification", "queue_wait"};
+
+// Prometheus label values escape backslash, double quote and newline.
+std::string label_escape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char ch : value) {
+        if (ch == '\\' || ch == '"') {
+            escaped.push_back('\\');
+            escaped.push_back(ch);
+        } else if (ch == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped.push_back(ch);
+        }
+    }
+    return escaped;
+}
+
+// Totals across all workers at one point in time.
+struct Snapshot {
+    double timestamp = 0.0;
+    double elapsed_seconds = 0.0;
+    bool final = false;
+    std::uint64_t generated = 0;
+    std::vector<std::uint64_t> verified;
+    std::array<double, kMetricPhaseCount> phase_seconds{};
+    std::uint64_t batch_filled = 0;
+    std::uint64_t batch_capacity = 0;
+    std::vector<std::uint64_t> thread_tried;
+    std::vector<double> thread_rates;
+};
+
+void write_jsonl(std::ostream& out, const Snapshot& snapshot, const std::vector<std::string>& handler_names) {
+    out << std::fixed << std::setprecision(6) << "{\"timestamp\": " << snapshot.timestamp
+        << ", \"elapsed_seconds\": " << snapshot.elapsed_seconds << ", \"final\": "
+        << (snapshot.final ? "true" : "false") << ", \"candidates_generated\": " << snapshot.generated
+        << ", \"candidates_verified\": {";
+    for (std::size_t i = 0; i < handler_names.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << '"' << unlock_pdf::util::json_escape(handler_names[i])
+            << "\": " << snapshot.verified[i];
+    }
+    out << "}, \"phase_seconds\": {";
+    for (std::size_t i = 0; i < kMetricPhaseCount; ++i) {
+        out << (i == 0 ? "" : ", ") << '"' << kPhaseNames[i] << "\": " << snapshot.phase_seconds[i];
+    }
+    out << "}, \"batch_fill_ratio\": ";
+    if (snapshot.batch_capacity > 0) {
+        out << static_cast<double>(snapshot.batch_filled) / static_cast<double>(snapshot.batch_capacity);
+    } else {
+        out << "null";
+    }
+    out << ", \"threads\": [";
+    for (std::size_t i = 0; i < snapshot.thread_tried.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << "{\"candidates\": " << snapshot.thread_tried[i]
+            << ", \"per_second\": " << snapshot.thread_rates[i] << '}';
+    }
+    out << "]}\n";
+    out.unsetf(std::ios::floatfield);
+    out.flush();
+}
+
+void write_prometheus(std::ostream& out, const Snapshot& snapshot, const std::vector<std::string>& handler_names) {
+    auto header = [&](const char* name, const char* type, const char* help) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+    };
+
+    out << std::fixed << std::setprecision(6);
+    header("unlock_pdf_elapsed_seconds", "gauge", "Seconds since the cracking run started.");
+    out << "unlock_pdf_elapsed_seconds " << snapshot.elapsed_seconds << '\n';
+    header("unlock_pdf_running", "gauge", "1 while the cracking run is in progress, 0 once it has finished.");
+    out << "unlock_pdf_running " << (snapshot.final ? 0 : 1) << '\n';
+
+    header("unlock_pdf_candidates_generated_total", "counter", "Candidates produced by the candidate source.");
+    out << "unlock_pdf_candidates_generated_total " << snapshot.generated << '\n';
+
+    header("unlock_pdf_candidates_verified_total", "counter", "Password checks performed, by handler.");
+    for (std::size_t i = 0; i < handler_names.size(); ++i) {
+        out << "unlock_pdf_candidates_verified_total{handler=\"" << label_escape(handler_names[i]) << "\"} "
+            << snapshot.verified[i] << '\n';
+    }
+
+    header("unlock_pdf_phase_seconds_total",
+           "counter",
+           "Worker time by phase, extrapolated from sampled work units.");
+    for (std::size_t i = 0; i < kMetricPhaseCount; ++i) {
+        out << "unlock_pdf_phase_seconds_total{phase=\"" << kPhaseNames[i] << "\"} " << snapshot.phase_seconds[i]
+            << '\n';
+    }
+
+    if (snapshot.batch_capacity > 0) {
+        header("unlock_pdf_batch_fill_ratio", "gauge", "Filled fraction of the candidate batches handed to workers.");
+        out << "unlock_pdf_batch_fill_ratio "
+            << static_cast<double>(snapshot.batch_filled) / static_cast<double>(snapshot.batch_capacity) << '\n';
+    }
+
+    header("unlock_pdf_thread_candidates_total", "counter", "Candidates verified, by worker thread.");
+    for (std::size_t i = 0; i < snapshot.thread_tried.size(); ++i) {
+        out << "unlock_pdf_thread_candidates_total{thread=\"" << i << "\"} " << snapshot.thread_tried[i] << '\n';
+    }
+    header("unlock_pdf_thread_candidates_per_second", "gauge", "Recent verification rate, by worker thread.");
+    for (std::size_t i = 0; i < snapshot.thread_rates.size(); ++i) {
+        out << "unlock_pdf_thread_candidates_per_second{thread=\"" << i << "\"} " << snapshot.thread_rates[i]
+            << '\n';
+    }
+}
+
+// The textfile collector may read at any moment, so the file is replaced
+// atomically rather than rewritten in place.
+void replace_prometheus_file(const std::string& path,
+                             const Snapshot& snapshot,
+                             const std::vector<std::string>& handler_names) {
+    std::filesystem::path target(path);
+    std::filesystem::path temporary = target;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        write_prometheus(out, snapshot, handler_names);
+        if (!out) {
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, target, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+    }
+}
+
+}  // namespace
+
+CrackMetrics::CrackMetrics(std::size_t thread_count,
+                           std::vector<std::string> handler_names,
+                           const MetricsOptions& options)
+    : threads_(std::max<std::size_t>(thread_count, 1)),
+      handler_names_(std::move(handler_names)),
+      options_(options),
+      active_(options.requested()),
+      start_time_(std::chrono::steady_clock::now()),
+      previous_snapshot_(start_time_),
+      previous_tried_(threads_.size(), 0) {
+    if (handler_names_.size() > kMaxMetricHandlers) {
+        handler_names_.resize(kMaxMetricHandlers);
+        handler_names_.back() = "other";
+    }
+    if (options_.interval.count() <= 0) {
+        options_.interval = std::chrono::milliseconds(5000);
+    }
+    if (!options_.jsonl_path.empty()) {
+        jsonl_.open(options_.jsonl_path, std::ios::app);
+        if (!jsonl_) {
+            std::cerr << "Warning: unable to open metrics file " << options_.jsonl_path << std::endl;
+        }
+    }
+}
+
+void CrackMetrics::on_report(std::chrono::steady_clock::time_point now,
+                             const std::vector<std::uint64_t>& tried,
+                             bool final) {
+    if (!active_) {
+        return;
+    }
+    if (!final && now - previous_snapshot_ < options_.interval) {
+        return;
+    }
+    write_snapshot(now, tried, final);
+}
+
+void CrackMetrics::write_snapshot(std::chrono::steady_clock::time_point now,
+                                  const std::vector<std::uint64_t>& tried,
+                                  bool final) {
+    Snapshot snapshot;
+    snapshot.final = final;
+    snapshot.timestamp = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    snapshot.elapsed_seconds = std::chrono::duration<double>(now - start_time_).count();
+    snapshot.verified.assign(handler_names_.size(), 0);
+
+    for (const auto& thread : threads_) {
+        snapshot.generated += thread.generated.load();
+        snapshot.batch_filled += thread.batch_filled.load();
+        snapshot.batch_capacity += thread.batch_capacity.load();
+        for (std::size_t i = 0; i < snapshot.verified.size(); ++i) {
+            snapshot.verified[i] += thread.verified[i].load();
+        }
+        std::uint64_t sampled = thread.sampled_units.load();
+        if (sampled > 0) {
+            double scale = static_cast<double>(thread.units.load()) / static_cast<double>(sampled);
+            for (std::size_t phase = 0; phase < kMetricPhaseCount; ++phase) {
+                snapshot.phase_seconds[phase] +=
+                    static_cast<double>(thread.sampled_nanoseconds[phase].load()) * scale / 1e9;
+            }
+        }
+    }
+
+    double interval_seconds = std::chrono::duration<double>(now - previous_snapshot_).count();
+    snapshot.thread_tried.assign(threads_.size(), 0);
+    snapshot.thread_rates.assign(threads_.size(), 0.0);
+    for (std::size_t i = 0; i < threads_.size() && i < tried.size(); ++i) {
+        snapshot.thread_tried[i] = tried[i];
+        if (interval_seconds > 0.0) {
+            snapshot.thread_rates[i] = static_cast<double>(tried[i] - previous_tried_[i]) / interval_seconds;
+        }
+        previous_tried_[i] = tried[i];
+    }
+    previous_snapshot_ = now;
+
+    if (jsonl_) {
+        write_jsonl(jsonl_, snapshot, handler_names_);
+    }
+    if (!options_.prometheus_path.empty()) {
+        replace_prometheus_file(options_.prometheus_path, snapshot, handler_names_);
+    }
+}
+
+}  // namespace unlock_pdf::pdf
+
+#endif  // UNLOCK_PDF_METRICS_ENABLED
@@ -33,4 +33,20 @@ std::vector<EncryptionHandlerPtr> create_default_encryption_handlers() {
     return handlers;
 }
 
+std::vector<const EncryptionHandler*> collect_password_handlers(const PDFEncryptInfo& info,
+                                                                const std::vector<EncryptionHandlerPtr>& handlers) {
+    std::vector<const EncryptionHandler*> password_handlers;
+    password_handlers.reserve(handlers.size());
+    for (const auto& handler : handlers) {
+        if (!handler) {
+            continue;
+        }
+        if (!handler->can_handle(info) || !handler->requires_password()) {
+            continue;
+        }
+        password_handlers.push_back(handler.get());
+    }
+    return password_handlers;
+}
+
 }  // namespace unlock_pdf::pdf
@@ -7,8 +7,10 @@
 #include <string>
 #include <vector>
 
+#include "crypto/aes.h"
 #include "crypto/md5.h"
 #include "crypto/rc4.h"
+#include "crypto/sha2.h"
 
 namespace unlock_pdf::pdf::standard_security {
 namespace {
@@ -26,11 +28,67 @@ std::vector<unsigned char> md5_hash_truncated(const std::vector<unsigned char>&
     return unlock_pdf::crypto::md5_bytes(truncated);
 }
 
+// Algorithm 7 of ISO 32000-1: decrypts /O with the key derived from an owner
+// password candidate, yielding the user password it protects.
+bool recover_user_password(const std::string& owner_password,
+                           const PDFEncryptInfo& info,
+                           int revision,
+                           int key_length_bits,
+                           std::string& user_password) {
+    if (info.o_string.empty()) {
+        return false;
+    }
+    std::vector<unsigned char> padded = pad_password(owner_password);
+    std::vector<unsigned char> digest = md5_hash(padded);
+    std::size_t key_length_bytes = static_cast<std::size_t>(key_length_bits / 8);
+    if (revision >= 3) {
+        for (int i = 0; i < 50; ++i) {
+            digest = md5_hash(digest);
+        }
+    }
+    if (digest.size() < key_length_bytes) {
+        return false;
+    }
+    digest.resize(key_length_bytes);
+
+    std::vector<unsigned char> data(info.o_string.begin(), info.o_string.end());
+    unlock_pdf::crypto::RC4 rc4(digest);
+    rc4.crypt(data.data(), data.data(), data.size());
+
+    if (revision >= 3) {
+        for (int i = 1; i <= 19; ++i) {
+            std::vector<unsigned char> iteration_key = digest;
+            for (unsigned char& byte : iteration_key) {
+                byte ^= static_cast<unsigned char>(i);
+            }
+            rc4.set_key(iteration_key);
+            rc4.crypt(data.data(), data.data(), data.size());
+        }
+    }
+
+    user_password = unpad_password(data);
+    if (user_password.empty() && !data.empty()) {
+        user_password.assign(reinterpret_cast<const char*>(data.data()),
+                             reinterpret_cast<const char*>(data.data() + data.size()));
+    }
+    return true;
+}
+
 }  // namespace
 
+std::size_t max_password_length(int revision) {
+    if (revision >= 2 && revision <= 4) {
+        return kLegacyPasswordLimit;
+    }
+    if (revision == 5 || revision == 6) {
+        return kAes256PasswordLimit;
+    }
+    return 0;
+}
+
 std::vector<unsigned char> pad_password(const std::string& password) {
     std::vector<unsigned char> padded(32, 0);
-    std::size_t length = std::min<std::size_t>(password.size(), 32);
+    std::size_t length = std::min<std::size_t>(password.size(), kLegacyPasswordLimit);
     std::copy(password.begin(), password.begin() + length, padded.begin());
     if (length < 32) {
         std::copy(kPasswordPadding.begin(), kPasswordPadding.begin() + (32 - length), padded.begin() + length);
@@ -153,43 +211,173 @@ bool check_owner_password(const std::string& password,
                           const PDFEncryptInfo& info,
                           int revision,
                           int key_length_bits) {
-    if (info.o_string.empty()) {
-        return false;
+    std::string user_password;
+    return recover_user_password(password, info, revision, key_length_bits, user_password) &&
+           check_user_password(user_password, info, revision, key_length_bits);
+}
+
+std::vector<unsigned char> compute_hash_v5(const std::string& password,
+                                           const unsigned char* salt,
+                                           std::size_t salt_size,
+                                           const unsigned char* user_data,
+                                           std::size_t user_data_size,
+                                           int revision) {
+    using unlock_pdf::crypto::aes128_cbc_encrypt;
+    using unlock_pdf::crypto::sha256_bytes;
+    using unlock_pdf::crypto::sha2_hash;
+
+    std::vector<unsigned char> input;
+    input.reserve(password.size() + salt_size + user_data_size);
+    input.insert(input.end(), password.begin(), password.end());
+    if (salt_size > 0 && salt != nullptr) {
+        input.insert(input.end(), salt, salt + salt_size);
     }
-    std::vector<unsigned char> padded = pad_password(password);
-    std::vector<unsigned char> digest = md5_hash(padded);
-    std::size_t key_length_bytes = static_cast<std::size_t>(key_length_bits / 8);
-    if (revision >= 3) {
-        for (int i = 0; i < 50; ++i) {
-            digest = md5_hash(digest);
+    if (user_data_size > 0 && user_data != nullptr) {
+        input.insert(input.end(), user_data, user_data + user_data_size);
+    }
+
+    std::vector<unsigned char> current = sha256_bytes(input);
+    if (revision < 6) {
+        return current;
+    }
+
+    std::vector<unsigned char> k1;
+    std::vector<unsigned char> repeated;
+    std::vector<unsigned char> encrypted;
+    std::vector<unsigned char> key(16);
+    std::vector<unsigned char> iv(16);
+
+    int round = 0;
+    while (true) {
+        ++round;
+        std::size_t combined_length = password.size() + current.size() + user_data_size;
+        k1.resize(combined_length);
+
+        auto k1_it = k1.begin();
+        k1_it = std::copy(password.begin(), password.end(), k1_it);
+        k1_it = std::copy(current.begin(), current.end(), k1_it);
+        if (user_data_size > 0 && user_data != nullptr) {
+            k1_it = std::copy(user_data, user_data + user_data_size, k1_it);
+        }
+
+        repeated.resize(combined_length * 64);
+        auto repeat_it = repeated.begin();
+        for (int i = 0; i < 64; ++i) {
+            repeat_it = std::copy(k1.begin(), k1.end(), repeat_it);
+        }
+
+        if (current.size() < 32) {
+            return {};
+        }
+
+        std::copy(current.begin(), current.begin() + 16, key.begin());
+        std::copy(current.begin() + 16, current.begin() + 32, iv.begin());
+
+        encrypted.resize(repeated.size());
+        if (!aes128_cbc_encrypt(key, iv, repeated, encrypted)) {
+            return {};
+        }
+
+        int sum = 0;
+        for (std::size_t i = 0; i < 16 && i < encrypted.size(); ++i) {
+            sum += encrypted[i];
+        }
+        int mod = sum % 3;
+        std::size_t next_bits = (mod == 0) ? 256 : (mod == 1 ? 384 : 512);
+
+        current = sha2_hash(encrypted, next_bits);
+        if (current.empty()) {
+            return {};
+        }
+
+        if (round >= 64) {
+            unsigned char last = encrypted.back();
+            if (last <= static_cast<unsigned char>(round - 32)) {
+                break;
+            }
         }
     }
-    if (digest.size() < key_length_bytes) {
+
+    if (current.size() > 32) {
+        current.resize(32);
+    }
+    return current;
+}
+
+bool user_password_is_empty(const PDFEncryptInfo& info) {
+    if (!info.encrypted || (!info.filter.empty() && info.filter != "Standard")) {
         return false;
     }
-    digest.resize(key_length_bytes);
+    if (info.revision >= 2 && info.revision <= 4) {
+        int key_length_bits = info.length > 0 ? info.length : (info.revision == 2 ? 40 : 128);
+        return check_user_password(std::string(), info, info.revision, key_length_bits);
+    }
+    if ((info.revision == 5 || info.revision == 6) && info.u_string.size() >= 48) {
+        const unsigned char* u_data = info.u_string.data();
+        std::vector<unsigned char> hash = compute_hash_v5(std::string(), u_data + 32, 8, nullptr, 0, info.revision);
+        return hash.size() >= 32 && std::equal(u_data, u_data + 32, hash.begin());
+    }
+    return false;
+}
 
-    std::vector<unsigned char> data(info.o_string.begin(), info.o_string.end());
-    unlock_pdf::crypto::RC4 rc4(digest);
-    rc4.crypt(data.data(), data.data(), data.size());
+std::vector<unsigned char> derive_file_key(const std::string& password, const PDFEncryptInfo& info) {
+    if (!info.encrypted || (!info.filter.empty() && info.filter != "Standard")) {
+        return {};
+    }
+    if (info.revision >= 2 && info.revision <= 4) {
+        int key_length_bits = info.length > 0 ? info.length : (info.revision == 2 ? 40 : 128);
+        if (check_user_password(password, info, info.revision, key_length_bits)) {
+            return compute_encryption_key(password, info, info.revision, key_length_bits);
+        }
+        std::string user_password;
+        if (recover_user_password(password, info, info.revision, key_length_bits, user_password) &&
+            check_user_password(user_password, info, info.revision, key_length_bits)) {
+            return compute_encryption_key(user_password, info, info.revision, key_length_bits);
+        }
+        return {};
+    }
+    if ((info.revision != 5 && info.revision != 6) || info.u_string.size() < 48) {
+        return {};
+    }
 
-    if (revision >= 3) {
-        for (int i = 1; i <= 19; ++i) {
-            std::vector<unsigned char> iteration_key = digest;
-            for (unsigned char& byte : iteration_key) {
-                byte ^= static_cast<unsigned char>(i);
-            }
-            rc4.set_key(iteration_key);
-            rc4.crypt(data.data(), data.data(), data.size());
+    // Algorithm 2.A of ISO 32000-2: the intermediate key from the matching
+    // entry's key salt unwraps /UE or /OE.
+    std::string truncated = password.substr(0, std::min(password.size(), kAes256PasswordLimit));
+    const unsigned char* u_data = info.u_string.data();
+    const unsigned char* user_data = nullptr;
+    std::size_t user_data_size = 0;
+    const unsigned char* key_salt = nullptr;
+    const std::vector<unsigned char>* wrapped = nullptr;
+    std::vector<unsigned char> hash = compute_hash_v5(truncated, u_data + 32, 8, nullptr, 0, info.revision);
+    if (hash.size() >= 32 && std::equal(u_data, u_data + 32, hash.begin())) {
+        key_salt = u_data + 40;
+        wrapped = &info.ue_string;
+    } else if (info.o_string.size() >= 48) {
+        const unsigned char* o_data = info.o_string.data();
+        hash = compute_hash_v5(truncated, o_data + 32, 8, u_data, 48, info.revision);
+        if (hash.size() < 32 || !std::equal(o_data, o_data + 32, hash.begin())) {
+            return {};
         }
+        user_data = u_data;
+        user_data_size = 48;
+        key_salt = o_data + 40;
+        wrapped = &info.oe_string;
+    } else {
+        return {};
+    }
+    if (wrapped->size() < 32) {
+        return {};
     }
 
-    std::string user_password = unpad_password(data);
-    if (user_password.empty() && !data.empty()) {
-        user_password.assign(reinterpret_cast<const char*>(data.data()),
-                             reinterpret_cast<const char*>(data.data() + data.size()));
+    std::vector<unsigned char> key = compute_hash_v5(truncated, key_salt, 8, user_data, user_data_size, info.revision);
+    std::vector<unsigned char> iv(16, 0);
+    std::vector<unsigned char> file_key;
+    if (key.size() < 32 || !unlock_pdf::crypto::aes256_cbc_decrypt(key, iv, *wrapped, file_key, false) ||
+        file_key.size() < 32) {
+        return {};
     }
-    return check_user_password(user_password, info, revision, key_length_bits);
+    file_key.resize(32);
+    return file_key;
 }
 
 }  // namespace unlock_pdf::pdf::standard_security
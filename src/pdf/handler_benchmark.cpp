@@ -0,0 +1,160 @@
+#include "pdf/handler_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace unlock_pdf::pdf {
+namespace {
+
+// Odometer over `charset`, least significant position first, so consecutive
+// candidates differ in their first byte like the synthetic benchmark.
+class CandidateOdometer {
+   public:
+    CandidateOdometer(std::size_t length, const std::string& charset, std::size_t start)
+        : charset_(charset), candidate_(length, charset.front()), indices_(length, 0) {
+        for (std::size_t pos = 0; pos < length && start > 0; ++pos) {
+            indices_[pos] = start % charset_.size();
+            candidate_[pos] = charset_[indices_[pos]];
+            start /= charset_.size();
+        }
+    }
+
+    const std::string& candidate() const { return candidate_; }
+
+    void advance() {
+        std::size_t pos = 0;
+        while (pos < indices_.size()) {
+            std::size_t next_index = indices_[pos] + 1;
+            if (next_index < charset_.size()) {
+                indices_[pos] = next_index;
+                candidate_[pos] = charset_[next_index];
+                break;
+            }
+            indices_[pos] = 0;
+            candidate_[pos] = charset_.front();
+            ++pos;
+        }
+    }
+
+   private:
+    const std::string& charset_;
+    std::string candidate_;
+    std::vector<std::size_t> indices_;
+};
+
+bool check_candidate(const std::string& candidate,
+                     const PDFEncryptInfo& info,
+                     const std::vector<const EncryptionHandler*>& handlers,
+                     std::string& matched_variant) {
+    matched_variant.clear();
+    for (const auto* handler : handlers) {
+        if (handler->check_password(candidate, info, matched_variant)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+HandlerBenchmarkResult run_handler_benchmark(std::size_t length,
+                                             std::uint64_t attempts,
+                                             const std::string& charset,
+                                             const PDFEncryptInfo& info,
+                                             const std::vector<const EncryptionHandler*>& handlers) {
+    HandlerBenchmarkResult result;
+    result.password_length = length;
+    result.attempts = attempts;
+    if (charset.empty() || length == 0 || attempts == 0 || handlers.empty()) {
+        return result;
+    }
+
+    CandidateOdometer odometer(length, charset, 0);
+    std::string matched_variant;
+
+    volatile bool sink = false;
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t attempt = 0; attempt < attempts; ++attempt) {
+        sink = sink || check_candidate(odometer.candidate(), info, handlers, matched_variant);
+        odometer.advance();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Prevent the compiler from optimizing away the benchmark loop.
+    (void)sink;
+
+    result.duration_seconds = std::chrono::duration<double>(end - start).count();
+    if (result.duration_seconds > 0.0) {
+        result.attempts_per_second = static_cast<double>(attempts) / result.duration_seconds;
+    }
+    return result;
+}
+
+HandlerBenchmarkResult run_handler_benchmark_timed(std::size_t length,
+                                                   const std::string& charset,
+                                                   const PDFEncryptInfo& info,
+                                                   const std::vector<const EncryptionHandler*>& handlers,
+                                                   unsigned int thread_count,
+                                                   std::chrono::milliseconds window) {
+    HandlerBenchmarkResult result;
+    result.password_length = length;
+    result.thread_count = std::max(thread_count, 1u);
+    if (charset.empty() || length == 0 || handlers.empty()) {
+        return result;
+    }
+
+    std::vector<std::uint64_t> counts(result.thread_count, 0);
+    std::atomic<unsigned int> ready{0};
+    std::atomic<bool> go{false};
+    std::chrono::steady_clock::time_point deadline;
+
+    auto worker = [&](unsigned int thread_index) {
+        // Spread the threads over the candidate space so they never test the
+        // same passwords.
+        CandidateOdometer odometer(length, charset, static_cast<std::size_t>(thread_index) * 7919u);
+        std::string matched_variant;
+        std::uint64_t attempts = 0;
+        volatile bool sink = false;
+
+        ready.fetch_add(1, std::memory_order_acq_rel);
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        do {
+            sink = sink || check_candidate(odometer.candidate(), info, handlers, matched_variant);
+            odometer.advance();
+            ++attempts;
+        } while (std::chrono::steady_clock::now() < deadline);
+        (void)sink;
+        counts[thread_index] = attempts;
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(result.thread_count);
+    for (unsigned int i = 0; i < result.thread_count; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    while (ready.load(std::memory_order_acquire) < result.thread_count) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    deadline = start + window;
+    go.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (std::uint64_t count : counts) {
+        result.attempts += count;
+    }
+    result.duration_seconds = std::chrono::duration<double>(end - start).count();
+    if (result.duration_seconds > 0.0) {
+        result.attempts_per_second = static_cast<double>(result.attempts) / result.duration_seconds;
+    }
+    return result;
+}
+
+}  // namespace unlock_pdf::pdf
@@ -3,45 +3,136 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <locale>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <codecvt>
 
+#include "crypto/sha2.h"
+#include "pdf/autotune.h"
+#include "pdf/crack_metrics.h"
 #include "pdf/encryption/encryption_handler_registry.h"
+#include "pdf/encryption/standard_security_utils.h"
+#include "pdf/handler_benchmark.h"
+#include "pdf/pdf_hash.h"
 #include "pdf/pdf_parser.h"
+#include "pdf/progress_events.h"
+#include "pdf/progress_reporter.h"
+#include "pdf/session_coverage.h"
+#include "util/hex.h"
+#include "util/keyspace.h"
+#include "util/pcfg.h"
+#include "util/prince.h"
+#include "util/system_info.h"
+#include "util/thread_affinity.h"
 
 namespace unlock_pdf::pdf {
 namespace {
 
-void print_progress(std::size_t tried, std::size_t total) {
-    if (total == 0) {
-        std::cout << "\rPasswords tried: " << tried << std::flush;
+void report_error(const CrackOptions& crack_options, const std::string& message) {
+    std::cerr << "Error: " << message << std::endl;
+    if (crack_options.events != nullptr) {
+        crack_options.events->error(message);
+    }
+}
+
+// The parser prints its own diagnostics; front-ends only need to know which
+// file could not be read.
+void report_unreadable_pdf(const CrackOptions& crack_options, const std::string& pdf_path) {
+    if (crack_options.events != nullptr) {
+        crack_options.events->error("unable to read encryption information from " + pdf_path);
+    }
+}
+
+// Emits the closing events of a run: "found" for every solved target, then
+// one "finished" that succeeds only when all of them were solved.
+void report_outcomes(const CrackOptions& crack_options,
+                     const std::vector<CrackResult>& results,
+                     double elapsed_seconds) {
+    if (crack_options.events == nullptr) {
         return;
     }
-    double progress = static_cast<double>(tried) / static_cast<double>(total) * 100.0;
-    std::cout << "\rTrying passwords... " << std::fixed << std::setprecision(2) << progress << "% (" << tried
-              << "/" << total << ")" << std::flush;
+    bool all_found = !results.empty();
+    std::size_t tried = 0;
+    for (const CrackResult& result : results) {
+        if (result.success) {
+            crack_options.events->found(result.password, result.variant, result.passwords_tried);
+        }
+        all_found = all_found && result.success;
+        tried = std::max(tried, result.passwords_tried);
+    }
+    crack_options.events->finished(all_found, tried, elapsed_seconds);
 }
 
-bool check_password_variants(const std::string& password,
-                             const PDFEncryptInfo& info,
-                             const std::vector<const EncryptionHandler*>& handlers,
-                             std::string& matched_variant) {
-    for (const EncryptionHandler* handler : handlers) {
-        if (handler->check_password(password, info, matched_variant)) {
-            return true;
+// Characters the brute-force generator draws from, empty after reporting an
+// error.
+std::string bruteforce_alphabet(const unlock_pdf::util::WordlistOptions& options, const CrackOptions& crack_options) {
+    std::string alphabet;
+    if (options.use_custom_characters) {
+        if (options.custom_characters.empty()) {
+            report_error(crack_options, "custom characters must not be empty");
+            return alphabet;
+        }
+        alphabet = options.custom_characters;
+    } else {
+        if (options.include_uppercase) {
+            alphabet += "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        }
+        if (options.include_lowercase) {
+            alphabet += "abcdefghijklmnopqrstuvwxyz";
+        }
+        if (options.include_digits) {
+            alphabet += "0123456789";
+        }
+        if (options.include_special) {
+            alphabet += "!\"#$%&'()*+,-./:;<=>?@[]^_{|}~";
+        }
+        if (alphabet.empty()) {
+            report_error(crack_options, "character set is empty");
         }
     }
-    return false;
+    return alphabet;
+}
+
+// Lengths beyond what the revision hashes only repeat candidates that were
+// already tried at the limit, so the range is cut to it.
+void clamp_length_range(const PDFEncryptInfo& info, std::size_t& min_length, std::size_t& max_length) {
+    std::size_t limit = standard_security::max_password_length(info.revision);
+    if (limit == 0 || max_length <= limit) {
+        return;
+    }
+    std::cout << "Revision " << info.revision << " only uses the first " << limit
+              << " bytes of a password; searching lengths " << std::min(min_length, limit) << ".." << limit
+              << " instead of " << min_length << ".." << max_length << std::endl;
+    min_length = std::min(min_length, limit);
+    max_length = limit;
+}
+
+std::vector<std::string> handler_names(const std::vector<const EncryptionHandler*>& handlers) {
+    std::vector<std::string> names;
+    names.reserve(handlers.size());
+    for (const EncryptionHandler* handler : handlers) {
+        names.push_back(handler->name());
+    }
+    return names;
 }
 
 bool handle_non_password_handlers(const PDFEncryptInfo& info,
@@ -71,51 +162,238 @@ bool handle_non_password_handlers(const PDFEncryptInfo& info,
     return false;
 }
 
-std::vector<const EncryptionHandler*> collect_password_handlers(const PDFEncryptInfo& info,
-                                                                const std::vector<EncryptionHandlerPtr>& handlers) {
-    std::vector<const EncryptionHandler*> password_handlers;
-    password_handlers.reserve(handlers.size());
-    for (const auto& handler : handlers) {
-        if (!handler->can_handle(info) || !handler->requires_password()) {
-            continue;
+struct ThreadPlan {
+    unsigned int thread_count = 1;
+    std::size_t batch_size = 1;
+    unlock_pdf::util::AffinityPolicy affinity = unlock_pdf::util::AffinityPolicy::None;
+    std::vector<unlock_pdf::util::LogicalCpu> topology;
+    std::vector<unlock_pdf::util::LogicalCpu> placement;
+};
+
+// An explicit --threads value always wins; otherwise size the pool to the CPUs
+// the process may actually use (affinity mask and cgroup quota), not the host.
+// physical-only additionally caps the automatic size at one thread per core.
+// With --autotune the automatic size and batch size come from a calibration
+// run (or its cached result) instead.
+ThreadPlan resolve_thread_plan(const CrackOptions& crack_options,
+                               const PDFEncryptInfo& info,
+                               const std::vector<const EncryptionHandler*>& handlers) {
+    using unlock_pdf::util::AffinityPolicy;
+
+    ThreadPlan plan;
+    plan.affinity = crack_options.affinity;
+    if (plan.affinity != AffinityPolicy::None) {
+        plan.topology = unlock_pdf::util::read_cpu_topology();
+    }
+
+    unsigned int thread_count = crack_options.thread_count;
+    unsigned int max_threads = unlock_pdf::util::effective_cpu_count();
+    if (plan.affinity == AffinityPolicy::PhysicalOnly && !plan.topology.empty()) {
+        max_threads = std::min(max_threads, unlock_pdf::util::count_physical_cores(plan.topology));
+    }
+    plan.batch_size = crack_options.batch_size > 0 ? crack_options.batch_size : default_batch_size(info);
+
+    if (crack_options.autotune && (thread_count == 0 || crack_options.batch_size == 0)) {
+        AutotuneResult tuned = autotune_cracking(info, handlers, thread_count > 0 ? thread_count : max_threads);
+        std::cout << "Autotune" << (tuned.from_cache ? " (cached)" : "") << ": " << tuned.thread_count
+                  << " threads, batch " << tuned.batch_size << ", " << tuned.kernel_variant << " kernel" << std::endl;
+        if (thread_count == 0) {
+            thread_count = tuned.thread_count;
         }
-        password_handlers.push_back(handler.get());
+        if (crack_options.batch_size == 0) {
+            plan.batch_size = tuned.batch_size;
+        }
+    }
+
+    if (thread_count == 0) {
+        thread_count = max_threads;
+    }
+    plan.thread_count = std::max(thread_count, 1u);
+    return plan;
+}
+
+void finalize_thread_plan(ThreadPlan& plan, unsigned int thread_count) {
+    plan.thread_count = std::max(thread_count, 1u);
+    plan.placement = unlock_pdf::util::plan_thread_placement(plan.topology, plan.affinity, plan.thread_count);
+    if (plan.affinity == unlock_pdf::util::AffinityPolicy::None) {
+        return;
+    }
+    std::cout << "Thread affinity: " << unlock_pdf::util::affinity_policy_name(plan.affinity);
+    if (plan.placement.empty()) {
+        std::cout << " (CPU topology unavailable, threads are not pinned)" << std::endl;
+        return;
+    }
+    std::cout << "\n  " << unlock_pdf::util::describe_thread_placement(plan.placement) << std::endl;
+    if (plan.placement.size() < plan.thread_count) {
+        std::cerr << "Warning: " << plan.thread_count << " threads but only " << plan.placement.size()
+                  << " physical cores; the other " << (plan.thread_count - plan.placement.size())
+                  << " threads are not pinned" << std::endl;
+    }
+}
+
+// Pins the calling worker according to the plan. Per-thread scratch buffers are
+// allocated by the worker after this call, so first-touch page placement puts
+// them on the NUMA node of the pinned CPU.
+void apply_thread_placement(const ThreadPlan& plan, unsigned int thread_index) {
+    if (thread_index < plan.placement.size()) {
+        unlock_pdf::util::pin_current_thread(plan.placement[thread_index].id);
     }
-    return password_handlers;
 }
 
+// Cuts candidates to the number of bytes the revision actually hashes and
+// rejects truncated forms that were already produced. Only candidates that
+// reach the limit can collide, so only those are remembered; past
+// kMaxRemembered of them candidates are still cut but no longer deduplicated.
+class TruncationFilter {
+   public:
+    static constexpr std::size_t kMaxRemembered = 1u << 20;
+
+    explicit TruncationFilter(std::size_t max_length = 0) : max_length_(max_length) {}
+
+    std::size_t max_length() const { return max_length_; }
+    std::uint64_t skipped() const { return skipped_; }
+
+    // Truncates `password` in place; false when it repeats an earlier candidate.
+    bool admit(std::string& password) {
+        if (max_length_ == 0 || password.size() < max_length_) {
+            return true;
+        }
+        password.resize(max_length_);
+        if (seen_.size() >= kMaxRemembered && seen_.count(password) == 0) {
+            return true;
+        }
+        if (!seen_.insert(password).second) {
+            ++skipped_;
+            return false;
+        }
+        return true;
+    }
+
+   private:
+    std::size_t max_length_ = 0;
+    std::unordered_set<std::string> seen_;
+    std::uint64_t skipped_ = 0;
+};
+
 class PasswordSource {
    public:
     virtual ~PasswordSource() = default;
+
+    // Called once the PDF is known, before any candidate is requested.
+    // `max_length` is the number of password bytes the revision uses, 0 when
+    // it is unlimited; sources truncate to it and drop the resulting repeats.
+    virtual void prepare(std::size_t max_length) { (void)max_length; }
+
     virtual bool next(std::string& password) = 0;
     virtual bool has_total() const { return false; }
     virtual std::size_t total() const { return 0; }
+
+    // Works out total() for sources that stream without knowing it. Called
+    // on the run's own thread while the workers take candidates; returns
+    // false when `cancelled` returns true first or the total stays unknown.
+    virtual bool count_total(const std::function<bool()>& cancelled) {
+        (void)cancelled;
+        return has_total();
+    }
+
+    // Identity of the candidate order for the session coverage database, empty
+    // when the source cannot be resumed. Valid after prepare().
+    virtual std::string coverage_key() const { return std::string(); }
+
+    // Leaves out the candidates at `done` positions; called after prepare()
+    // and before the first candidate is requested.
+    virtual void exclude(const IntervalSet& done) { (void)done; }
+
+    // Fills `batch` with up to `max_count` candidates. Sources override this to
+    // pay their synchronisation cost once per batch instead of per candidate.
+    // `positions` receives the range of candidate positions the batch spans,
+    // including excluded ones, or an empty range when the source has none.
+    virtual bool next_batch(std::vector<std::string>& batch,
+                            std::size_t max_count,
+                            ThreadMetrics& metrics,
+                            IntervalSet::Range& positions) {
+        ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+        positions = IntervalSet::Range{0, 0};
+        batch.resize(std::max<std::size_t>(max_count, 1));
+        std::size_t count = 0;
+        while (count < batch.size() && next(batch[count])) {
+            ++count;
+        }
+        batch.resize(count);
+        return count > 0;
+    }
 };
 
 class VectorPasswordSource final : public PasswordSource {
    public:
-    explicit VectorPasswordSource(const std::vector<std::string>& passwords) : passwords_(passwords) {}
+    explicit VectorPasswordSource(const std::vector<std::string>& passwords) : passwords_(&passwords) {}
+
+    void prepare(std::size_t max_length) override {
+        bool needs_filter = std::any_of(passwords_->begin(), passwords_->end(), [&](const std::string& password) {
+            return max_length > 0 && password.size() > max_length;
+        });
+        if (!needs_filter) {
+            return;
+        }
+        TruncationFilter filter(max_length);
+        filtered_.reserve(passwords_->size());
+        for (std::string password : *passwords_) {
+            if (filter.admit(password)) {
+                filtered_.push_back(std::move(password));
+            }
+        }
+        passwords_ = &filtered_;
+        if (filter.skipped() > 0) {
+            std::cout << "Skipping " << filter.skipped() << " passwords that repeat once cut to " << max_length
+                      << " bytes" << std::endl;
+        }
+    }
 
     bool next(std::string& password) override {
         std::size_t index = index_.fetch_add(1, std::memory_order_relaxed);
-        if (index >= passwords_.size()) {
+        if (index >= passwords_->size()) {
+            return false;
+        }
+        password = (*passwords_)[index];
+        return true;
+    }
+
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+        max_count = std::max<std::size_t>(max_count, 1);
+        std::size_t first = index_.fetch_add(max_count, std::memory_order_relaxed);
+        batch.clear();
+        if (first >= passwords_->size()) {
             return false;
         }
-        password = passwords_[index];
+        std::size_t last = std::min(passwords_->size(), first + max_count);
+        positions = IntervalSet::Range{first, last};
+        batch.assign(passwords_->begin() + static_cast<std::ptrdiff_t>(first),
+                     passwords_->begin() + static_cast<std::ptrdiff_t>(last));
         return true;
     }
 
     bool has_total() const override { return true; }
-    std::size_t total() const override { return passwords_.size(); }
+    std::size_t total() const override { return passwords_->size(); }
 
    private:
-    const std::vector<std::string>& passwords_;
+    const std::vector<std::string>* passwords_;
+    std::vector<std::string> filtered_;  // truncated and deduplicated copy, when needed
     std::atomic<std::size_t> index_{0};
 };
 
 class FilePasswordSource final : public PasswordSource {
    public:
-    explicit FilePasswordSource(const std::string& path) : stream_(path, std::ios::binary) {
+    // `identify` digests the candidate sequence for the session coverage
+    // database. `count` reads the list once in prepare() to learn its exact
+    // total; otherwise the workers start on the stream right away,
+    // count_total() counts it alongside them and the digest is complete once
+    // the stream is used up.
+    FilePasswordSource(const std::string& path, bool identify, bool count)
+        : path_(path), stream_(path, std::ios::binary), identify_(identify), count_(count) {
         if (!stream_) {
             throw std::runtime_error("unable to open wordlist: " + path);
         }
@@ -141,11 +419,164 @@ class FilePasswordSource final : public PasswordSource {
 
         stream_.clear();
         stream_.seekg(static_cast<std::streamoff>(skip), std::ios::beg);
+        data_offset_ = skip;
+    }
+
+    // When counting, reads the whole file once through a separate stream with
+    // the same line rules and truncation as the workers, so the total is
+    // exact, and records how many candidates of each length it holds.
+    void prepare(std::size_t max_length) override {
+        filter_ = TruncationFilter(max_length);
+        max_length_ = max_length;
+        if (!count_) {
+            return;
+        }
+        std::cout << "Counting candidates in '" << path_ << "'..." << std::endl;
+
+        unlock_pdf::crypto::Sha256Context sequence;
+        TruncationFilter counting_filter(max_length);
+        count_candidates(counting_filter, identify_ ? &sequence : nullptr, nullptr);
+        if (identify_) {
+            finish_coverage_key(sequence);
+        }
+        if (counting_filter.skipped() > 0) {
+            std::cout << "Skipping " << counting_filter.skipped() << " passwords that repeat once cut to "
+                      << max_length << " bytes" << std::endl;
+        }
+    }
+
+    // The same pass as a counting prepare(), minus the digest, which the
+    // stream itself completes.
+    bool count_total(const std::function<bool()>& cancelled) override {
+        if (counted_) {
+            return true;
+        }
+        TruncationFilter counting_filter(max_length_);
+        return count_candidates(counting_filter, nullptr, &cancelled);
+    }
+
+    const std::map<std::size_t, std::uint64_t>& length_counts() const { return length_counts_; }
+
+    bool has_total() const override { return counted_; }
+    std::size_t total() const override { return static_cast<std::size_t>(total_); }
+
+    std::string coverage_key() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return coverage_key_;
+    }
+
+    // Positions count admitted candidates, so they only mean the same thing
+    // to runs with the same coverage key.
+    void exclude(const IntervalSet& done) override {
+        excluded_ = done;
+        total_ -= std::min(total_, done.count_within(0, total_));
     }
 
     bool next(std::string& password) override {
         std::lock_guard<std::mutex> lock(mutex_);
-        if (!stream_) {
+        return read_next_locked(password);
+    }
+
+    // next() that also reports the candidate's position, for sources that
+    // build their own positions on top of the list's.
+    bool next(std::string& password, std::uint64_t& position) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!read_next_locked(password)) {
+            return false;
+        }
+        position = position_ - 1;
+        return true;
+    }
+
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        batch.resize(std::max<std::size_t>(max_count, 1));
+        std::size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+            {
+                ScopedPhaseTimer wait(metrics, MetricPhase::QueueWait);
+                lock.lock();
+            }
+            ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+            positions.first = position_;
+            while (count < batch.size() && read_next_locked(batch[count])) {
+                ++count;
+            }
+            positions.second = position_;
+        }
+        batch.resize(count);
+        return count > 0;
+    }
+
+   private:
+    enum class Encoding { Utf8, Utf16LE, Utf16BE };
+
+    // Candidates count_total() reads between looks at its cancel flag.
+    static constexpr std::uint64_t kCancelCheckInterval = 4096;
+
+    // Reads the list through its own stream, so the workers' position is
+    // untouched, and sets the total only when the pass reaches the end.
+    bool count_candidates(TruncationFilter& filter,
+                          unlock_pdf::crypto::Sha256Context* sequence,
+                          const std::function<bool()>* cancelled) {
+        std::ifstream input(path_, std::ios::binary);
+        input.seekg(static_cast<std::streamoff>(data_offset_), std::ios::beg);
+        std::map<std::size_t, std::uint64_t> length_counts;
+        std::uint64_t total = 0;
+        std::string password;
+        while (read_candidate(input, filter, password)) {
+            if (cancelled != nullptr && total % kCancelCheckInterval == 0 && (*cancelled)()) {
+                return false;
+            }
+            ++length_counts[password.size()];
+            ++total;
+            if (sequence != nullptr) {
+                password += '\n';
+                sequence->update(reinterpret_cast<const unsigned char*>(password.data()), password.size());
+            }
+        }
+        length_counts_ = std::move(length_counts);
+        total_ = total;
+        counted_ = true;
+        return true;
+    }
+
+    bool read_next_locked(std::string& password) {
+        bool digesting = identify_ && !count_;
+        while (read_candidate(stream_, filter_, password)) {
+            if (digesting) {
+                streamed_sequence_.update(reinterpret_cast<const unsigned char*>(password.data()), password.size());
+                streamed_sequence_.update(reinterpret_cast<const unsigned char*>("\n"), 1);
+            }
+            std::uint64_t position = position_++;
+            // Positions only grow, so a cursor into the excluded ranges
+            // replaces a search per candidate.
+            const std::vector<IntervalSet::Range>& ranges = excluded_.ranges();
+            while (excluded_cursor_ < ranges.size() && ranges[excluded_cursor_].second <= position) {
+                ++excluded_cursor_;
+            }
+            if (excluded_cursor_ == ranges.size() || ranges[excluded_cursor_].first > position) {
+                return true;
+            }
+        }
+        if (digesting && coverage_key_.empty()) {
+            finish_coverage_key(streamed_sequence_);
+        }
+        return false;
+    }
+
+    void finish_coverage_key(unlock_pdf::crypto::Sha256Context& sequence) {
+        unsigned char digest[32];
+        sequence.finalize(digest);
+        coverage_key_ = "wordlist:";
+        coverage_key_ += unlock_pdf::util::to_hex(digest, sizeof(digest));
+    }
+
+    bool read_candidate(std::istream& input, TruncationFilter& filter, std::string& password) {
+        if (!input) {
             return false;
         }
 
@@ -153,28 +584,25 @@ class FilePasswordSource final : public PasswordSource {
         while (true) {
             bool ok = false;
             if (encoding_ == Encoding::Utf8) {
-                ok = read_utf8_line(line);
+                ok = read_utf8_line(input, line);
             } else {
-                ok = read_utf16_line(line);
+                ok = read_utf16_line(input, line);
             }
 
             if (!ok) {
                 return false;
             }
 
-            if (!line.empty()) {
+            if (!line.empty() && filter.admit(line)) {
                 password = std::move(line);
                 return true;
             }
         }
     }
 
-   private:
-    enum class Encoding { Utf8, Utf16LE, Utf16BE };
-
-    bool read_utf8_line(std::string& out) {
+    bool read_utf8_line(std::istream& input, std::string& out) {
         std::string line;
-        if (!std::getline(stream_, line)) {
+        if (!std::getline(input, line)) {
             return false;
         }
         if (!line.empty() && line.back() == '\r') {
@@ -184,13 +612,13 @@ class FilePasswordSource final : public PasswordSource {
         return true;
     }
 
-    bool read_utf16_line(std::string& out) {
+    bool read_utf16_line(std::istream& input, std::string& out) {
         std::u16string buffer;
         bool read_any = false;
         while (true) {
             char bytes[2];
-            stream_.read(bytes, 2);
-            std::streamsize got = stream_.gcount();
+            input.read(bytes, 2);
+            std::streamsize got = input.gcount();
             if (got == 0) {
                 break;
             }
@@ -228,250 +656,1676 @@ class FilePasswordSource final : public PasswordSource {
         return true;
     }
 
+    std::string path_;
     std::ifstream stream_;
+    std::size_t data_offset_ = 0;
     Encoding encoding_ = Encoding::Utf8;
-    std::mutex mutex_;
+    TruncationFilter filter_;  // guarded by mutex_ once workers run
+    std::size_t max_length_ = 0;
+    bool counted_ = false;
+    std::uint64_t total_ = 0;
+    std::map<std::size_t, std::uint64_t> length_counts_;
+    bool identify_ = false;
+    bool count_ = false;
+    std::string coverage_key_;                       // guarded by mutex_ while streaming
+    unlock_pdf::crypto::Sha256Context streamed_sequence_;  // guarded by mutex_
+    IntervalSet excluded_;
+    std::size_t excluded_cursor_ = 0;  // guarded by mutex_
+    std::uint64_t position_ = 0;       // guarded by mutex_
+    mutable std::mutex mutex_;
     std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> utf16_converter_;
 };
 
-bool crack_with_source(PasswordSource& source,
-                       const std::string& pdf_path,
-                       CrackResult& result,
-                       unsigned int thread_count) {
-    result = CrackResult{};
-    if (source.has_total()) {
-        result.total_passwords = source.total();
+// Runs every word of a wordlist through every rule of a rule set. Only base
+// words come out of the shared stream; the worker that fetched them applies
+// the rules after the lock is released, so the file is read once per word
+// instead of once per candidate. Results are cut to the revision's length and
+// repeats among the candidates of one word are dropped. Positions are those
+// of the base words.
+class RulePasswordSource final : public PasswordSource {
+   public:
+    RulePasswordSource(FilePasswordSource& words, const unlock_pdf::util::RuleSet& rules)
+        : words_(words), rules_(rules) {}
+
+    // Rules see whole words, so the wordlist itself is not truncated.
+    void prepare(std::size_t max_length) override {
+        max_length_ = max_length;
+        words_.prepare(0);
+        std::cout << "Applying " << rules_.size() << " rules to each word" << std::endl;
     }
 
-    PDFEncryptInfo encrypt_info;
-    if (!read_pdf_encrypt_info(pdf_path, encrypt_info)) {
-        return false;
+    // An upper bound: rejected and repeated candidates are counted too. It
+    // saturates rather than wrapping for huge lists times huge rule files.
+    bool has_total() const override { return words_.has_total(); }
+    std::size_t total() const override {
+        std::size_t words = words_.total();
+        if (rules_.size() > 0 && words > std::numeric_limits<std::size_t>::max() / rules_.size()) {
+            return std::numeric_limits<std::size_t>::max();
+        }
+        return words * rules_.size();
     }
 
-    auto handlers = create_default_encryption_handlers();
-    if (handle_non_password_handlers(encrypt_info, result, handlers)) {
-        return true;
+    bool count_total(const std::function<bool()>& cancelled) override { return words_.count_total(cancelled); }
+
+    std::string coverage_key() const override {
+        std::string key = words_.coverage_key();
+        if (key.empty()) {
+            return key;
+        }
+        unlock_pdf::crypto::Sha256Context sequence;
+        for (std::size_t i = 0; i < rules_.size(); ++i) {
+            std::string text = rules_[i].text() + '\n';
+            sequence.update(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+        }
+        unsigned char digest[32];
+        sequence.finalize(digest);
+        key += ":rules:";
+        key += unlock_pdf::util::to_hex(digest, 8);
+        return key;
     }
 
-    std::vector<const EncryptionHandler*> password_handlers = collect_password_handlers(encrypt_info, handlers);
-    if (password_handlers.empty()) {
-        std::cerr << "Error: No password-based handlers are available for the detected encryption." << std::endl;
-        return false;
+    void exclude(const IntervalSet& done) override { words_.exclude(done); }
+
+    bool next(std::string& password) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (pending_index_ >= pending_.size()) {
+            std::string word;
+            if (!words_.next(word)) {
+                return false;
+            }
+            pending_.clear();
+            pending_index_ = 0;
+            std::unordered_set<std::string> seen;
+            expand(word, pending_, seen);
+        }
+        password = std::move(pending_[pending_index_++]);
+        return true;
     }
 
-    if (thread_count == 0) {
-        thread_count = std::thread::hardware_concurrency();
-        if (thread_count == 0) {
-            thread_count = 2;
+    // `max_count` counts candidates; enough words are fetched to fill it
+    // once expanded, at least one.
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        std::vector<std::string> words;
+        std::size_t word_count = std::max<std::size_t>(max_count / rules_.size(), 1);
+        if (!words_.next_batch(words, word_count, metrics, positions)) {
+            batch.clear();
+            return false;
+        }
+        ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+        batch.clear();
+        std::unordered_set<std::string> seen;
+        for (const std::string& word : words) {
+            seen.clear();
+            expand(word, batch, seen);
         }
+        return true;
     }
-    thread_count = std::max(thread_count, 1u);
-    if (source.has_total()) {
-        std::size_t total = source.total();
-        if (total > 0 && static_cast<std::size_t>(thread_count) > total) {
-            thread_count = static_cast<unsigned int>(total);
-            thread_count = std::max(thread_count, 1u);
+
+   private:
+    void expand(const std::string& word, std::vector<std::string>& out, std::unordered_set<std::string>& seen) const {
+        std::string candidate;
+        for (std::size_t i = 0; i < rules_.size(); ++i) {
+            if (!rules_[i].apply(word, candidate)) {
+                continue;
+            }
+            if (max_length_ > 0 && candidate.size() > max_length_) {
+                candidate.resize(max_length_);
+            }
+            if (seen.insert(candidate).second) {
+                out.push_back(candidate);
+            }
         }
     }
 
-    std::cout << "\nStarting password cracking with " << thread_count << " threads" << std::endl;
+    FilePasswordSource& words_;
+    const unlock_pdf::util::RuleSet& rules_;
+    std::size_t max_length_ = 0;
+    std::vector<std::string> pending_;  // expansions of the current word for next(), guarded by mutex_
+    std::size_t pending_index_ = 0;     // guarded by mutex_
+    std::mutex mutex_;
+};
 
-    std::atomic<bool> password_found{false};
-    std::atomic<std::size_t> passwords_tried{0};
-    std::mutex result_mutex;
-    std::string found_password;
-    std::string found_variant;
+// What ProductPasswordSource joins to every word: numbered so that a position
+// in the product is plain arithmetic.
+class ElementSequence {
+   public:
+    virtual ~ElementSequence() = default;
 
-    auto start_time = std::chrono::steady_clock::now();
+    virtual std::uint64_t size() const = 0;
+    virtual void element(std::uint64_t index, std::string& out) const = 0;
+    virtual std::map<std::size_t, std::uint64_t> length_counts() const = 0;
+    // Identity of the element order for the coverage key, empty when unknown.
+    virtual std::string coverage_key() const = 0;
+};
 
-    auto worker = [&]() {
-        while (true) {
-            if (password_found.load(std::memory_order_relaxed)) {
-                break;
-            }
+class MaskElements final : public ElementSequence {
+   public:
+    explicit MaskElements(const unlock_pdf::util::Mask& mask) : mask_(mask) {}
 
-            std::string password;
-            if (!source.next(password)) {
-                break;
-            }
+    std::uint64_t size() const override { return mask_.size(); }
+    void element(std::uint64_t index, std::string& out) const override { mask_.expansion(index, out); }
 
-            std::size_t attempt = passwords_tried.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::map<std::size_t, std::uint64_t> length_counts() const override {
+        return {{mask_.length(), mask_.size()}};
+    }
 
-            if (password_found.load(std::memory_order_acquire)) {
-                break;
-            }
+    std::string coverage_key() const override {
+        unsigned char digest[32];
+        const std::string& text = mask_.text();
+        unlock_pdf::crypto::sha256_digest(reinterpret_cast<const unsigned char*>(text.data()), text.size(), digest);
+        std::string key = "mask:";
+        key += unlock_pdf::util::to_hex(digest, 8);
+        return key;
+    }
 
-            std::string variant;
-            if (check_password_variants(password, encrypt_info, password_handlers, variant)) {
-                std::lock_guard<std::mutex> lock(result_mutex);
-                if (!password_found.load(std::memory_order_relaxed)) {
-                    password_found.store(true, std::memory_order_release);
-                    found_password = std::move(password);
-                    found_variant = std::move(variant);
-                    std::cout << "\nPASSWORD FOUND [" << found_variant << "]: " << found_password << std::endl;
-                }
-                break;
-            }
+   private:
+    const unlock_pdf::util::Mask& mask_;
+};
 
-            if (attempt % 100 == 0) {
-                print_progress(attempt, result.total_passwords);
-            }
+// The smaller list of a combinator run, read into memory once.
+class WordListElements final : public ElementSequence {
+   public:
+    // `list` must be prepared; it is read to the end, which also completes
+    // its coverage key.
+    explicit WordListElements(FilePasswordSource& list) {
+        std::string word;
+        while (list.next(word)) {
+            ++length_counts_[word.size()];
+            words_.push_back(std::move(word));
         }
-    };
-
-    std::vector<std::thread> threads;
-    threads.reserve(thread_count);
-    for (unsigned int i = 0; i < thread_count; ++i) {
-        threads.emplace_back(worker);
+        coverage_key_ = list.coverage_key();
     }
 
-    for (auto& thread : threads) {
-        thread.join();
+    std::uint64_t size() const override { return words_.size(); }
+    void element(std::uint64_t index, std::string& out) const override {
+        out = words_[static_cast<std::size_t>(index)];
     }
+    std::map<std::size_t, std::uint64_t> length_counts() const override { return length_counts_; }
+    std::string coverage_key() const override { return coverage_key_; }
 
-    std::size_t attempted = passwords_tried.load(std::memory_order_relaxed);
-    std::cout << std::endl;
-
-    auto end_time = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time);
-    std::cout << "\nFinished in " << duration.count() << " seconds" << std::endl;
+   private:
+    std::vector<std::string> words_;
+    std::map<std::size_t, std::uint64_t> length_counts_;
+    std::string coverage_key_;
+};
 
-    result.passwords_tried = attempted;
-    if (result.total_passwords == 0 || result.total_passwords < attempted) {
-        result.total_passwords = attempted;
+// Every word of a streamed list joined with every element of a sequence, as
+// word + element or element + word. Candidate p is element p % N of word
+// p / N, so a word's N candidates may be split across batches and threads:
+// the lock only hands out (word, element range) claims and each worker builds
+// its candidates after releasing it. The list is read once however large N is.
+class ProductPasswordSource final : public PasswordSource {
+   public:
+    ProductPasswordSource(FilePasswordSource& words, const ElementSequence& elements, bool elements_first)
+        : words_(words), elements_(elements), elements_first_(elements_first), next_element_(elements.size()) {}
+
+    // Words are joined whole; the results are cut instead.
+    void prepare(std::size_t max_length) override {
+        max_length_ = max_length;
+        if (!words_.has_total()) {
+            words_.prepare(0);
+        }
+        std::uint64_t words = words_.total();
+        if (words_.has_total() && elements_.size() > 0 &&
+            words > std::numeric_limits<std::uint64_t>::max() / elements_.size()) {
+            throw std::runtime_error("the combined keyspace exceeds 2^64 candidates");
+        }
     }
-    result.success = password_found.load(std::memory_order_relaxed);
-    if (result.success) {
-        result.password = found_password;
-        result.variant = found_variant;
-        std::cout << "Password found: " << result.password << std::endl;
-    } else {
-        std::cout << "Password not found in the provided list" << std::endl;
+
+    // Saturates like RulePasswordSource when a list counted during the run
+    // takes the product past 2^64.
+    bool has_total() const override { return words_.has_total(); }
+    std::size_t total() const override {
+        std::size_t words = words_.total();
+        std::size_t count = static_cast<std::size_t>(elements_.size());
+        if (count > 0 && words > std::numeric_limits<std::size_t>::max() / count) {
+            return std::numeric_limits<std::size_t>::max();
+        }
+        return words * count;
     }
 
-    return true;
-}
+    bool count_total(const std::function<bool()>& cancelled) override { return words_.count_total(cancelled); }
 
-}  // namespace
+    std::string coverage_key() const override {
+        std::string words = words_.coverage_key();
+        std::string elements = elements_.coverage_key();
+        if (words.empty() || elements.empty()) {
+            return std::string();
+        }
+        return elements_first_ ? elements + "+" + words : words + "+" + elements;
+    }
 
-bool crack_pdf(const std::vector<std::string>& passwords,
-               const std::string& pdf_path,
-               CrackResult& result,
-               unsigned int thread_count) {
-    if (passwords.empty()) {
-        std::cerr << "Error: password list is empty" << std::endl;
-        return false;
+    // Only words whose candidates are all done are left out; a partly done
+    // word is tested again in full.
+    void exclude(const IntervalSet& done) override {
+        std::uint64_t count = elements_.size();
+        IntervalSet done_words;
+        for (const IntervalSet::Range& range : done.ranges()) {
+            done_words.add((range.first + count - 1) / count, range.second / count);
+        }
+        words_.exclude(done_words);
     }
 
-    VectorPasswordSource source(passwords);
-    return crack_with_source(source, pdf_path, result, thread_count);
-}
+    bool next(std::string& password) override {
+        Claim claim;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            IntervalSet::Range positions;
+            if (!claim_locked(1, claim, positions)) {
+                return false;
+            }
+        }
+        join(claim.word, claim.begin, password);
+        return true;
+    }
 
-bool crack_pdf_from_file(const std::string& wordlist_path,
-                         const std::string& pdf_path,
-                         CrackResult& result,
-                         unsigned int thread_count) {
-    FilePasswordSource source(wordlist_path);
-    return crack_with_source(source, pdf_path, result, thread_count);
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        std::vector<Claim> claims;
+        {
+            std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+            {
+                ScopedPhaseTimer wait(metrics, MetricPhase::QueueWait);
+                lock.lock();
+            }
+            ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+            std::uint64_t budget = std::max<std::size_t>(max_count, 1);
+            positions = IntervalSet::Range{0, 0};
+            while (budget > 0) {
+                Claim claim;
+                IntervalSet::Range span;
+                if (!claim_locked(budget, claim, span)) {
+                    break;
+                }
+                positions.first = claims.empty() ? span.first : positions.first;
+                positions.second = span.second;
+                budget -= claim.end - claim.begin;
+                claims.push_back(std::move(claim));
+            }
+        }
+        batch.clear();
+        if (claims.empty()) {
+            return false;
+        }
+
+        ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+        TruncationFilter filter(max_length_);
+        std::string candidate;
+        for (const Claim& claim : claims) {
+            for (std::uint64_t index = claim.begin; index < claim.end; ++index) {
+                join(claim.word, index, candidate);
+                if (filter.admit(candidate)) {
+                    batch.push_back(candidate);
+                }
+            }
+        }
+        return true;
+    }
+
+   private:
+    // Elements [begin, end) of `word`.
+    struct Claim {
+        std::string word;
+        std::uint64_t begin = 0;
+        std::uint64_t end = 0;
+    };
+
+    // Hands out up to `budget` candidates of the current word, moving to the
+    // next word when it is used up; `span` receives their positions.
+    bool claim_locked(std::uint64_t budget, Claim& claim, IntervalSet::Range& span) {
+        std::uint64_t count = elements_.size();
+        if (count == 0) {
+            return false;
+        }
+        if (next_element_ >= count) {
+            if (!words_.next(word_, word_position_)) {
+                return false;
+            }
+            next_element_ = 0;
+        }
+        claim.word = word_;
+        claim.begin = next_element_;
+        claim.end = next_element_ + std::min(budget, count - next_element_);
+        span = IntervalSet::Range{word_position_ * count + claim.begin, word_position_ * count + claim.end};
+        next_element_ = claim.end;
+        return true;
+    }
+
+    void join(const std::string& word, std::uint64_t index, std::string& out) const {
+        std::string element;
+        elements_.element(index, element);
+        out = elements_first_ ? element + word : word + element;
+    }
+
+    FilePasswordSource& words_;
+    const ElementSequence& elements_;
+    bool elements_first_ = false;
+    std::size_t max_length_ = 0;
+    std::string word_;                // guarded by mutex_
+    std::uint64_t word_position_ = 0; // guarded by mutex_
+    std::uint64_t next_element_ = 0;  // guarded by mutex_
+    std::mutex mutex_;
+};
+
+// PRINCE chains of the words of a list, read into memory once. Candidate p
+// is rebuilt from p alone, so the lock only hands out position ranges and
+// the workers build their candidates after releasing it.
+class PrincePasswordSource final : public PasswordSource {
+   public:
+    // Candidate length when neither the options nor the revision set one.
+    static constexpr std::size_t kDefaultMaxLength = 32;
+
+    PrincePasswordSource(FilePasswordSource& words,
+                         unlock_pdf::util::PrinceChains& chains,
+                         const WordlistCombination& options)
+        : words_(words), chains_(chains), options_(options) {}
+
+    // Chains never exceed `max_length`, so nothing needs cutting.
+    void prepare(std::size_t max_length) override {
+        words_.prepare(0);
+        std::string word;
+        while (words_.next(word)) {
+            chains_.add(word);
+        }
+        max_length_ = options_.max_length;
+        if (max_length > 0 && (max_length_ == 0 || max_length_ > max_length)) {
+            max_length_ = max_length;
+        }
+        if (max_length_ == 0) {
+            max_length_ = kDefaultMaxLength;
+        }
+        std::string error;
+        if (!chains_.build(options_.min_length, max_length_, options_.chain_elements, error)) {
+            throw std::runtime_error(error);
+        }
+        std::cout << "Chaining up to " << options_.chain_elements << " of " << chains_.words()
+                  << " distinct words along " << chains_.chains() << " chains of " << options_.min_length << " to "
+                  << max_length_ << " bytes" << std::endl;
+        if (chains_.truncated()) {
+            std::cout << "Leaving out the largest chains, which would take the keyspace past 2^64 candidates"
+                      << std::endl;
+        }
+        total_ = chains_.size();
+    }
+
+    bool has_total() const override { return true; }
+    std::size_t total() const override { return static_cast<std::size_t>(total_); }
+
+    std::string coverage_key() const override {
+        std::string words = words_.coverage_key();
+        if (words.empty()) {
+            return std::string();
+        }
+        return "prince:" + words + ":" + std::to_string(options_.chain_elements) + ":" +
+               std::to_string(options_.min_length) + "-" + std::to_string(max_length_);
+    }
+
+    void exclude(const IntervalSet& done) override {
+        excluded_ = done;
+        total_ -= std::min(total_, done.count_within(0, chains_.size()));
+    }
+
+    bool next(std::string& password) override {
+        IntervalSet::Range claim;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!claim_locked(1, claim)) {
+                return false;
+            }
+        }
+        chains_.candidate(claim.first, password);
+        return true;
+    }
+
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        std::vector<IntervalSet::Range> claims;
+        {
+            std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+            {
+                ScopedPhaseTimer wait(metrics, MetricPhase::QueueWait);
+                lock.lock();
+            }
+            std::uint64_t budget = std::max<std::size_t>(max_count, 1);
+            IntervalSet::Range claim;
+            while (budget > 0 && claim_locked(budget, claim)) {
+                budget -= claim.second - claim.first;
+                claims.push_back(claim);
+            }
+        }
+        batch.clear();
+        if (claims.empty()) {
+            return false;
+        }
+
+        ScopedPhaseTimer generation(metrics, MetricPhase::Generation);
+        positions = IntervalSet::Range{claims.front().first, claims.back().second};
+        std::string candidate;
+        for (const IntervalSet::Range& claim : claims) {
+            for (std::uint64_t index = claim.first; index < claim.second; ++index) {
+                chains_.candidate(index, candidate);
+                batch.push_back(candidate);
+            }
+        }
+        return true;
+    }
+
+   private:
+    // Up to `budget` consecutive positions that are not excluded.
+    bool claim_locked(std::uint64_t budget, IntervalSet::Range& claim) {
+        const std::vector<IntervalSet::Range>& ranges = excluded_.ranges();
+        std::uint64_t size = chains_.size();
+        while (next_ < size && cursor_ < ranges.size() && ranges[cursor_].first <= next_) {
+            next_ = std::max(next_, ranges[cursor_].second);
+            ++cursor_;
+        }
+        if (next_ >= size) {
+            return false;
+        }
+        std::uint64_t end = cursor_ < ranges.size() ? std::min(size, ranges[cursor_].first) : size;
+        claim = IntervalSet::Range{next_, next_ + std::min(budget, end - next_)};
+        next_ = claim.second;
+        return true;
+    }
+
+    FilePasswordSource& words_;
+    unlock_pdf::util::PrinceChains& chains_;
+    const WordlistCombination& options_;
+    std::size_t max_length_ = 0;
+    std::uint64_t total_ = 0;
+    IntervalSet excluded_;
+    std::uint64_t next_ = 0;  // guarded by mutex_
+    std::size_t cursor_ = 0;  // into excluded_.ranges(), guarded by mutex_
+    std::mutex mutex_;
+};
+
+// The sources behind one wordlist run, as chosen by the crack options: the
+// words themselves, or the words expanded through rules, joined with a
+// second list or a mask, or chained with each other.
+struct WordlistRun {
+    std::unique_ptr<FilePasswordSource> words;
+    std::unique_ptr<FilePasswordSource> second;              // combinator: the list held in memory
+    std::unique_ptr<ElementSequence> elements;               // joined to each streamed word
+    std::unique_ptr<unlock_pdf::util::PrinceChains> chains;  // PRINCE: the words, held in memory
+    std::unique_ptr<PasswordSource> expanded;                // built on the streamed list, when set
+    FilePasswordSource* streamed = nullptr;                  // the list read word by word during the run
+    std::uint64_t rule_count = 1;
+    const char* mode = "wordlist";
+
+    PasswordSource& source() { return expanded ? *expanded : *words; }
+
+    // Lengths of what each streamed word is combined with; a rule counts as
+    // adding nothing, since its effect depends on the word.
+    std::map<std::size_t, std::uint64_t> element_lengths() const {
+        if (elements) {
+            return elements->length_counts();
+        }
+        return {{0, rule_count}};
+    }
+};
+
+// SessionCoverage::generator_kind() of the run the options ask for, empty
+// when its coverage key is complete before the run starts anyway: PRINCE
+// reads its whole list in prepare().
+std::string wordlist_coverage_kind(const CrackOptions& crack_options) {
+    using Mode = WordlistCombination::Mode;
+    switch (crack_options.combination.mode) {
+        case Mode::None:
+            return crack_options.rules != nullptr && !crack_options.rules->empty() ? "wordlist:rules" : "wordlist";
+        case Mode::Combinator:
+            return "wordlist+wordlist";
+        case Mode::AppendMask:
+            return "wordlist+mask";
+        case Mode::PrependMask:
+            return "mask+wordlist";
+        case Mode::Prince:
+            break;
+    }
+    return std::string();
+}
+
+// `identify` and `count` as for FilePasswordSource; `count` applies to the
+// streamed list. The combinator keeps the smaller file in memory and streams
+// the other.
+WordlistRun open_wordlist_run(const std::string& wordlist_path,
+                              const CrackOptions& crack_options,
+                              bool identify,
+                              bool count) {
+    using Mode = WordlistCombination::Mode;
+    const WordlistCombination& combination = crack_options.combination;
+    WordlistRun run;
+    run.words = std::make_unique<FilePasswordSource>(wordlist_path, identify, count);
+    run.streamed = run.words.get();
+    switch (combination.mode) {
+        case Mode::None:
+            if (crack_options.rules != nullptr && !crack_options.rules->empty()) {
+                run.expanded = std::make_unique<RulePasswordSource>(*run.words, *crack_options.rules);
+                run.rule_count = crack_options.rules->size();
+                run.mode = "rules";
+            }
+            break;
+        case Mode::Combinator: {
+            std::error_code ec;
+            std::uintmax_t left_size = std::filesystem::file_size(wordlist_path, ec);
+            std::uintmax_t right_size = ec ? 0 : std::filesystem::file_size(combination.right_path, ec);
+            bool right_in_memory = ec || right_size <= left_size;
+            const std::string& resident_path = right_in_memory ? combination.right_path : wordlist_path;
+            const std::string& streamed_path = right_in_memory ? wordlist_path : combination.right_path;
+            auto resident = std::make_unique<FilePasswordSource>(resident_path, identify, false);
+            run.words = std::make_unique<FilePasswordSource>(streamed_path, identify, count);
+            run.streamed = run.words.get();
+            resident->prepare(0);
+            run.elements = std::make_unique<WordListElements>(*resident);
+            std::cout << "Keeping '" << resident_path << "' in memory (" << run.elements->size() << " words)"
+                      << std::endl;
+            run.second = std::move(resident);
+            run.expanded = std::make_unique<ProductPasswordSource>(*run.words, *run.elements, !right_in_memory);
+            run.mode = "combinator";
+            break;
+        }
+        case Mode::AppendMask:
+        case Mode::PrependMask:
+            run.elements = std::make_unique<MaskElements>(combination.mask);
+            run.expanded = std::make_unique<ProductPasswordSource>(*run.words, *run.elements,
+                                                                   combination.mode == Mode::PrependMask);
+            run.mode = "hybrid";
+            std::cout << (combination.mode == Mode::PrependMask ? "Prepending" : "Appending") << " the "
+                      << combination.mask.size() << " expansions of mask '" << combination.mask.text()
+                      << "' to each word" << std::endl;
+            break;
+        case Mode::Prince:
+            run.chains = std::make_unique<unlock_pdf::util::PrinceChains>();
+            run.expanded = std::make_unique<PrincePasswordSource>(*run.words, *run.chains, combination);
+            run.mode = "prince";
+            break;
+    }
+    return run;
 }
 
-bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
-                          const std::string& pdf_path,
-                          CrackResult& result,
-                          unsigned int thread_count) {
-    result = CrackResult{};
+// Guesses of a PCFG grammar, most probable first. The priority queue walk is
+// inherently sequential, so it runs on a dedicated producer thread that
+// fills a bounded buffer; verifier threads only take finished candidates
+// from it. Positions number the guesses in generation order, which is fixed
+// for a grammar and length limit, so excluded positions are generated and
+// skipped rather than verified.
+class PcfgPasswordSource final : public PasswordSource {
+   public:
+    static constexpr std::size_t kBufferLimit = std::size_t{1} << 16;
+    static constexpr std::size_t kChunkSize = 256;
+
+    explicit PcfgPasswordSource(const unlock_pdf::util::PcfgGrammar& grammar) : grammar_(grammar) {}
+
+    ~PcfgPasswordSource() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        space_.notify_all();
+        if (producer_.joinable()) {
+            producer_.join();
+        }
+    }
+
+    void prepare(std::size_t max_length) override {
+        max_length_ = max_length;
+        total_ = grammar_.guess_count(max_length);
+        std::cout << "PCFG grammar: " << grammar_.structures().size() << " base structures from "
+                  << grammar_.passwords() << " training passwords" << std::endl;
+        if (total_ > unlock_pdf::util::PcfgGenerator::kDefaultQueueLimit) {
+            std::cout << "The keyspace is an upper bound: the least likely guesses are dropped when more than "
+                      << unlock_pdf::util::PcfgGenerator::kDefaultQueueLimit << " are queued" << std::endl;
+        }
+    }
+
+    // An upper bound once the generator drops queue entries; see prepare().
+    bool has_total() const override { return true; }
+    std::size_t total() const override { return static_cast<std::size_t>(total_); }
+
+    // The grammar's order-relevant contents, the length limit and the queue
+    // limit together fix the sequence.
+    std::string coverage_key() const override {
+        unlock_pdf::crypto::Sha256Context sequence;
+        auto update = [&](const std::string& text, double probability) {
+            std::string line = text + '\t' + std::to_string(probability) + '\n';
+            sequence.update(reinterpret_cast<const unsigned char*>(line.data()), line.size());
+        };
+        for (const auto& structure : grammar_.structures()) {
+            update(structure.text, structure.probability);
+        }
+        for (const auto& terminal_class : grammar_.classes()) {
+            update(terminal_class.name, 0.0);
+            for (const auto& terminal : terminal_class.terminals) {
+                update(terminal.text, terminal.probability);
+            }
+        }
+        unsigned char digest[32];
+        sequence.finalize(digest);
+        std::string key = "pcfg:";
+        key += unlock_pdf::util::to_hex(digest, 8);
+        return key + ":" + std::to_string(max_length_) + ":" +
+               std::to_string(unlock_pdf::util::PcfgGenerator::kDefaultQueueLimit);
+    }
+
+    void exclude(const IntervalSet& done) override {
+        excluded_ = done;
+        total_ -= std::min(total_, done.count_within(0, total_));
+    }
+
+    bool next(std::string& password) override {
+        std::vector<std::string> batch;
+        IntervalSet::Range positions;
+        if (!take(batch, 1, nullptr, positions)) {
+            return false;
+        }
+        password = std::move(batch.front());
+        return true;
+    }
+
+    bool next_batch(std::vector<std::string>& batch,
+                    std::size_t max_count,
+                    ThreadMetrics& metrics,
+                    IntervalSet::Range& positions) override {
+        return take(batch, max_count, &metrics, positions);
+    }
+
+   private:
+    bool take(std::vector<std::string>& batch,
+              std::size_t max_count,
+              ThreadMetrics* metrics,
+              IntervalSet::Range& positions) {
+        std::call_once(started_, [this] { producer_ = std::thread([this] { produce(); }); });
+        batch.clear();
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (metrics != nullptr) {
+            ScopedPhaseTimer wait(*metrics, MetricPhase::QueueWait);
+            ready_.wait(lock, [this] { return !buffer_.empty() || finished_; });
+        } else {
+            ready_.wait(lock, [this] { return !buffer_.empty() || finished_; });
+        }
+        if (buffer_.empty()) {
+            return false;
+        }
+        std::size_t count = std::min(std::max<std::size_t>(max_count, 1), buffer_.size());
+        positions = IntervalSet::Range{buffer_.front().first, buffer_[count - 1].first + 1};
+        for (std::size_t i = 0; i < count; ++i) {
+            batch.push_back(std::move(buffer_.front().second));
+            buffer_.pop_front();
+        }
+        lock.unlock();
+        space_.notify_one();
+        return true;
+    }
+
+    void produce() {
+        unlock_pdf::util::PcfgGenerator generator(grammar_, max_length_);
+        std::vector<std::pair<std::uint64_t, std::string>> chunk;
+        chunk.reserve(kChunkSize);
+        const std::vector<IntervalSet::Range>& ranges = excluded_.ranges();
+        std::size_t cursor = 0;
+        std::uint64_t position = 0;
+        std::string guess;
+        bool more = true;
+        bool warned = false;
+        while (more) {
+            more = generator.next(guess);
+            if (!warned && generator.dropped() > 0) {
+                std::cerr << "Warning: the PCFG queue is full after " << position
+                          << " guesses; dropping its least likely branches, so the run covers only part of the "
+                             "grammar"
+                          << std::endl;
+                warned = true;
+            }
+            if (more) {
+                while (cursor < ranges.size() && ranges[cursor].second <= position) {
+                    ++cursor;
+                }
+                if (cursor == ranges.size() || ranges[cursor].first > position) {
+                    chunk.emplace_back(position, guess);
+                }
+                ++position;
+            }
+            if (chunk.size() < kChunkSize && more) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_.wait(lock, [this] { return buffer_.size() < kBufferLimit || stopping_; });
+            if (stopping_) {
+                break;
+            }
+            for (auto& entry : chunk) {
+                buffer_.push_back(std::move(entry));
+            }
+            chunk.clear();
+            finished_ = !more;
+            lock.unlock();
+            ready_.notify_all();
+        }
+        if (!more && generator.dropped() > 0) {
+            std::cerr << "Warning: the grammar was only partly searched: " << position << " of at most "
+                      << grammar_.guess_count(max_length_) << " guesses were generated and "
+                      << generator.dropped() << " dropped queue entries never expanded" << std::endl;
+        }
+    }
+
+    const unlock_pdf::util::PcfgGrammar& grammar_;
+    std::size_t max_length_ = 0;
+    std::uint64_t total_ = 0;
+    IntervalSet excluded_;
+    std::once_flag started_;
+    std::thread producer_;
+    std::deque<std::pair<std::uint64_t, std::string>> buffer_;  // guarded by mutex_
+    bool finished_ = false;                                     // guarded by mutex_
+    bool stopping_ = false;                                     // guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable ready_;  // candidates in the buffer, or the end
+    std::condition_variable space_;  // room in the buffer, or stop
+};
+
+// Documents attacked together by one run. Targets whose handler inputs are
+// identical share a slot, so each candidate is verified once per distinct
+// document; a solved slot is skipped from then on and the run ends when none
+// is left.
+class TargetSet {
+   public:
+    explicit TargetSet(const std::vector<CrackTarget>& targets) : targets_(targets) {}
+
+    // Adds targets[index]; false when no password handler accepts it.
+    bool add(std::size_t index, const std::vector<EncryptionHandlerPtr>& handlers) {
+        const PDFEncryptInfo& info = targets_[index].info;
+        // The hash record holds what the handlers read, which makes it the
+        // deduplication key; documents it cannot express stay apart. It has
+        // no crypt filter method, so an RC4 and an AESV2 revision 4 document
+        // with equal fields would otherwise share a slot and its variant.
+        std::string key;
+        std::string error;
+        if (format_pdf_hash(info, key, error)) {
+            key += '\t' + info.crypt_filter_method;
+        } else {
+            key = "#" + std::to_string(index);
+        }
+        auto existing = slot_by_key_.find(key);
+        if (existing != slot_by_key_.end()) {
+            slots_[existing->second].members.push_back(index);
+            return true;
+        }
+
+        std::vector<const EncryptionHandler*> password_handlers = collect_password_handlers(info, handlers);
+        if (password_handlers.empty()) {
+            return false;
+        }
+        Slot& slot = slots_.emplace_back();
+        slot.info = &info;
+        slot.members.push_back(index);
+        for (const EncryptionHandler* handler : password_handlers) {
+            auto it = std::find(handlers_.begin(), handlers_.end(), handler);
+            slot.metric_indices.push_back(static_cast<std::size_t>(it - handlers_.begin()));
+            if (it == handlers_.end()) {
+                handlers_.push_back(handler);
+            }
+            slot.handlers.push_back(handler);
+        }
+        slot_by_key_.emplace(std::move(key), slots_.size() - 1);
+        remaining_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool empty() const { return slots_.empty(); }
+    std::size_t size() const { return slots_.size(); }
+    bool done() const { return remaining_.load(std::memory_order_acquire) == 0; }
+
+    // Handlers of all slots without repeats, in first-use order; metrics are
+    // indexed by position in this list.
+    const std::vector<const EncryptionHandler*>& handlers() const { return handlers_; }
+
+    const PDFEncryptInfo& primary() const { return *slots_.front().info; }
+
+    // One document per slot, i.e. per distinct target.
+    std::vector<const PDFEncryptInfo*> documents() const {
+        std::vector<const PDFEncryptInfo*> infos;
+        infos.reserve(slots_.size());
+        for (const Slot& slot : slots_) {
+            infos.push_back(slot.info);
+        }
+        return infos;
+    }
+
+    // The document whose revision uses the longest passwords (an unknown
+    // limit counts as the longest). Truncation and the brute-force length
+    // range follow it so that no target loses candidates.
+    const PDFEncryptInfo& widest() const {
+        const PDFEncryptInfo* widest = slots_.front().info;
+        for (const Slot& slot : slots_) {
+            std::size_t limit = standard_security::max_password_length(slot.info->revision);
+            std::size_t widest_limit = standard_security::max_password_length(widest->revision);
+            if (widest_limit != 0 && (limit == 0 || limit > widest_limit)) {
+                widest = slot.info;
+            }
+        }
+        return *widest;
+    }
+
+    // Verifies `password` against every unsolved slot; true when it solved one.
+    bool check(const std::string& password, std::string& variant, ThreadMetrics& metrics) {
+        bool solved_any = false;
+        for (Slot& slot : slots_) {
+            if (slot.solved.load(std::memory_order_acquire)) {
+                continue;
+            }
+            for (std::size_t i = 0; i < slot.handlers.size(); ++i) {
+                metrics.add_verified(slot.metric_indices[i]);
+                if (slot.handlers[i]->check_password(password, *slot.info, variant)) {
+                    record(slot, password, variant);
+                    solved_any = true;
+                    break;
+                }
+            }
+        }
+        return solved_any;
+    }
+
+    // Writes the outcome of every member of every slot; targets resolved
+    // before the run keep their results.
+    void fill_results(std::vector<CrackResult>& results, std::size_t attempted, std::size_t total) const {
+        if (total == 0 || total < attempted) {
+            total = attempted;
+        }
+        for (const Slot& slot : slots_) {
+            for (std::size_t member : slot.members) {
+                CrackResult& result = results[member];
+                result.passwords_tried = attempted;
+                result.total_passwords = total;
+                result.success = slot.solved.load(std::memory_order_acquire);
+                if (result.success) {
+                    result.password = slot.password;
+                    result.variant = slot.variant;
+                }
+            }
+        }
+    }
+
+   private:
+    struct Slot {
+        const PDFEncryptInfo* info = nullptr;
+        std::vector<const EncryptionHandler*> handlers;
+        std::vector<std::size_t> metric_indices;
+        std::vector<std::size_t> members;  // indices into targets_
+        std::atomic<bool> solved{false};
+        std::string password;  // written once under mutex_ before `solved` is set
+        std::string variant;
+    };
+
+    void record(Slot& slot, const std::string& password, const std::string& variant) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slot.solved.load(std::memory_order_relaxed)) {
+            return;
+        }
+        slot.password = password;
+        slot.variant = variant;
+        slot.solved.store(true, std::memory_order_release);
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+        if (targets_.size() > 1) {
+            for (std::size_t member : slot.members) {
+                std::cout << "\nPASSWORD FOUND [" << variant << "] " << targets_[member].label << ": " << password
+                          << std::endl;
+            }
+        }
+    }
+
+    const std::vector<CrackTarget>& targets_;
+    std::deque<Slot> slots_;
+    std::map<std::string, std::size_t> slot_by_key_;
+    std::vector<const EncryptionHandler*> handlers_;
+    std::atomic<std::size_t> remaining_{0};
+    std::mutex mutex_;
+};
+
+// Answers a target from the potfile when the document itself is on file.
+// Documents not on file get the passwords on file in try_potfile_passwords().
+bool resolve_from_potfile(const std::vector<CrackTarget>& targets,
+                          std::size_t index,
+                          const std::vector<EncryptionHandlerPtr>& handlers,
+                          CrackResult& result,
+                          const CrackOptions& crack_options) {
+    if (crack_options.potfile == nullptr) {
+        return false;
+    }
+    const CrackTarget& target = targets[index];
+    const PotfileEntry* entry = crack_options.potfile->find(target.info);
+    if (entry == nullptr) {
+        return false;
+    }
+    std::string variant;
+    std::vector<const EncryptionHandler*> password_handlers = collect_password_handlers(target.info, handlers);
+    bool opens = std::any_of(password_handlers.begin(), password_handlers.end(), [&](const EncryptionHandler* handler) {
+        return handler->check_password(entry->password, target.info, variant);
+    });
+    if (!opens) {
+        return false;
+    }
+
+    result.success = true;
+    result.password = entry->password;
+    result.variant = variant;
+    result.passwords_tried = 0;
+    std::cout << "\nPASSWORD FOUND [" << variant << "]" << (targets.size() > 1 ? " " + target.label : "") << ": "
+              << result.password << " (potfile)" << std::endl;
+    return true;
+}
+
+// Adds the solved targets to the potfile; documents already on file are
+// left alone. A potfile that cannot be written does not fail the run.
+void record_in_potfile(const std::vector<CrackTarget>& targets,
+                       const std::vector<CrackResult>& results,
+                       const CrackOptions& crack_options) {
+    if (crack_options.potfile == nullptr) {
+        return;
+    }
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        std::string error;
+        if (results[i].success &&
+            !crack_options.potfile->record(targets[i].info, results[i].password, results[i].variant, error)) {
+            std::cerr << "Warning: " << error << std::endl;
+        }
+    }
+}
+
+// Tries every distinct password on file against the unsolved targets of
+// `set`, on the worker threads, before the attack proper. A re-encrypted
+// document or a reused password then costs one pass over the potfile instead
+// of a search. Solved slots drop out of the set.
+void try_potfile_passwords(TargetSet& set, const CrackOptions& crack_options) {
+    if (crack_options.potfile == nullptr || crack_options.potfile->passwords().empty() || set.empty()) {
+        return;
+    }
+    VectorPasswordSource source(crack_options.potfile->passwords());
+    source.prepare(standard_security::max_password_length(set.widest().revision));
+    std::size_t total = source.total();
+    if (total == 0) {
+        return;
+    }
+
+    unsigned int thread_count =
+        crack_options.thread_count > 0 ? crack_options.thread_count : unlock_pdf::util::effective_cpu_count();
+    thread_count = static_cast<unsigned int>(std::max<std::size_t>(std::min<std::size_t>(thread_count, total), 1));
+    std::size_t batch_size =
+        crack_options.batch_size > 0 ? crack_options.batch_size : default_batch_size(set.primary());
+    std::cout << "Trying " << total << " potfile passwords on " << thread_count << " threads" << std::endl;
+
+    auto worker = [&]() {
+        ThreadMetrics metrics;
+        std::vector<std::string> batch;
+        std::string variant;
+        IntervalSet::Range positions;
+        while (!set.done() && source.next_batch(batch, batch_size, metrics, positions)) {
+            for (const auto& password : batch) {
+                if (set.check(password, variant, metrics) && set.done()) {
+                    return;
+                }
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (unsigned int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Resolves targets that need no password search (unprotected or
+// certificate-based documents, or answered by the potfile) and groups the
+// rest into `set`. Returns false when some target has no password handler.
+bool collect_targets(const std::vector<CrackTarget>& targets,
+                     const std::vector<EncryptionHandlerPtr>& handlers,
+                     TargetSet& set,
+                     std::vector<CrackResult>& results,
+                     const CrackOptions& crack_options) {
+    bool all_usable = true;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (handle_non_password_handlers(targets[i].info, results[i], handlers) ||
+            resolve_from_potfile(targets, i, handlers, results[i], crack_options)) {
+            continue;
+        }
+        if (!set.add(i, handlers)) {
+            std::string message = "No password-based handlers are available for the detected encryption.";
+            report_error(crack_options, targets.size() > 1 ? targets[i].label + ": " + message : message);
+            all_usable = false;
+        }
+    }
+    if (targets.size() > 1 && !set.empty()) {
+        std::cout << "\nCracking " << targets.size() << " targets (" << set.size() << " distinct)" << std::endl;
+    }
+    try_potfile_passwords(set, crack_options);
+    return all_usable;
+}
+
+std::string run_label(const std::vector<CrackTarget>& targets) {
+    return targets.size() == 1 ? targets.front().label : std::to_string(targets.size()) + " targets";
+}
+
+// Closing lines of a multi-target run; single runs keep their own wording.
+void print_target_summary(const std::vector<CrackTarget>& targets, const std::vector<CrackResult>& results) {
+    std::size_t solved = 0;
+    for (const CrackResult& result : results) {
+        solved += result.success ? 1 : 0;
+    }
+    std::cout << "Solved " << solved << " of " << targets.size() << " targets" << std::endl;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (!results[i].success) {
+            std::cout << "  not found: " << targets[i].label << std::endl;
+        }
+    }
+}
+
+// Identities of the documents of `set` in the session coverage database;
+// empty when the run keeps no coverage or some document has no identity.
+std::vector<std::string> coverage_documents(const TargetSet& set, const CrackOptions& crack_options) {
+    std::vector<std::string> documents;
+    if (crack_options.coverage == nullptr) {
+        return documents;
+    }
+    for (const PDFEncryptInfo* info : set.documents()) {
+        std::string digest = document_digest(*info);
+        if (digest.empty()) {
+            return std::vector<std::string>();
+        }
+        documents.push_back(std::move(digest));
+    }
+    return documents;
+}
+
+void report_skipped_coverage(const unlock_pdf::util::Keyspace& skipped) {
+    if (!skipped.is_zero()) {
+        std::cout << "Skipping " << skipped.to_string() << " candidates already tested in earlier sessions"
+                  << std::endl;
+    }
+}
+
+// Adds the positions a run exhausted to every document it covered. The
+// database is saved right away, so a later failure loses nothing.
+void record_coverage(const std::vector<std::string>& documents,
+                     const std::string& generator,
+                     const IntervalSet& done,
+                     const CrackOptions& crack_options) {
+    if (documents.empty() || generator.empty() || done.empty()) {
+        return;
+    }
+    for (const std::string& document : documents) {
+        crack_options.coverage->add(document, generator, done);
+    }
+    std::string error;
+    if (!crack_options.coverage->save(error)) {
+        std::cerr << "Warning: " << error << std::endl;
+    }
+}
+
+// Closes a run in which every target was resolved before the search,
+// including the ones the potfile passwords solved in `set`.
+bool finish_resolved_run(const std::vector<CrackTarget>& targets,
+                         const TargetSet& set,
+                         std::vector<CrackResult>& results,
+                         bool usable,
+                         const CrackOptions& crack_options) {
+    set.fill_results(results, 0, 0);
+    if (targets.size() == 1 && !set.empty() && results.front().success) {
+        std::cout << "\nPASSWORD FOUND [" << results.front().variant << "]: " << results.front().password
+                  << " (potfile)" << std::endl;
+    }
+    record_in_potfile(targets, results, crack_options);
+    if (targets.size() > 1) {
+        std::cout << std::endl;
+        print_target_summary(targets, results);
+    }
+    if (usable) {
+        report_outcomes(crack_options, results, 0.0);
+    }
+    return usable;
+}
+
+bool crack_with_source(PasswordSource& source,
+                       const char* mode,
+                       const std::vector<CrackTarget>& targets,
+                       std::vector<CrackResult>& results,
+                       const CrackOptions& crack_options) {
+    results.assign(targets.size(), CrackResult{});
+
+    auto handlers = create_default_encryption_handlers();
+    TargetSet set(targets);
+    bool usable = collect_targets(targets, handlers, set, results, crack_options);
+    if (set.empty() || set.done()) {
+        return finish_resolved_run(targets, set, results, usable, crack_options);
+    }
+
+    source.prepare(standard_security::max_password_length(set.widest().revision));
+    std::vector<std::string> documents = coverage_documents(set, crack_options);
+    std::string generator = source.coverage_key();
+    if (!documents.empty() && !generator.empty()) {
+        IntervalSet done = crack_options.coverage->covered(documents, generator);
+        std::size_t before = source.total();
+        source.exclude(done);
+        report_skipped_coverage(before - source.total());
+    }
+    std::size_t total_passwords = source.has_total() ? source.total() : 0;
+
+    ThreadPlan thread_plan = resolve_thread_plan(crack_options, set.primary(), set.handlers());
+    unsigned int thread_count = thread_plan.thread_count;
+    if (source.has_total()) {
+        std::size_t total = source.total();
+        if (total > 0 && static_cast<std::size_t>(thread_count) > total) {
+            thread_count = static_cast<unsigned int>(total);
+            thread_count = std::max(thread_count, 1u);
+        }
+    }
 
-    if (options.min_length == 0 || options.max_length < options.min_length) {
-        std::cerr << "Error: invalid password length range" << std::endl;
-        return false;
+    std::cout << "\nStarting password cracking with " << thread_count << " threads (batch size "
+              << thread_plan.batch_size << ")" << std::endl;
+    if (source.has_total()) {
+        std::cout << "Keyspace: " << total_passwords << " candidates" << std::endl;
+    }
+    finalize_thread_plan(thread_plan, thread_count);
+
+    if (crack_options.events != nullptr) {
+        StartEvent start;
+        start.pdf_path = run_label(targets);
+        start.mode = mode;
+        start.revision = set.primary().revision;
+        start.threads = thread_count;
+        start.batch_size = thread_plan.batch_size;
+        start.keyspace_known = source.has_total();
+        start.keyspace = static_cast<std::uint64_t>(total_passwords);
+        crack_options.events->start(start);
     }
 
-    std::string alphabet;
-    if (options.use_custom_characters) {
-        if (options.custom_characters.empty()) {
-            std::cerr << "Error: custom characters must not be empty" << std::endl;
-            return false;
+    CrackMetrics metrics(thread_count, handler_names(set.handlers()), crack_options.metrics);
+    ProgressReporter reporter(thread_count,
+                              static_cast<std::uint64_t>(total_passwords),
+                              std::chrono::milliseconds(crack_options.progress_interval_ms));
+    reporter.attach_metrics(&metrics);
+    reporter.attach_events(crack_options.events);
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    // Positions of the batches each thread verified completely.
+    std::vector<IntervalSet> completed(thread_count);
+
+    // Each batch is fetched once and verified against every unsolved target.
+    auto worker = [&](unsigned int thread_index) {
+        apply_thread_placement(thread_plan, thread_index);
+        ThreadCounter& tried = reporter.counter(thread_index);
+        ThreadMetrics& thread_metrics = metrics.thread(thread_index);
+        std::vector<std::string> batch;
+        std::string variant;
+        IntervalSet::Range positions;
+        batch.reserve(thread_plan.batch_size);
+        variant.reserve(64);
+        while (!set.done()) {
+            thread_metrics.begin_unit();
+            if (!source.next_batch(batch, thread_plan.batch_size, thread_metrics, positions)) {
+                break;
+            }
+            thread_metrics.add_generated(batch.size());
+            thread_metrics.add_batch(batch.size(), thread_plan.batch_size);
+
+            ScopedPhaseTimer verification(thread_metrics, MetricPhase::Verification);
+            for (const auto& password : batch) {
+                if (set.done()) {
+                    return;
+                }
+
+                tried.add(1);
+
+                if (set.check(password, variant, thread_metrics) && set.done()) {
+                    return;
+                }
+            }
+            completed[thread_index].add(positions.first, positions.second);
         }
-        alphabet = options.custom_characters;
+    };
+
+    reporter.start();
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (unsigned int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(worker, i);
+    }
+
+    // A streamed list is counted while the workers test it, so the progress
+    // gains its percentage and time left as soon as the count is in.
+    if (!source.has_total() && source.count_total([&set]() { return set.done(); })) {
+        total_passwords = source.total();
+        reporter.set_total(static_cast<std::uint64_t>(total_passwords));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    reporter.stop();
+    IntervalSet done;
+    for (const IntervalSet& thread_done : completed) {
+        done.add(thread_done);
+    }
+    if (generator.empty()) {
+        // A streamed list only knows its identity once it was read to the end.
+        generator = source.coverage_key();
+    }
+    record_coverage(documents, generator, done, crack_options);
+
+    std::size_t attempted = static_cast<std::size_t>(reporter.total_tried());
+    set.fill_results(results, attempted, total_passwords);
+    if (targets.size() == 1 && results.front().success) {
+        std::cout << "\nPASSWORD FOUND [" << results.front().variant << "]: " << results.front().password
+                  << std::endl;
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time);
+    std::cout << "\nFinished in " << duration.count() << " seconds" << std::endl;
+
+    if (targets.size() > 1) {
+        print_target_summary(targets, results);
+    } else if (results.front().success) {
+        std::cout << "Password found: " << results.front().password << std::endl;
     } else {
-        if (options.include_uppercase) {
-            alphabet += "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        std::cout << "Password not found in the provided list" << std::endl;
+    }
+
+    record_in_potfile(targets, results, crack_options);
+    report_outcomes(crack_options, results, std::chrono::duration<double>(end_time - start_time).count());
+    return true;
+}
+
+// Coverage generator of brute force at one length: the alphabet (its order
+// fixes the candidate order) and the length. Positions are indices of the
+// first min(length, 2) characters.
+std::string bruteforce_coverage_key(const std::string& alphabet, std::size_t length) {
+    unsigned char digest[32];
+    unlock_pdf::crypto::sha256_digest(reinterpret_cast<const unsigned char*>(alphabet.data()), alphabet.size(), digest);
+    std::string key = "charset:";
+    key += unlock_pdf::util::to_hex(digest, 8);
+    return key + ":" + std::to_string(length);
+}
+
+// Characters behind the brute-force odometer digits: the alphabet in order,
+// or its Markov order for the position and the previous character.
+class BruteforceSymbols {
+   public:
+    BruteforceSymbols(const std::string& alphabet, const unlock_pdf::util::WordlistOptions& options)
+        : alphabet_(alphabet) {
+        if (options.markov != nullptr) {
+            markov_.emplace(*options.markov, alphabet, options.markov_threshold);
         }
-        if (options.include_lowercase) {
-            alphabet += "abcdefghijklmnopqrstuvwxyz";
+    }
+
+    bool markov() const { return markov_.has_value(); }
+    std::size_t radix() const { return markov_ ? markov_->radix() : alphabet_.size(); }
+
+    char at(std::size_t position, char previous, std::size_t digit) const {
+        return markov_ ? markov_->at(position, static_cast<unsigned char>(previous), digit) : alphabet_[digit];
+    }
+
+    // Markov runs are keyed by their whole order table, so that other
+    // statistics, alphabets or thresholds do not share coverage.
+    std::string coverage_key(std::size_t length) const {
+        if (!markov_) {
+            return bruteforce_coverage_key(alphabet_, length);
         }
-        if (options.include_digits) {
-            alphabet += "0123456789";
+        unsigned char digest[32];
+        const std::string& table = markov_->table();
+        unlock_pdf::crypto::sha256_digest(reinterpret_cast<const unsigned char*>(table.data()), table.size(), digest);
+        std::string key = "markov:";
+        key += unlock_pdf::util::to_hex(digest, 8);
+        return key + ":" + std::to_string(length);
+    }
+
+   private:
+    std::string alphabet_;
+    std::optional<unlock_pdf::util::MarkovOrder> markov_;
+};
+
+// Throughput of the whole thread pool measured at the shortest and longest
+// candidate length; other lengths are interpolated linearly. Key derivation
+// cost only changes with length where the password is hashed unpadded (R5/R6),
+// so two points are enough.
+struct RateCalibration {
+    std::size_t short_length = 1;
+    std::size_t long_length = 1;
+    double short_rate = 0.0;
+    double long_rate = 0.0;
+
+    double rate(std::size_t length) const {
+        if (long_length == short_length || length <= short_length) {
+            return short_rate;
         }
-        if (options.include_special) {
-            alphabet += "!\"#$%&'()*+,-./:;<=>?@[]^_{|}~";
+        if (length >= long_length) {
+            return long_rate;
         }
+        double position =
+            static_cast<double>(length - short_length) / static_cast<double>(long_length - short_length);
+        return short_rate + (long_rate - short_rate) * position;
     }
+};
 
-    if (alphabet.empty()) {
-        std::cerr << "Error: character set is empty" << std::endl;
+constexpr std::size_t kMaxCalibrationLength = 127;
+// Candidates timed by estimates whose own candidates are not at hand; any
+// printable text costs the same to verify.
+constexpr const char* kCalibrationCharset = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+RateCalibration calibrate_rates(const PDFEncryptInfo& info,
+                                const std::vector<const EncryptionHandler*>& handlers,
+                                const std::string& charset,
+                                unsigned int thread_count,
+                                std::size_t min_length,
+                                std::size_t max_length) {
+    RateCalibration calibration;
+    calibration.short_length = std::clamp<std::size_t>(min_length, 1, kMaxCalibrationLength);
+    calibration.long_length = std::clamp<std::size_t>(max_length, calibration.short_length, kMaxCalibrationLength);
+
+    if (calibration.short_length == calibration.long_length) {
+        calibration.short_rate = run_handler_benchmark_timed(calibration.short_length,
+                                                             charset,
+                                                             info,
+                                                             handlers,
+                                                             thread_count,
+                                                             std::chrono::milliseconds(2000))
+                                     .attempts_per_second;
+        calibration.long_rate = calibration.short_rate;
+        return calibration;
+    }
+    for (std::size_t length : {calibration.short_length, calibration.long_length}) {
+        double rate =
+            run_handler_benchmark_timed(length, charset, info, handlers, thread_count, std::chrono::milliseconds(1000))
+                .attempts_per_second;
+        (length == calibration.short_length ? calibration.short_rate : calibration.long_rate) = rate;
+    }
+    return calibration;
+}
+
+void fill_estimate(const std::map<std::size_t, unlock_pdf::util::Keyspace>& candidates_by_length,
+                   const RateCalibration& calibration,
+                   CrackEstimate& estimate) {
+    for (const auto& [length, candidates] : candidates_by_length) {
+        LengthEstimate entry;
+        entry.length = length;
+        entry.candidates = candidates;
+        entry.rate = calibration.rate(length);
+        entry.seconds = entry.rate > 0.0 ? candidates.to_double() / entry.rate : -1.0;
+        estimate.total += candidates;
+        if (entry.seconds >= 0.0 && estimate.seconds >= 0.0) {
+            estimate.seconds += entry.seconds;
+        } else {
+            estimate.seconds = -1.0;
+        }
+        estimate.lengths.push_back(entry);
+    }
+}
+
+// Compact up to a day, then days, then years; beyond a million years only the
+// order of magnitude matters.
+std::string format_expected_time(double seconds) {
+    constexpr double kDay = 86400.0;
+    constexpr double kYear = 365.25 * kDay;
+
+    std::ostringstream oss;
+    if (seconds < 0.0) {
+        return "unknown";
+    }
+    if (seconds < 60.0) {
+        oss << std::fixed << std::setprecision(1) << seconds << " s";
+    } else if (seconds < kDay) {
+        auto total = static_cast<std::uint64_t>(seconds + 0.5);
+        oss << std::setfill('0') << std::setw(2) << total / 3600 << ':' << std::setw(2) << (total / 60) % 60 << ':'
+            << std::setw(2) << total % 60;
+    } else if (seconds < kYear) {
+        oss << std::fixed << std::setprecision(1) << seconds / kDay << " days";
+    } else if (seconds < 1e6 * kYear) {
+        oss << std::fixed << std::setprecision(1) << seconds / kYear << " years";
+    } else {
+        oss << std::scientific << std::setprecision(1) << seconds / kYear << " years";
+    }
+    return oss.str();
+}
+
+void print_estimate(const CrackEstimate& estimate) {
+    std::cout << "\nEstimated with " << estimate.thread_count << " threads:\n"
+              << std::left << std::setw(8) << "Length" << std::right << std::setw(28) << "Candidates"
+              << std::setw(14) << "Rate/s" << std::setw(20) << "Expected time" << '\n';
+    for (const auto& entry : estimate.lengths) {
+        std::cout << std::left << std::setw(8) << entry.length << std::right << std::setw(28)
+                  << entry.candidates.to_string() << std::setw(14) << static_cast<std::uint64_t>(entry.rate)
+                  << std::setw(20) << format_expected_time(entry.seconds) << '\n';
+    }
+    std::cout << std::left << std::setw(8) << "Total" << std::right << std::setw(28) << estimate.total.to_string()
+              << std::setw(14) << "" << std::setw(20) << format_expected_time(estimate.seconds) << std::endl;
+}
+
+// Shared preamble of the estimate modes: picks the handlers and thread count a
+// real run would use.
+bool prepare_estimate(const PDFEncryptInfo& info,
+                      const CrackOptions& crack_options,
+                      std::vector<EncryptionHandlerPtr>& handlers,
+                      std::vector<const EncryptionHandler*>& password_handlers,
+                      CrackEstimate& estimate) {
+    handlers = create_default_encryption_handlers();
+    password_handlers = collect_password_handlers(info, handlers);
+    if (password_handlers.empty()) {
+        report_error(crack_options, "No password-based handlers are available for the detected encryption.");
         return false;
     }
+    estimate.thread_count = resolve_thread_plan(crack_options, info, password_handlers).thread_count;
+    std::cout << "\nCalibrating with " << estimate.thread_count << " threads..." << std::endl;
+    return true;
+}
+
+}  // namespace
 
-    PDFEncryptInfo encrypt_info;
-    if (!read_pdf_encrypt_info(pdf_path, encrypt_info)) {
+bool load_crack_target(const std::string& pdf_path, CrackTarget& target, const CrackOptions& crack_options) {
+    target = CrackTarget{};
+    target.label = pdf_path;
+    if (!read_pdf_encrypt_info(pdf_path, target.info, crack_options.verbose)) {
+        report_unreadable_pdf(crack_options, pdf_path);
         return false;
     }
+    return true;
+}
 
-    auto handlers = create_default_encryption_handlers();
-    if (handle_non_password_handlers(encrypt_info, result, handlers)) {
-        return true;
+bool crack_pdf(const std::vector<std::string>& passwords,
+               const std::string& pdf_path,
+               CrackResult& result,
+               const CrackOptions& crack_options) {
+    result = CrackResult{};
+    if (passwords.empty()) {
+        report_error(crack_options, "password list is empty");
+        return false;
     }
 
-    std::vector<const EncryptionHandler*> password_handlers = collect_password_handlers(encrypt_info, handlers);
-    if (password_handlers.empty()) {
-        std::cerr << "Error: No password-based handlers are available for the detected encryption." << std::endl;
+    std::vector<CrackTarget> targets(1);
+    if (!load_crack_target(pdf_path, targets.front(), crack_options)) {
         return false;
     }
+    VectorPasswordSource source(passwords);
+    std::vector<CrackResult> results;
+    bool ran = crack_with_source(source, "list", targets, results, crack_options);
+    result = results.front();
+    return ran;
+}
 
-    if (thread_count == 0) {
-        thread_count = std::thread::hardware_concurrency();
-        if (thread_count == 0) {
-            thread_count = 2;
-        }
+bool crack_pdf_from_file(const std::string& wordlist_path,
+                         const std::string& pdf_path,
+                         CrackResult& result,
+                         const CrackOptions& crack_options) {
+    result = CrackResult{};
+    CrackTarget target;
+    if (!load_crack_target(pdf_path, target, crack_options)) {
+        return false;
+    }
+    return crack_pdf_from_file(wordlist_path, target, result, crack_options);
+}
+
+bool crack_pdf_from_file(const std::string& wordlist_path,
+                         const CrackTarget& target,
+                         CrackResult& result,
+                         const CrackOptions& crack_options) {
+    std::vector<CrackResult> results;
+    bool ran = crack_targets_from_file(wordlist_path, {target}, results, crack_options);
+    result = results.front();
+    return ran;
+}
+
+bool crack_targets_from_file(const std::string& wordlist_path,
+                             const std::vector<CrackTarget>& targets,
+                             std::vector<CrackResult>& results,
+                             const CrackOptions& crack_options) {
+    // Counting the list before the run only pays off when earlier sessions
+    // left candidates to skip; otherwise the workers start on the stream
+    // right away and the list is counted alongside them.
+    bool identify = crack_options.coverage != nullptr;
+    std::string kind = identify ? wordlist_coverage_kind(crack_options) : std::string();
+    bool count = !kind.empty() && std::any_of(targets.begin(), targets.end(), [&](const CrackTarget& target) {
+                     return crack_options.coverage->has_records(document_digest(target.info), kind);
+                 });
+    WordlistRun run = open_wordlist_run(wordlist_path, crack_options, identify, count);
+    return crack_with_source(run.source(), run.mode, targets, results, crack_options);
+}
+
+bool crack_targets_pcfg(const unlock_pdf::util::PcfgGrammar& grammar,
+                        const std::vector<CrackTarget>& targets,
+                        std::vector<CrackResult>& results,
+                        const CrackOptions& crack_options) {
+    if (grammar.empty()) {
+        results.assign(targets.size(), CrackResult{});
+        report_error(crack_options, "PCFG grammar has no structures");
+        return false;
+    }
+    PcfgPasswordSource source(grammar);
+    return crack_with_source(source, "pcfg", targets, results, crack_options);
+}
+
+bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                          const std::string& pdf_path,
+                          CrackResult& result,
+                          const CrackOptions& crack_options) {
+    result = CrackResult{};
+    if (options.min_length == 0 || options.max_length < options.min_length) {
+        report_error(crack_options, "invalid password length range");
+        return false;
+    }
+    CrackTarget target;
+    if (!load_crack_target(pdf_path, target, crack_options)) {
+        return false;
+    }
+    return crack_pdf_bruteforce(options, target, result, crack_options);
+}
+
+bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                          const CrackTarget& target,
+                          CrackResult& result,
+                          const CrackOptions& crack_options) {
+    std::vector<CrackResult> results;
+    bool ran = crack_targets_bruteforce(options, {target}, results, crack_options);
+    result = results.empty() ? CrackResult{} : results.front();
+    return ran;
+}
+
+bool crack_targets_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                              const std::vector<CrackTarget>& targets,
+                              std::vector<CrackResult>& results,
+                              const CrackOptions& crack_options) {
+    results.assign(targets.size(), CrackResult{});
+
+    if (options.min_length == 0 || options.max_length < options.min_length) {
+        report_error(crack_options, "invalid password length range");
+        return false;
+    }
+
+    std::string alphabet = bruteforce_alphabet(options, crack_options);
+    if (alphabet.empty()) {
+        return false;
+    }
+    BruteforceSymbols symbols(alphabet, options);
+    std::size_t radix = symbols.radix();
+
+    auto handlers = create_default_encryption_handlers();
+    TargetSet set(targets);
+    bool usable = collect_targets(targets, handlers, set, results, crack_options);
+    if (set.empty() || set.done()) {
+        return finish_resolved_run(targets, set, results, usable, crack_options);
     }
-    thread_count = std::max(thread_count, 1u);
+
+    std::size_t min_length = options.min_length;
+    std::size_t max_length = options.max_length;
+    clamp_length_range(set.widest(), min_length, max_length);
+
+    ThreadPlan thread_plan = resolve_thread_plan(crack_options, set.primary(), set.handlers());
+    unsigned int thread_count = thread_plan.thread_count;
 
     std::cout << "\nStarting brute-force password search with " << thread_count << " threads" << std::endl;
+    if (symbols.markov()) {
+        std::cout << "Markov order from " << options.markov->words() << " training words, " << radix << " of "
+                  << alphabet.size() << " characters per position" << std::endl;
+    }
+    finalize_thread_plan(thread_plan, thread_count);
 
     struct Task {
         std::string prefix;
         std::size_t target_length = 0;
+        IntervalSet::Range units;  // coverage positions, see bruteforce_coverage_key()
     };
 
     std::vector<Task> tasks;
-    std::size_t base_prefix_length = std::min<std::size_t>(options.min_length, static_cast<std::size_t>(2));
+    std::size_t base_prefix_length = std::min<std::size_t>(min_length, static_cast<std::size_t>(2));
     if (base_prefix_length == 0) {
         base_prefix_length = 1;
     }
 
+    // Coverage is kept per length in units of the first min(length, 2)
+    // characters, which every task prefix maps onto whatever the minimum
+    // length of the run that wrote it.
+    std::vector<std::string> documents = coverage_documents(set, crack_options);
+    unlock_pdf::util::Keyspace skipped;
     std::string current_prefix;
     auto add_tasks_for_length = [&](std::size_t length) {
         std::size_t prefix_length = std::min<std::size_t>(length, base_prefix_length);
-        current_prefix.clear();
-        current_prefix.reserve(prefix_length);
-        if (prefix_length == 0) {
-            tasks.push_back(Task{std::string(), length});
-            return;
+        std::size_t unit_length = std::min<std::size_t>(length, 2);
+        using unlock_pdf::util::keyspace_power;
+        std::uint64_t units_per_task = keyspace_power(radix, unit_length - prefix_length).low();
+        unlock_pdf::util::Keyspace task_candidates = keyspace_power(radix, length - prefix_length);
+        IntervalSet done;
+        if (!documents.empty()) {
+            done = crack_options.coverage->covered(documents, symbols.coverage_key(length));
         }
 
+        current_prefix.clear();
+        current_prefix.reserve(prefix_length);
+        std::uint64_t prefix_index = 0;
         std::vector<std::size_t> indices(prefix_length, 0);
         while (true) {
             current_prefix.resize(prefix_length);
             for (std::size_t i = 0; i < prefix_length; ++i) {
-                current_prefix[i] = alphabet[indices[i]];
+                current_prefix[i] = symbols.at(i, i == 0 ? '\0' : current_prefix[i - 1], indices[i]);
             }
-            tasks.push_back(Task{current_prefix, length});
+            IntervalSet::Range units{prefix_index * units_per_task, (prefix_index + 1) * units_per_task};
+            if (done.covers(units.first, units.second)) {
+                skipped += task_candidates;
+            } else {
+                tasks.push_back(Task{current_prefix, length, units});
+            }
+            ++prefix_index;
 
             std::size_t pos = prefix_length;
             while (pos > 0) {
                 --pos;
-                if (++indices[pos] < alphabet.size()) {
+                if (++indices[pos] < radix) {
                     break;
                 }
                 indices[pos] = 0;
@@ -482,102 +2336,295 @@ bool crack_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
         }
     };
 
-    for (std::size_t length = options.min_length; length <= options.max_length; ++length) {
+    for (std::size_t length = min_length; length <= max_length; ++length) {
         add_tasks_for_length(length);
     }
 
-    std::atomic<bool> password_found{false};
-    std::atomic<std::size_t> passwords_tried{0};
-    std::mutex result_mutex;
-    std::string found_password;
-    std::string found_variant;
+    unlock_pdf::util::Keyspace keyspace =
+        unlock_pdf::util::charset_keyspace(radix, min_length, max_length).saturating_sub(skipped);
+    report_skipped_coverage(skipped);
+    std::cout << "Keyspace: " << keyspace.to_string() << " candidates" << std::endl;
+    if (crack_options.events != nullptr) {
+        StartEvent start;
+        start.pdf_path = run_label(targets);
+        start.mode = "bruteforce";
+        start.revision = set.primary().revision;
+        start.threads = thread_count;
+        start.batch_size = 1;
+        start.keyspace_known = true;
+        start.keyspace = keyspace;
+        crack_options.events->start(start);
+    }
+
+    CrackMetrics metrics(thread_count, handler_names(set.handlers()), crack_options.metrics);
+    ProgressReporter reporter(thread_count,
+                              keyspace,
+                              std::chrono::milliseconds(crack_options.progress_interval_ms));
+    reporter.attach_metrics(&metrics);
+    reporter.attach_events(crack_options.events);
 
-    auto worker = [&](const Task& task) {
+    // Brute force has no batches: every candidate is its own work unit for
+    // the sampled phase timers. Returns true when the task was exhausted.
+    auto worker = [&](const Task& task, ThreadCounter& tried, ThreadMetrics& thread_metrics) {
         std::size_t total_positions = task.target_length - task.prefix.size();
         if (total_positions == 0) {
             std::string variant;
-            if (check_password_variants(task.prefix, encrypt_info, password_handlers, variant)) {
-                std::lock_guard<std::mutex> lock(result_mutex);
-                if (!password_found) {
-                    password_found = true;
-                    found_password = task.prefix;
-                    found_variant = variant;
-                    std::cout << "\nPASSWORD FOUND [" << variant << "]: " << task.prefix << std::endl;
-                }
-            }
-            ++passwords_tried;
-            return;
+            thread_metrics.begin_unit();
+            thread_metrics.add_generated(1);
+            set.check(task.prefix, variant, thread_metrics);
+            tried.add(1);
+            return true;
         }
 
         std::vector<std::size_t> indices(total_positions, 0);
         std::string candidate = task.prefix;
         candidate.resize(task.target_length);
+        std::string variant;
 
-        while (!password_found.load()) {
-            for (std::size_t i = 0; i < total_positions; ++i) {
-                candidate[task.prefix.size() + i] = alphabet[indices[i]];
-            }
-
-            std::string variant;
-            if (check_password_variants(candidate, encrypt_info, password_handlers, variant)) {
-                std::lock_guard<std::mutex> lock(result_mutex);
-                if (!password_found) {
-                    password_found = true;
-                    found_password = candidate;
-                    found_variant = variant;
-                    std::cout << "\nPASSWORD FOUND [" << variant << "]: " << candidate << std::endl;
+        while (!set.done()) {
+            thread_metrics.begin_unit();
+            {
+                ScopedPhaseTimer generation(thread_metrics, MetricPhase::Generation);
+                for (std::size_t i = 0, position = task.prefix.size(); i < total_positions; ++i, ++position) {
+                    candidate[position] = symbols.at(position, position == 0 ? '\0' : candidate[position - 1],
+                                                     indices[i]);
                 }
-                break;
             }
+            thread_metrics.add_generated(1);
 
-            std::size_t tried = ++passwords_tried;
-            if (tried % 1000 == 0) {
-                print_progress(tried, 0);
+            bool matched = false;
+            {
+                ScopedPhaseTimer verification(thread_metrics, MetricPhase::Verification);
+                matched = set.check(candidate, variant, thread_metrics);
+            }
+            if (matched && set.done()) {
+                return false;
             }
 
+            tried.add(1);
+
             std::size_t pos = total_positions;
             while (pos > 0) {
                 --pos;
-                if (++indices[pos] < alphabet.size()) {
+                if (++indices[pos] < radix) {
                     break;
                 }
                 indices[pos] = 0;
             }
             if (pos == 0 && indices[0] == 0) {
-                break;
+                return true;
             }
         }
+        return false;
     };
 
     std::vector<std::thread> threads;
     std::atomic<std::size_t> task_index{0};
-    auto thread_worker = [&]() {
-        while (!password_found.load()) {
-            std::size_t index = task_index.fetch_add(1);
+    std::vector<std::vector<std::size_t>> completed(thread_count);
+    auto thread_worker = [&](unsigned int thread_index) {
+        apply_thread_placement(thread_plan, thread_index);
+        ThreadCounter& tried = reporter.counter(thread_index);
+        ThreadMetrics& thread_metrics = metrics.thread(thread_index);
+        while (!set.done()) {
+            std::size_t index = task_index.fetch_add(1, std::memory_order_relaxed);
             if (index >= tasks.size()) {
                 break;
             }
-            worker(tasks[index]);
+            if (worker(tasks[index], tried, thread_metrics)) {
+                completed[thread_index].push_back(index);
+            }
         }
     };
 
+    auto start_time = std::chrono::steady_clock::now();
+    reporter.start();
     for (unsigned int i = 0; i < thread_count; ++i) {
-        threads.emplace_back(thread_worker);
+        threads.emplace_back(thread_worker, i);
     }
     for (auto& thread : threads) {
         thread.join();
     }
+    reporter.stop();
+
+    std::map<std::size_t, IntervalSet> done_by_length;
+    for (const std::vector<std::size_t>& thread_completed : completed) {
+        for (std::size_t index : thread_completed) {
+            done_by_length[tasks[index].target_length].add(tasks[index].units.first, tasks[index].units.second);
+        }
+    }
+    for (const auto& [length, done] : done_by_length) {
+        record_coverage(documents, symbols.coverage_key(length), done, crack_options);
+    }
 
-    result.passwords_tried = passwords_tried.load();
-    result.success = password_found.load();
-    if (result.success) {
-        result.password = found_password;
-        result.variant = found_variant;
-        std::cout << "Password found: " << found_password << std::endl;
+    set.fill_results(results, static_cast<std::size_t>(reporter.total_tried()), 0);
+    if (targets.size() > 1) {
+        std::cout << std::endl;
+        print_target_summary(targets, results);
+    } else if (results.front().success) {
+        std::cout << "\nPASSWORD FOUND [" << results.front().variant << "]: " << results.front().password
+                  << std::endl;
+        std::cout << "Password found: " << results.front().password << std::endl;
     } else {
         std::cout << "Password not found with brute-force search" << std::endl;
     }
 
+    record_in_potfile(targets, results, crack_options);
+    report_outcomes(crack_options,
+                    results,
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count());
+    return true;
+}
+
+bool estimate_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                             const std::string& pdf_path,
+                             CrackEstimate& estimate,
+                             const CrackOptions& crack_options) {
+    estimate = CrackEstimate{};
+    if (options.min_length == 0 || options.max_length < options.min_length) {
+        report_error(crack_options, "invalid password length range");
+        return false;
+    }
+    CrackTarget target;
+    if (!load_crack_target(pdf_path, target, crack_options)) {
+        return false;
+    }
+    return estimate_pdf_bruteforce(options, target, estimate, crack_options);
+}
+
+bool estimate_pdf_bruteforce(const unlock_pdf::util::WordlistOptions& options,
+                             const CrackTarget& target,
+                             CrackEstimate& estimate,
+                             const CrackOptions& crack_options) {
+    estimate = CrackEstimate{};
+    if (options.min_length == 0 || options.max_length < options.min_length) {
+        report_error(crack_options, "invalid password length range");
+        return false;
+    }
+    std::string alphabet = bruteforce_alphabet(options, crack_options);
+    if (alphabet.empty()) {
+        return false;
+    }
+
+    const PDFEncryptInfo& info = target.info;
+    std::vector<EncryptionHandlerPtr> handlers;
+    std::vector<const EncryptionHandler*> password_handlers;
+    if (!prepare_estimate(info, crack_options, handlers, password_handlers, estimate)) {
+        return false;
+    }
+
+    std::size_t min_length = options.min_length;
+    std::size_t max_length = options.max_length;
+    clamp_length_range(info, min_length, max_length);
+
+    std::size_t radix = BruteforceSymbols(alphabet, options).radix();
+    std::map<std::size_t, unlock_pdf::util::Keyspace> candidates_by_length;
+    for (std::size_t length = min_length; length <= max_length; ++length) {
+        candidates_by_length[length] = unlock_pdf::util::keyspace_power(radix, length);
+    }
+    RateCalibration calibration = calibrate_rates(
+        info, password_handlers, alphabet, estimate.thread_count, min_length, max_length);
+    fill_estimate(candidates_by_length, calibration, estimate);
+    print_estimate(estimate);
+    return true;
+}
+
+bool estimate_pdf_from_file(const std::string& wordlist_path,
+                            const std::string& pdf_path,
+                            CrackEstimate& estimate,
+                            const CrackOptions& crack_options) {
+    estimate = CrackEstimate{};
+    CrackTarget target;
+    if (!load_crack_target(pdf_path, target, crack_options)) {
+        return false;
+    }
+    return estimate_pdf_from_file(wordlist_path, target, estimate, crack_options);
+}
+
+bool estimate_pdf_from_file(const std::string& wordlist_path,
+                            const CrackTarget& target,
+                            CrackEstimate& estimate,
+                            const CrackOptions& crack_options) {
+    estimate = CrackEstimate{};
+    WordlistRun run = open_wordlist_run(wordlist_path, crack_options, false, true);
+
+    const PDFEncryptInfo& info = target.info;
+    std::vector<EncryptionHandlerPtr> handlers;
+    std::vector<const EncryptionHandler*> password_handlers;
+    if (!prepare_estimate(info, crack_options, handlers, password_handlers, estimate)) {
+        return false;
+    }
+
+    std::size_t max_length = standard_security::max_password_length(info.revision);
+    run.source().prepare(max_length);
+    std::map<std::size_t, std::uint64_t> element_lengths = run.element_lengths();
+    if (run.streamed->length_counts().empty() || element_lengths.empty()) {
+        report_error(crack_options, "wordlist contains no candidates");
+        return false;
+    }
+
+    // Every streamed word stands for one candidate per element or rule;
+    // PRINCE chains know their own lengths.
+    std::map<std::size_t, unlock_pdf::util::Keyspace> candidates_by_length;
+    if (run.chains) {
+        for (const auto& [length, count] : run.chains->length_counts()) {
+            candidates_by_length[length] = unlock_pdf::util::Keyspace(count);
+        }
+    } else {
+        for (const auto& [word_length, word_count] : run.streamed->length_counts()) {
+            for (const auto& [element_length, element_count] : element_lengths) {
+                std::size_t length = word_length + element_length;
+                if (max_length > 0) {
+                    length = std::min(length, max_length);
+                }
+                candidates_by_length[length] += unlock_pdf::util::Keyspace(word_count) * element_count;
+            }
+        }
+    }
+    RateCalibration calibration = calibrate_rates(info,
+                                                  password_handlers,
+                                                  kCalibrationCharset,
+                                                  estimate.thread_count,
+                                                  candidates_by_length.begin()->first,
+                                                  candidates_by_length.rbegin()->first);
+    fill_estimate(candidates_by_length, calibration, estimate);
+    print_estimate(estimate);
+    return true;
+}
+
+bool estimate_pdf_pcfg(const unlock_pdf::util::PcfgGrammar& grammar,
+                       const CrackTarget& target,
+                       CrackEstimate& estimate,
+                       const CrackOptions& crack_options) {
+    estimate = CrackEstimate{};
+    const PDFEncryptInfo& info = target.info;
+    std::vector<EncryptionHandlerPtr> handlers;
+    std::vector<const EncryptionHandler*> password_handlers;
+    if (!prepare_estimate(info, crack_options, handlers, password_handlers, estimate)) {
+        return false;
+    }
+
+    std::map<std::size_t, unlock_pdf::util::Keyspace> candidates_by_length;
+    for (const auto& [length, count] : grammar.guess_lengths(standard_security::max_password_length(info.revision))) {
+        candidates_by_length[length] = unlock_pdf::util::Keyspace(count);
+    }
+    if (candidates_by_length.empty()) {
+        report_error(crack_options, "PCFG grammar produces no candidates");
+        return false;
+    }
+    RateCalibration calibration = calibrate_rates(info,
+                                                  password_handlers,
+                                                  kCalibrationCharset,
+                                                  estimate.thread_count,
+                                                  candidates_by_length.begin()->first,
+                                                  candidates_by_length.rbegin()->first);
+    fill_estimate(candidates_by_length, calibration, estimate);
+    print_estimate(estimate);
+    // The queue never holds more entries than guesses remain, so only larger
+    // grammars can lose guesses to the cap.
+    if (unlock_pdf::util::Keyspace(unlock_pdf::util::PcfgGenerator::kDefaultQueueLimit) < estimate.total) {
+        std::cout << "Upper bound: a run drops the least likely guesses when more than "
+                  << unlock_pdf::util::PcfgGenerator::kDefaultQueueLimit << " are queued" << std::endl;
+    }
     return true;
 }
 
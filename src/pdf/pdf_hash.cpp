@@ -0,0 +1,228 @@
+#include "pdf/pdf_hash.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "crypto/sha2.h"
+#include "pdf/pdf_parser.h"
+#include "util/hex.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+constexpr const char* kHashPrefix = "$pdf$";
+// V, R, Length, P, EncryptMetadata, then length/hex pairs for ID, U and O.
+constexpr std::size_t kBaseFieldCount = 11;
+// The same followed by OE, UE and Perms.
+constexpr std::size_t kExtendedFieldCount = 17;
+
+void append_hex_field(std::ostringstream& out, const std::vector<unsigned char>& bytes) {
+    out << '*' << bytes.size() << '*' << unlock_pdf::util::to_hex(bytes);
+}
+
+bool parse_integer(const std::string& text, long long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    std::size_t consumed = 0;
+    try {
+        value = std::stoll(text, &consumed);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return consumed == text.size();
+}
+
+int hex_digit(char ch) {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1;
+}
+
+bool parse_hex_field(const std::string& length_text,
+                     const std::string& hex,
+                     const char* name,
+                     std::vector<unsigned char>& bytes,
+                     std::string& error) {
+    long long length = 0;
+    if (!parse_integer(length_text, length) || length < 0 ||
+        hex.size() != static_cast<std::size_t>(length) * 2) {
+        error = std::string("bad ") + name + " field";
+        return false;
+    }
+    bytes.clear();
+    bytes.reserve(static_cast<std::size_t>(length));
+    for (std::size_t i = 0; i < hex.size(); i += 2) {
+        int high = hex_digit(hex[i]);
+        int low = hex_digit(hex[i + 1]);
+        if (high < 0 || low < 0) {
+            error = std::string("bad hex in ") + name + " field";
+            return false;
+        }
+        bytes.push_back(static_cast<unsigned char>((high << 4) | low));
+    }
+    return true;
+}
+
+}  // namespace
+
+bool format_pdf_hash(const PDFEncryptInfo& info, std::string& record, std::string& error) {
+    if (!info.encrypted) {
+        error = "document is not encrypted";
+        return false;
+    }
+    if (info.has_recipients || (!info.filter.empty() && info.filter != "Standard")) {
+        error = "only the Standard security handler can be written as a hash";
+        return false;
+    }
+    if (info.revision < 2 || info.revision > 6) {
+        error = "unsupported security handler revision " + std::to_string(info.revision);
+        return false;
+    }
+
+    std::ostringstream out;
+    out << kHashPrefix << info.version << '*' << info.revision << '*' << describe_encryption(info).key_length
+        << '*' << info.permissions << '*' << (info.encrypt_metadata ? 1 : 0);
+    append_hex_field(out, info.id);
+    append_hex_field(out, info.u_string);
+    append_hex_field(out, info.o_string);
+    if (info.revision >= 5) {
+        append_hex_field(out, info.oe_string);
+        append_hex_field(out, info.ue_string);
+        append_hex_field(out, info.perms);
+    }
+    record = out.str();
+    return true;
+}
+
+bool parse_pdf_hash(const std::string& line, CrackTarget& target, std::string& error) {
+    std::size_t start = line.find(kHashPrefix);
+    if (start == std::string::npos) {
+        error = "not a $pdf$ record";
+        return false;
+    }
+    target = CrackTarget{};
+    target.label = line.substr(0, start);
+    if (!target.label.empty() && target.label.back() == ':') {
+        target.label.pop_back();
+    }
+
+    std::vector<std::string> fields;
+    std::istringstream body(line.substr(start + std::char_traits<char>::length(kHashPrefix)));
+    std::string field;
+    // getline drops the empty field after a trailing '*', which some
+    // pdf2john versions write.
+    while (std::getline(body, field, '*')) {
+        fields.push_back(field);
+    }
+    if (fields.size() != kBaseFieldCount && fields.size() != kExtendedFieldCount) {
+        error = "expected " + std::to_string(kBaseFieldCount) + " or " + std::to_string(kExtendedFieldCount) +
+                " fields, found " + std::to_string(fields.size());
+        return false;
+    }
+
+    PDFEncryptInfo& info = target.info;
+    long long version = 0;
+    long long revision = 0;
+    long long length = 0;
+    long long permissions = 0;
+    long long encrypt_metadata = 0;
+    if (!parse_integer(fields[0], version) || !parse_integer(fields[1], revision) ||
+        !parse_integer(fields[2], length) || !parse_integer(fields[3], permissions) ||
+        !parse_integer(fields[4], encrypt_metadata)) {
+        error = "bad numeric field";
+        return false;
+    }
+    if (revision < 2 || revision > 6 || length < 0 || length > 256 ||
+        permissions < std::numeric_limits<std::int32_t>::min() ||
+        permissions > std::numeric_limits<std::uint32_t>::max()) {
+        error = "field out of range";
+        return false;
+    }
+    info.version = static_cast<int>(version);
+    info.revision = static_cast<int>(revision);
+    info.length = static_cast<int>(length);
+    // Some writers print /P as an unsigned 32-bit value.
+    info.permissions = static_cast<int>(static_cast<std::int32_t>(static_cast<std::uint32_t>(permissions)));
+    info.encrypt_metadata = encrypt_metadata != 0;
+
+    if (!parse_hex_field(fields[5], fields[6], "ID", info.id, error) ||
+        !parse_hex_field(fields[7], fields[8], "U", info.u_string, error) ||
+        !parse_hex_field(fields[9], fields[10], "O", info.o_string, error)) {
+        return false;
+    }
+    if (fields.size() == kExtendedFieldCount &&
+        (!parse_hex_field(fields[11], fields[12], "OE", info.oe_string, error) ||
+         !parse_hex_field(fields[13], fields[14], "UE", info.ue_string, error) ||
+         !parse_hex_field(fields[15], fields[16], "Perms", info.perms, error))) {
+        return false;
+    }
+
+    info.filter = "Standard";
+    info.encrypted = true;
+    return true;
+}
+
+bool load_pdf_hash_file(const std::string& path, std::vector<CrackTarget>& targets, std::string& error) {
+    std::ifstream input(path);
+    if (!input) {
+        error = "cannot open hash file '" + path + "'";
+        return false;
+    }
+
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(input, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        CrackTarget target;
+        std::string line_error;
+        if (!parse_pdf_hash(line, target, line_error)) {
+            error = path + ":" + std::to_string(line_number) + ": " + line_error;
+            return false;
+        }
+        if (target.label.empty()) {
+            target.label = path + ":" + std::to_string(line_number);
+        }
+        targets.push_back(std::move(target));
+    }
+    if (input.bad()) {
+        error = "cannot read hash file '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+std::string document_digest(const PDFEncryptInfo& info) {
+    std::string record;
+    std::string error;
+    if (!format_pdf_hash(info, record, error)) {
+        return std::string();
+    }
+    std::size_t end = 0;
+    for (std::size_t fields = 0; fields < kBaseFieldCount && end != std::string::npos; ++fields) {
+        end = record.find('*', end + 1);
+    }
+    record.resize(std::min(end, record.size()));
+
+    unsigned char digest[32];
+    unlock_pdf::crypto::sha256_digest(reinterpret_cast<const unsigned char*>(record.data()), record.size(), digest);
+    return unlock_pdf::util::to_hex(digest, sizeof(digest));
+}
+
+}  // namespace unlock_pdf::pdf
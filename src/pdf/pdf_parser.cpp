@@ -1,12 +1,13 @@
 #include "pdf/pdf_parser.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstdint>
-#include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <iterator>
+#include <optional>
+#include <set>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -14,10 +15,14 @@
 #include <unordered_map>
 #include <cstring>
 
+#include "pdf/structure_index.h"
+#include "util/inflate.h"
+#include "util/mapped_file.h"
+
 namespace unlock_pdf::pdf {
 namespace {
 
-void skip_whitespace_and_comments(const std::string& data, std::size_t& pos) {
+void skip_whitespace_and_comments(std::string_view data, std::size_t& pos) {
     while (pos < data.size()) {
         unsigned char ch = static_cast<unsigned char>(data[pos]);
         if (std::isspace(ch)) {
@@ -57,7 +62,7 @@ std::string make_printable_truncated(std::string_view text, std::size_t max_leng
     return trimmed;
 }
 
-bool parse_pdf_boolean(const std::string& data, std::size_t& pos, bool& value) {
+bool parse_pdf_boolean(std::string_view data, std::size_t& pos, bool& value) {
     skip_whitespace_and_comments(data, pos);
     if (pos + 4 <= data.size() && data.compare(pos, 4, "true") == 0) {
         pos += 4;
@@ -72,7 +77,7 @@ bool parse_pdf_boolean(const std::string& data, std::size_t& pos, bool& value) {
     return false;
 }
 
-int parse_pdf_int(const std::string& data, std::size_t& pos) {
+int parse_pdf_int(std::string_view data, std::size_t& pos) {
     skip_whitespace_and_comments(data, pos);
     if (pos >= data.size()) {
         return 0;
@@ -107,7 +112,7 @@ int hex_value(char ch) {
     return -1;
 }
 
-std::string parse_pdf_name(const std::string& data, std::size_t& pos) {
+std::string parse_pdf_name(std::string_view data, std::size_t& pos) {
     std::string name;
     while (pos < data.size()) {
         char ch = data[pos];
@@ -134,7 +139,7 @@ std::string parse_pdf_name(const std::string& data, std::size_t& pos) {
     return name;
 }
 
-std::vector<unsigned char> parse_pdf_hex_string(const std::string& data, std::size_t& pos) {
+std::vector<unsigned char> parse_pdf_hex_string(std::string_view data, std::size_t& pos) {
     std::vector<unsigned char> result;
     if (pos >= data.size() || data[pos] != '<') {
         return result;
@@ -171,7 +176,7 @@ std::vector<unsigned char> parse_pdf_hex_string(const std::string& data, std::si
     return result;
 }
 
-std::vector<unsigned char> parse_pdf_literal_string(const std::string& data, std::size_t& pos) {
+std::vector<unsigned char> parse_pdf_literal_string(std::string_view data, std::size_t& pos) {
     std::vector<unsigned char> result;
     if (pos >= data.size() || data[pos] != '(') {
         return result;
@@ -237,7 +242,7 @@ std::vector<unsigned char> parse_pdf_literal_string(const std::string& data, std
     return result;
 }
 
-std::vector<unsigned char> parse_pdf_string_object(const std::string& data, std::size_t& pos) {
+std::vector<unsigned char> parse_pdf_string_object(std::string_view data, std::size_t& pos) {
     if (pos >= data.size()) {
         return {};
     }
@@ -259,7 +264,7 @@ std::vector<unsigned char> parse_pdf_string_object(const std::string& data, std:
     return {};
 }
 
-std::size_t find_dictionary_end(const std::string& data, std::size_t start) {
+std::size_t find_dictionary_end(std::string_view data, std::size_t start) {
     int depth = 0;
     std::size_t pos = start;
     while (pos + 1 < data.size()) {
@@ -308,33 +313,670 @@ std::size_t find_dictionary_end(const std::string& data, std::size_t start) {
     return std::string::npos;
 }
 
-std::vector<unsigned char> extract_document_id(const std::string& data) {
-    std::size_t pos = data.find("/ID");
-    if (pos == std::string::npos) {
-        return {};
+// Moves `position` past the object that starts there, never beyond `limit`.
+void skip_pdf_object(std::string_view data, std::size_t& position, std::size_t limit) {
+    skip_whitespace_and_comments(data, position);
+    if (position >= limit) {
+        return;
     }
-    pos += 3;
+    if (data[position] == '<') {
+        if (position + 1 < data.size() && data[position + 1] == '<') {
+            std::size_t nested_end = find_dictionary_end(data, position);
+            if (nested_end == std::string::npos || nested_end > limit) {
+                position = limit;
+            } else {
+                position = nested_end;
+            }
+        } else {
+            parse_pdf_hex_string(data, position);
+        }
+        return;
+    }
+    if (data[position] == '(') {
+        parse_pdf_literal_string(data, position);
+        return;
+    }
+    if (data[position] == '[') {
+        ++position;
+        int depth = 1;
+        while (position < limit && depth > 0) {
+            skip_whitespace_and_comments(data, position);
+            if (position >= limit) {
+                break;
+            }
+            char token = data[position];
+            if (token == '[') {
+                ++depth;
+                ++position;
+            } else if (token == ']') {
+                --depth;
+                ++position;
+            } else if (token == '(') {
+                parse_pdf_literal_string(data, position);
+            } else if (token == '<') {
+                if (position + 1 < data.size() && data[position + 1] == '<') {
+                    std::size_t nested_end = find_dictionary_end(data, position);
+                    if (nested_end == std::string::npos || nested_end > limit) {
+                        position = limit;
+                    } else {
+                        position = nested_end;
+                    }
+                } else {
+                    parse_pdf_hex_string(data, position);
+                }
+            } else {
+                ++position;
+            }
+        }
+        return;
+    }
+    while (position < limit && !std::isspace(static_cast<unsigned char>(data[position])) &&
+           data[position] != '/') {
+        ++position;
+    }
+}
+
+// Scan-mode /ID: the entry written last belongs to the newest trailer, so it
+// wins, matching the cross-reference path.
+std::vector<unsigned char> extract_document_id(std::string_view data, const StructureIndex& index) {
+    const std::vector<std::size_t>& ids = index.occurrences(StructureKeyword::ID);
+    for (auto it = ids.rbegin(); it != ids.rend(); ++it) {
+        std::size_t value = *it + 3;
+        skip_whitespace_and_comments(data, value);
+        if (value < data.size() && data[value] == '[') {
+            ++value;
+            skip_whitespace_and_comments(data, value);
+            return parse_pdf_string_object(data, value);
+        }
+    }
+    return {};
+}
+
+enum class EncryptLookup { Found, NotEncrypted, Failed };
+
+// Byte range of a dictionary, including its << and >> delimiters.
+struct DictionaryRange {
+    std::size_t start = std::string::npos;
+    std::size_t end = std::string::npos;
+};
+
+// startxref must appear near the end of the file; PDF 32000-1 7.5.5 allows
+// for trailing garbage, so a generous window is searched.
+constexpr std::size_t kStartxrefWindow = 1024;
+// Classic cross-reference entries are exactly 20 bytes: "nnnnnnnnnn ggggg n\r\n".
+constexpr std::size_t kXrefEntrySize = 20;
+
+bool has_keyword(std::string_view data, std::size_t pos, std::string_view keyword) {
+    return pos <= data.size() && data.substr(pos, keyword.size()) == keyword;
+}
+
+// Non-negative integer wide enough for offsets in files beyond 2 GB.
+bool parse_pdf_offset(std::string_view data, std::size_t& pos, std::uint64_t& value) {
     skip_whitespace_and_comments(data, pos);
+    if (pos >= data.size() || !std::isdigit(static_cast<unsigned char>(data[pos]))) {
+        return false;
+    }
+    value = 0;
+    while (pos < data.size() && std::isdigit(static_cast<unsigned char>(data[pos]))) {
+        value = value * 10 + static_cast<std::uint64_t>(data[pos] - '0');
+        ++pos;
+    }
+    return true;
+}
+
+struct XrefSubsection {
+    std::uint64_t first = 0;
+    std::uint64_t count = 0;
+    std::size_t entries = 0;  // file offset of the first entry, or first row for streams
+};
+
+enum class XrefEntryType { Absent, Free, InUse, Compressed };
+
+// One cross-reference section. Classic tables are read in place; streams are
+// decoded into fixed-width rows. `trailer` is the trailer dictionary, which
+// for a cross-reference stream is the stream dictionary itself.
+struct XrefSection {
+    std::vector<XrefSubsection> subsections;
+    bool is_stream = false;
+    std::array<std::size_t, 3> widths{};
+    std::vector<unsigned char> rows;
+    DictionaryRange trailer;
+};
+
+// Trailer entries of interest. Merged over an update chain, the newest
+// section that defines a key wins.
+struct TrailerEntries {
+    bool has_encrypt = false;
+    bool encrypt_is_reference = false;
+    std::uint64_t encrypt_number = 0;
+    std::uint64_t encrypt_generation = 0;
+    DictionaryRange encrypt_dictionary;
+    bool has_id = false;
+    std::vector<unsigned char> id;
+    bool has_prev = false;
+    std::uint64_t prev = 0;
+    bool has_xref_stream = false;
+    std::uint64_t xref_stream = 0;
+};
+
+// Decoded cross-reference streams larger than this are treated as corrupt.
+constexpr std::size_t kMaxXrefStreamSize = 256u << 20;
+
+// Calls visit(key, pos) for every entry of the dictionary with `pos` at the
+// value. A visitor that consumes the value returns true with `pos` moved past
+// it; otherwise the value is skipped.
+template <typename Visitor>
+void for_each_dictionary_entry(std::string_view data, const DictionaryRange& range, Visitor&& visit) {
+    std::size_t pos = range.start + 2;
+    std::size_t end = range.end - 2;
+    while (pos < end) {
+        skip_whitespace_and_comments(data, pos);
+        if (pos >= end) {
+            break;
+        }
+        if (data[pos] != '/') {
+            ++pos;
+            continue;
+        }
+        ++pos;
+        std::string key = parse_pdf_name(data, pos);
+        skip_whitespace_and_comments(data, pos);
+        std::size_t value_pos = pos;
+        if (visit(key, value_pos)) {
+            pos = value_pos;
+        } else {
+            skip_pdf_object(data, pos, end);
+        }
+    }
+}
+
+// "number generation R".
+bool parse_reference(std::string_view data, std::size_t& pos, std::uint64_t& number, std::uint64_t& generation) {
+    if (!parse_pdf_offset(data, pos, number) || !parse_pdf_offset(data, pos, generation)) {
+        return false;
+    }
+    skip_whitespace_and_comments(data, pos);
+    if (pos >= data.size() || data[pos] != 'R') {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+bool parse_offset_array(std::string_view data, std::size_t& pos, std::vector<std::uint64_t>& values) {
     if (pos >= data.size() || data[pos] != '[') {
-        return {};
+        return false;
     }
     ++pos;
-    skip_whitespace_and_comments(data, pos);
-    if (pos >= data.size()) {
-        return {};
+    values.clear();
+    while (true) {
+        skip_whitespace_and_comments(data, pos);
+        if (pos < data.size() && data[pos] == ']') {
+            ++pos;
+            return true;
+        }
+        std::uint64_t value = 0;
+        if (!parse_pdf_offset(data, pos, value)) {
+            return false;
+        }
+        values.push_back(value);
     }
-    return parse_pdf_string_object(data, pos);
 }
 
-bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
-    std::size_t encrypt_pos = std::string::npos;
-    std::size_t search_pos = 0;
+bool read_trailer(std::string_view data, const DictionaryRange& range, TrailerEntries& entries) {
+    bool valid = true;
+    for_each_dictionary_entry(data, range, [&](const std::string& key, std::size_t& pos) {
+        if (key == "Encrypt") {
+            entries.has_encrypt = true;
+            if (has_keyword(data, pos, "<<")) {
+                entries.encrypt_dictionary.start = pos;
+                entries.encrypt_dictionary.end = find_dictionary_end(data, pos);
+                valid = valid && entries.encrypt_dictionary.end != std::string::npos;
+                return false;
+            }
+            entries.encrypt_is_reference = true;
+            valid = valid && parse_reference(data, pos, entries.encrypt_number, entries.encrypt_generation);
+            return true;
+        }
+        if (key == "ID" && pos < data.size() && data[pos] == '[') {
+            ++pos;
+            skip_whitespace_and_comments(data, pos);
+            entries.has_id = true;
+            entries.id = parse_pdf_string_object(data, pos);
+            return false;
+        }
+        if (key == "Prev") {
+            entries.has_prev = parse_pdf_offset(data, pos, entries.prev);
+            return entries.has_prev;
+        }
+        if (key == "XRefStm") {
+            entries.has_xref_stream = parse_pdf_offset(data, pos, entries.xref_stream);
+            return entries.has_xref_stream;
+        }
+        return false;
+    });
+    return valid;
+}
+
+void merge_trailer(TrailerEntries& merged, const TrailerEntries& older) {
+    if (!merged.has_encrypt && older.has_encrypt) {
+        merged.has_encrypt = true;
+        merged.encrypt_is_reference = older.encrypt_is_reference;
+        merged.encrypt_number = older.encrypt_number;
+        merged.encrypt_generation = older.encrypt_generation;
+        merged.encrypt_dictionary = older.encrypt_dictionary;
+    }
+    if (!merged.has_id && older.has_id) {
+        merged.has_id = true;
+        merged.id = older.id;
+    }
+}
+
+bool find_startxref(std::string_view data, std::uint64_t& offset) {
+    std::size_t window_start = data.size() > kStartxrefWindow ? data.size() - kStartxrefWindow : 0;
+    std::size_t keyword = data.substr(window_start).rfind("startxref");
+    if (keyword == std::string::npos) {
+        return false;
+    }
+    std::size_t pos = window_start + keyword + 9;
+    return parse_pdf_offset(data, pos, offset) && offset < data.size();
+}
+
+// Reads the subsection headers without parsing the entries in between: with
+// fixed-size entries the next header is found by arithmetic, so only the
+// pages holding headers and the trailer are touched.
+bool read_xref_table(std::string_view data, std::size_t pos, XrefSection& section) {
+    pos += 4;
     while (true) {
-        std::size_t candidate = data.find("/Encrypt", search_pos);
-        if (candidate == std::string::npos) {
+        skip_whitespace_and_comments(data, pos);
+        if (has_keyword(data, pos, "trailer")) {
+            pos += 7;
+            break;
+        }
+        XrefSubsection subsection;
+        if (!parse_pdf_offset(data, pos, subsection.first) || !parse_pdf_offset(data, pos, subsection.count)) {
+            return false;
+        }
+        skip_whitespace_and_comments(data, pos);
+        subsection.entries = pos;
+        if (subsection.count > (data.size() - pos) / kXrefEntrySize) {
+            return false;
+        }
+        pos += static_cast<std::size_t>(subsection.count) * kXrefEntrySize;
+        section.subsections.push_back(subsection);
+    }
+
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "<<")) {
+        return false;
+    }
+    section.trailer.start = pos;
+    section.trailer.end = find_dictionary_end(data, pos);
+    return section.trailer.end != std::string::npos;
+}
+
+// Cross-reference stream (PDF 32000-1 7.5.8): an object whose dictionary is
+// the trailer and whose data, usually Flate-compressed with a PNG predictor,
+// holds rows of big-endian fields sized by /W.
+bool read_xref_stream(std::string_view data, std::size_t pos, XrefSection& section, std::ostream& out) {
+    std::uint64_t number = 0;
+    std::uint64_t generation = 0;
+    if (!parse_pdf_offset(data, pos, number) || !parse_pdf_offset(data, pos, generation)) {
+        return false;
+    }
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "obj")) {
+        return false;
+    }
+    pos += 3;
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "<<")) {
+        return false;
+    }
+    section.trailer.start = pos;
+    section.trailer.end = find_dictionary_end(data, pos);
+    if (section.trailer.end == std::string::npos) {
+        return false;
+    }
+
+    bool is_xref = false;
+    bool flate = false;
+    bool valid = true;
+    std::uint64_t size = 0;
+    std::uint64_t length = 0;
+    bool has_length = false;
+    std::vector<std::uint64_t> widths;
+    std::vector<std::uint64_t> index;
+    std::uint64_t predictor = 1;
+    std::uint64_t colors = 1;
+    std::uint64_t bits_per_component = 8;
+    std::uint64_t columns = 1;
+
+    auto read_decode_parms = [&](std::size_t& value_pos) {
+        if (value_pos < data.size() && data[value_pos] == '[') {
+            ++value_pos;
+            skip_whitespace_and_comments(data, value_pos);
+        }
+        if (!has_keyword(data, value_pos, "<<")) {
+            return;
+        }
+        DictionaryRange parms{value_pos, find_dictionary_end(data, value_pos)};
+        if (parms.end == std::string::npos) {
+            valid = false;
+            return;
+        }
+        for_each_dictionary_entry(data, parms, [&](const std::string& key, std::size_t& parm_pos) {
+            if (key == "Predictor") {
+                return parse_pdf_offset(data, parm_pos, predictor);
+            }
+            if (key == "Colors") {
+                return parse_pdf_offset(data, parm_pos, colors);
+            }
+            if (key == "BitsPerComponent") {
+                return parse_pdf_offset(data, parm_pos, bits_per_component);
+            }
+            if (key == "Columns") {
+                return parse_pdf_offset(data, parm_pos, columns);
+            }
+            return false;
+        });
+    };
+
+    for_each_dictionary_entry(data, section.trailer, [&](const std::string& key, std::size_t& value_pos) {
+        if (key == "Type") {
+            if (value_pos < data.size() && data[value_pos] == '/') {
+                ++value_pos;
+                is_xref = parse_pdf_name(data, value_pos) == "XRef";
+                return true;
+            }
+        } else if (key == "Size") {
+            return parse_pdf_offset(data, value_pos, size);
+        } else if (key == "Length") {
+            // Must be direct: an indirect length would need this very table.
+            has_length = parse_pdf_offset(data, value_pos, length);
+            return has_length;
+        } else if (key == "W") {
+            valid = valid && parse_offset_array(data, value_pos, widths);
+            return true;
+        } else if (key == "Index") {
+            valid = valid && parse_offset_array(data, value_pos, index);
+            return true;
+        } else if (key == "Filter") {
+            std::size_t filter_pos = value_pos;
+            if (filter_pos < data.size() && data[filter_pos] == '[') {
+                ++filter_pos;
+                skip_whitespace_and_comments(data, filter_pos);
+            }
+            if (filter_pos < data.size() && data[filter_pos] == '/') {
+                ++filter_pos;
+                std::string filter = parse_pdf_name(data, filter_pos);
+                flate = filter == "FlateDecode" || filter == "Fl";
+                valid = valid && flate;
+            }
+        } else if (key == "DecodeParms" || key == "DP") {
+            read_decode_parms(value_pos);
+        }
+        return false;
+    });
+
+    if (!valid || !is_xref || !has_length || widths.size() != 3 || index.size() % 2 != 0) {
+        return false;
+    }
+    if (index.empty()) {
+        index = {0, size};
+    }
+
+    pos = section.trailer.end;
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "stream")) {
+        return false;
+    }
+    pos += 6;
+    if (pos < data.size() && data[pos] == '\r') {
+        ++pos;
+    }
+    if (pos < data.size() && data[pos] == '\n') {
+        ++pos;
+    }
+    if (length > data.size() - pos) {
+        return false;
+    }
+    std::string_view encoded = data.substr(pos, static_cast<std::size_t>(length));
+
+    std::string error;
+    if (flate) {
+        std::vector<unsigned char> inflated;
+        if (!unlock_pdf::util::inflate_zlib(encoded, inflated, kMaxXrefStreamSize, error)) {
+            out << "Cannot decode cross-reference stream: " << error << std::endl;
+            return false;
+        }
+        if (predictor >= 10) {
+            if (!unlock_pdf::util::undo_png_predictor(inflated,
+                                                      static_cast<std::size_t>(colors),
+                                                      static_cast<std::size_t>(bits_per_component),
+                                                      static_cast<std::size_t>(columns),
+                                                      section.rows,
+                                                      error)) {
+                out << "Cannot decode cross-reference stream: " << error << std::endl;
+                return false;
+            }
+        } else if (predictor == 1) {
+            section.rows = std::move(inflated);
+        } else {
+            out << "Unsupported cross-reference stream predictor " << predictor << std::endl;
+            return false;
+        }
+    } else {
+        section.rows.assign(encoded.begin(), encoded.end());
+    }
+
+    std::size_t row_size = 0;
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (widths[i] > 8) {
+            return false;
+        }
+        section.widths[i] = static_cast<std::size_t>(widths[i]);
+        row_size += section.widths[i];
+    }
+    if (row_size == 0) {
+        return false;
+    }
+    std::uint64_t available_rows = section.rows.size() / row_size;
+    std::uint64_t row = 0;
+    for (std::size_t i = 0; i < index.size(); i += 2) {
+        XrefSubsection subsection;
+        subsection.first = index[i];
+        subsection.count = std::min(index[i + 1], available_rows - std::min(row, available_rows));
+        subsection.entries = static_cast<std::size_t>(row);
+        row += subsection.count;
+        section.subsections.push_back(subsection);
+    }
+    section.is_stream = true;
+    return true;
+}
+
+bool read_xref_section(std::string_view data, std::uint64_t offset, XrefSection& section, std::ostream& out) {
+    std::size_t pos = static_cast<std::size_t>(offset);
+    if (has_keyword(data, pos, "xref")) {
+        return read_xref_table(data, pos, section);
+    }
+    return read_xref_stream(data, pos, section, out);
+}
+
+// Walks startxref and the /Prev chain, newest section first, merging the
+// trailers so that the newest definition of each key wins. A hybrid file's
+// /XRefStm section is consulted right after the table that points to it. A
+// section seen before ends the walk, so /Prev loops cannot hang the parser;
+// a broken older section only truncates the chain.
+bool read_xref_chain(std::string_view data,
+                     std::uint64_t startxref,
+                     std::vector<XrefSection>& chain,
+                     TrailerEntries& trailer,
+                     std::ostream& out) {
+    std::set<std::uint64_t> visited;
+    std::uint64_t offset = startxref;
+    while (visited.insert(offset).second) {
+        XrefSection section;
+        TrailerEntries entries;
+        if (!read_xref_section(data, offset, section, out) || !read_trailer(data, section.trailer, entries)) {
+            return !chain.empty();
+        }
+        merge_trailer(trailer, entries);
+        bool is_table = !section.is_stream;
+        chain.push_back(std::move(section));
+
+        if (is_table && entries.has_xref_stream && entries.xref_stream < data.size() &&
+            visited.insert(entries.xref_stream).second) {
+            XrefSection hybrid;
+            if (read_xref_stream(data, static_cast<std::size_t>(entries.xref_stream), hybrid, out)) {
+                chain.push_back(std::move(hybrid));
+            }
+        }
+        if (!entries.has_prev || entries.prev >= data.size()) {
             break;
         }
+        offset = entries.prev;
+    }
+    return true;
+}
+
+std::uint64_t read_big_endian(const unsigned char* field, std::size_t width) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+        value = (value << 8) | field[i];
+    }
+    return value;
+}
 
+// What `section` says about object `number`; `offset` is set for in-use
+// objects.
+XrefEntryType lookup_object(std::string_view data,
+                            const XrefSection& section,
+                            std::uint64_t number,
+                            std::size_t& offset) {
+    for (const auto& subsection : section.subsections) {
+        if (number < subsection.first || number - subsection.first >= subsection.count) {
+            continue;
+        }
+        std::uint64_t object_offset = 0;
+        if (section.is_stream) {
+            std::size_t row_size = section.widths[0] + section.widths[1] + section.widths[2];
+            const unsigned char* row =
+                section.rows.data() + (subsection.entries + static_cast<std::size_t>(number - subsection.first)) * row_size;
+            // A zero-width type field means every entry is type 1.
+            std::uint64_t type = section.widths[0] == 0 ? 1 : read_big_endian(row, section.widths[0]);
+            object_offset = read_big_endian(row + section.widths[0], section.widths[1]);
+            if (type == 0) {
+                return XrefEntryType::Free;
+            }
+            if (type == 2) {
+                return XrefEntryType::Compressed;
+            }
+            if (type != 1) {
+                return XrefEntryType::Absent;
+            }
+        } else {
+            std::size_t pos = subsection.entries + static_cast<std::size_t>(number - subsection.first) * kXrefEntrySize;
+            std::uint64_t generation = 0;
+            if (!parse_pdf_offset(data, pos, object_offset) || !parse_pdf_offset(data, pos, generation)) {
+                return XrefEntryType::Absent;
+            }
+            skip_whitespace_and_comments(data, pos);
+            if (pos < data.size() && data[pos] == 'f') {
+                return XrefEntryType::Free;
+            }
+            if (pos >= data.size() || data[pos] != 'n') {
+                return XrefEntryType::Absent;
+            }
+        }
+        if (object_offset >= data.size()) {
+            return XrefEntryType::Absent;
+        }
+        offset = static_cast<std::size_t>(object_offset);
+        return XrefEntryType::InUse;
+    }
+    return XrefEntryType::Absent;
+}
+
+// Dictionary of the object "number generation obj" starting at `offset`.
+bool object_dictionary_at(std::string_view data,
+                          std::size_t offset,
+                          std::uint64_t number,
+                          std::uint64_t generation,
+                          DictionaryRange& range) {
+    std::size_t pos = offset;
+    std::uint64_t found_number = 0;
+    std::uint64_t found_generation = 0;
+    if (!parse_pdf_offset(data, pos, found_number) || !parse_pdf_offset(data, pos, found_generation) ||
+        found_number != number || found_generation != generation) {
+        return false;
+    }
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "obj")) {
+        return false;
+    }
+    pos += 3;
+    skip_whitespace_and_comments(data, pos);
+    if (!has_keyword(data, pos, "<<")) {
+        return false;
+    }
+    range.start = pos;
+    range.end = find_dictionary_end(data, pos);
+    return range.end != std::string::npos;
+}
+
+// Tail-first lookup: startxref -> cross-reference chain (tables or streams)
+// -> merged trailer -> /Encrypt object. Failed means the cross-reference data
+// cannot be used and the caller should scan instead.
+EncryptLookup locate_encrypt_by_xref(std::string_view data,
+                                     DictionaryRange& range,
+                                     std::vector<unsigned char>& document_id,
+                                     std::ostream& out) {
+    std::uint64_t startxref = 0;
+    std::vector<XrefSection> chain;
+    TrailerEntries trailer;
+    if (!find_startxref(data, startxref) || !read_xref_chain(data, startxref, chain, trailer, out)) {
+        return EncryptLookup::Failed;
+    }
+
+    document_id = trailer.id;
+    if (!trailer.has_encrypt) {
+        return EncryptLookup::NotEncrypted;
+    }
+    if (!trailer.encrypt_is_reference) {
+        out << "Found direct /Encrypt dictionary in the trailer" << std::endl;
+        range = trailer.encrypt_dictionary;
+        return EncryptLookup::Found;
+    }
+
+    out << "Found /Encrypt reference to object " << trailer.encrypt_number << " "
+        << trailer.encrypt_generation << std::endl;
+    // The newest section that mentions the object decides; the encryption
+    // dictionary may not live in an object stream.
+    for (const auto& section : chain) {
+        std::size_t offset = 0;
+        XrefEntryType type = lookup_object(data, section, trailer.encrypt_number, offset);
+        if (type == XrefEntryType::Absent) {
+            continue;
+        }
+        if (type == XrefEntryType::InUse &&
+            object_dictionary_at(data, offset, trailer.encrypt_number, trailer.encrypt_generation, range)) {
+            return EncryptLookup::Found;
+        }
+        return EncryptLookup::Failed;
+    }
+    return EncryptLookup::Failed;
+}
+
+// Fallback for documents whose cross-reference data is missing or unusable:
+// takes the first /Encrypt entry from the structure index and looks up its
+// object there.
+EncryptLookup locate_encrypt_by_scan(std::string_view data,
+                                     const StructureIndex& index,
+                                     DictionaryRange& range,
+                                     std::ostream& out) {
+    std::size_t encrypt_pos = std::string::npos;
+    for (std::size_t candidate : index.occurrences(StructureKeyword::Encrypt)) {
         std::size_t after_token = candidate + 8; // length of "/Encrypt"
         if (after_token >= data.size()) {
             break;
@@ -345,22 +987,17 @@ bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
             encrypt_pos = candidate;
             break;
         }
-
-        search_pos = candidate + 8;
     }
 
     if (encrypt_pos == std::string::npos) {
-        std::cout << "No /Encrypt dictionary found" << std::endl;
-        info = PDFEncryptInfo{};
-        info.encrypted = false;
-        return true;
+        return EncryptLookup::NotEncrypted;
     }
 
     std::size_t pos = encrypt_pos + 8;
     skip_whitespace_and_comments(data, pos);
     if (pos >= data.size() || !std::isdigit(static_cast<unsigned char>(data[pos]))) {
-        std::cout << "Failed to parse /Encrypt reference" << std::endl;
-        return false;
+        out << "Failed to parse /Encrypt reference" << std::endl;
+        return EncryptLookup::Failed;
     }
 
     int obj_num = parse_pdf_int(data, pos);
@@ -370,94 +1007,39 @@ bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
         gen_num = parse_pdf_int(data, pos);
     }
 
-    std::cout << "Found /Encrypt reference to object " << obj_num << " " << gen_num << std::endl;
+    out << "Found /Encrypt reference to object " << obj_num << " " << gen_num << std::endl;
 
-    std::string obj_marker = std::to_string(obj_num) + " " + std::to_string(gen_num) + " obj";
-    std::size_t obj_pos = data.find(obj_marker);
+    std::size_t obj_pos = index.find_object(static_cast<std::uint64_t>(obj_num), static_cast<std::uint64_t>(gen_num));
     if (obj_pos == std::string::npos) {
-        std::cout << "Could not locate encryption object" << std::endl;
-        return false;
+        out << "Could not locate encryption object" << std::endl;
+        return EncryptLookup::Failed;
     }
 
-    std::size_t dict_start = data.find("<<", obj_pos);
-    if (dict_start == std::string::npos) {
-        std::cout << "Encryption object does not contain a dictionary" << std::endl;
-        return false;
+    range.start = data.find("<<", obj_pos);
+    if (range.start == std::string::npos) {
+        out << "Encryption object does not contain a dictionary" << std::endl;
+        return EncryptLookup::Failed;
     }
-    std::size_t dict_end = find_dictionary_end(data, dict_start);
-    if (dict_end == std::string::npos) {
-        std::cout << "Failed to parse encryption dictionary" << std::endl;
-        return false;
+    range.end = find_dictionary_end(data, range.start);
+    if (range.end == std::string::npos) {
+        out << "Failed to parse encryption dictionary" << std::endl;
+        return EncryptLookup::Failed;
     }
+    return EncryptLookup::Found;
+}
 
-    std::cout << "Found encryption object. Content:" << std::endl;
-    std::string_view dict_view(data.c_str() + dict_start, dict_end - dict_start);
-    std::cout << make_printable_truncated(dict_view, 200) << std::endl;
+bool parse_encryption_dictionary(std::string_view data,
+                                 const DictionaryRange& range,
+                                 PDFEncryptInfo& info,
+                                 std::ostream& out) {
+    std::size_t dict_start = range.start;
+    std::size_t dict_end = range.end;
+    out << "Found encryption object. Content:" << std::endl;
+    std::string_view dict_view = data.substr(dict_start, dict_end - dict_start);
+    out << make_printable_truncated(dict_view, 200) << std::endl;
 
     std::unordered_map<std::string, std::string> crypt_filter_methods;
 
-    auto skip_pdf_object_in_range = [&](std::size_t& position, std::size_t limit) {
-        skip_whitespace_and_comments(data, position);
-        if (position >= limit) {
-            return;
-        }
-        if (data[position] == '<') {
-            if (position + 1 < data.size() && data[position + 1] == '<') {
-                std::size_t nested_end = find_dictionary_end(data, position);
-                if (nested_end == std::string::npos || nested_end > limit) {
-                    position = limit;
-                } else {
-                    position = nested_end;
-                }
-            } else {
-                parse_pdf_hex_string(data, position);
-            }
-            return;
-        }
-        if (data[position] == '(') {
-            parse_pdf_literal_string(data, position);
-            return;
-        }
-        if (data[position] == '[') {
-            ++position;
-            int depth = 1;
-            while (position < limit && depth > 0) {
-                skip_whitespace_and_comments(data, position);
-                if (position >= limit) {
-                    break;
-                }
-                char token = data[position];
-                if (token == '[') {
-                    ++depth;
-                    ++position;
-                } else if (token == ']') {
-                    --depth;
-                    ++position;
-                } else if (token == '(') {
-                    parse_pdf_literal_string(data, position);
-                } else if (token == '<') {
-                    if (position + 1 < data.size() && data[position + 1] == '<') {
-                        std::size_t nested_end = find_dictionary_end(data, position);
-                        if (nested_end == std::string::npos || nested_end > limit) {
-                            position = limit;
-                        } else {
-                            position = nested_end;
-                        }
-                    } else {
-                        parse_pdf_hex_string(data, position);
-                    }
-                } else {
-                    ++position;
-                }
-            }
-            return;
-        }
-        while (position < limit && !std::isspace(static_cast<unsigned char>(data[position])) &&
-               data[position] != '/') {
-            ++position;
-        }
-    };
-
     auto update_selected_crypt_filter = [&]() {
         if (crypt_filter_methods.empty()) {
             return;
@@ -492,7 +1074,7 @@ bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
         }
     };
 
-    pos = dict_start + 2;
+    std::size_t pos = dict_start + 2;
     while (pos < dict_end) {
         skip_whitespace_and_comments(data, pos);
         if (pos >= dict_end) {
@@ -599,18 +1181,18 @@ bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
                                     crypt_filter_methods[filter_name] = method;
                                 }
                             }
-                            skip_pdf_object_in_range(inner_value_pos, filter_dict_end);
+                            skip_pdf_object(data, inner_value_pos, filter_dict_end);
                             value_pos = inner_value_pos;
                         }
                         cf_pos = filter_dict_end;
                     } else {
-                        skip_pdf_object_in_range(value_pos, cf_end);
+                        skip_pdf_object(data, value_pos, cf_end);
                         cf_pos = value_pos;
                     }
                 }
                 pos = cf_end;
             } else {
-                skip_pdf_object_in_range(cf_pos, dict_end);
+                skip_pdf_object(data, cf_pos, dict_end);
                 pos = cf_pos;
             }
             update_selected_crypt_filter();
@@ -724,100 +1306,33 @@ bool extract_encryption_info(const std::string& data, PDFEncryptInfo& info) {
     return true;
 }
 
-void print_pdf_structure(const std::string& data) {
-    std::cout << "\nAnalyzing PDF structure:" << std::endl;
-    std::cout << "------------------------" << std::endl;
-
-    struct KeywordRule {
-        const char* token;
-        bool require_word_boundaries;
-    };
-
-    const KeywordRule keywords[] = {
-        {"/Encrypt", true}, {"obj", true},     {"endobj", true}, {"/Filter", true},
-        {"/V ", false},     {"/R ", false},     {"/O", true},      {"/U", true},
-        {"/Length", true},  {"/CF", true},      {"/StmF", true},   {"/StrF", true},
-        {"/AESV3", true}};
-
-    auto requires_boundary = [](char ch) {
-        return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
-    };
-
-    for (const auto& keyword : keywords) {
-        std::size_t pos = 0;
-        int count = 0;
-        const std::size_t token_length = std::strlen(keyword.token);
-        while ((pos = data.find(keyword.token, pos)) != std::string::npos) {
-            if (keyword.require_word_boundaries) {
-                bool prefix_ok = true;
-                if (pos > 0) {
-                    prefix_ok = !requires_boundary(data[pos - 1]);
-                }
-                bool suffix_ok = true;
-                if (pos + token_length < data.size()) {
-                    suffix_ok = !requires_boundary(data[pos + token_length]);
-                }
-                if (!prefix_ok || !suffix_ok) {
-                    pos += token_length;
-                    continue;
-                }
-            }
-
-            if (count < 3) {
-                std::size_t context_end = std::min(pos + static_cast<std::size_t>(50), data.size());
-                std::string context = make_printable_truncated(
-                    std::string_view(data).substr(pos, context_end - pos), 80);
-                std::cout << "Found '" << keyword.token << "' at offset " << pos << ": " << context
-                          << std::endl;
-            }
-            ++count;
-            pos += token_length;
+void print_pdf_structure(std::string_view data, const StructureIndex& index, std::ostream& out) {
+    out << "\nAnalyzing PDF structure:" << std::endl;
+    out << "------------------------" << std::endl;
+
+    for (std::size_t id = 0; id <= static_cast<std::size_t>(StructureKeyword::AESV3); ++id) {
+        auto keyword = static_cast<StructureKeyword>(id);
+        std::string_view token = structure_keyword_token(keyword);
+        const std::vector<std::size_t>& offsets = index.occurrences(keyword);
+        for (std::size_t i = 0; i < offsets.size() && i < 3; ++i) {
+            std::size_t pos = offsets[i];
+            std::size_t context_end = std::min(pos + static_cast<std::size_t>(50), data.size());
+            std::string context = make_printable_truncated(data.substr(pos, context_end - pos), 80);
+            out << "Found '" << token << "' at offset " << pos << ": " << context << std::endl;
         }
-        if (count > 0) {
-            std::cout << "Total occurrences of '" << keyword.token << "': " << count << std::endl;
+        if (!offsets.empty()) {
+            out << "Total occurrences of '" << token << "': " << offsets.size() << std::endl;
         }
     }
 
-    std::cout << "------------------------\n" << std::endl;
+    out << "------------------------\n" << std::endl;
 }
 
 }  // namespace
 
-bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
-    std::cout << "Opening PDF file: " << filename << std::endl;
-    std::ifstream file(filename, std::ios::binary);
-    if (!file) {
-        std::cerr << "Error: Cannot open PDF file" << std::endl;
-        return false;
-    }
-
-    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    if (data.size() < 5 || data.compare(0, 5, "%PDF-") != 0) {
-        std::cerr << "Error: Not a valid PDF file" << std::endl;
-        return false;
-    }
-
-    std::cout << "PDF file opened successfully" << std::endl;
-    std::cout << "Checking PDF header..." << std::endl;
-    std::cout << "Valid PDF header found" << std::endl;
-
-    print_pdf_structure(data);
-
-    if (!extract_encryption_info(data, info)) {
-        std::cerr << "Error: Could not find encryption information" << std::endl;
-        return false;
-    }
-
-    info.id = extract_document_id(data);
-
-    std::cout << "PDF encryption detected:" << std::endl;
-    std::cout << "  Version: " << info.version << std::endl;
-    std::cout << "  Revision: " << info.revision << std::endl;
-    if (info.length > 0) {
-        std::cout << "  Key Length: " << info.length << " bits" << std::endl;
-    }
-
+EncryptionDescription describe_encryption(const PDFEncryptInfo& info) {
     int effective_key_length = info.length;
+
     if (effective_key_length == 0) {
         if (info.revision >= 5) {
             effective_key_length = 256;
@@ -864,8 +1379,10 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
         return method_value;
     };
 
-    std::string encryption_description;
-    std::string method_description;
+    EncryptionDescription description;
+    description.key_length = effective_key_length;
+    std::string& encryption_description = description.algorithm;
+    std::string& method_description = description.method;
 
     if (!info.crypt_filter_method.empty()) {
         encryption_description = method_to_algorithm(info.crypt_filter_method);
@@ -904,8 +1421,77 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
         method_description = "Unknown";
     }
 
-    std::cout << "  Encryption: " << encryption_description << std::endl;
-    std::cout << "  Method: " << method_description << std::endl;
+    return description;
+}
+
+bool read_pdf_encrypt_info(const std::string& filename,
+                           PDFEncryptInfo& info,
+                           std::ostream& out,
+                           std::string& error,
+                           bool verbose) {
+    out << "Opening PDF file: " << filename << std::endl;
+    unlock_pdf::util::MappedFile file;
+    std::string open_error;
+    if (!file.open(filename, open_error)) {
+        error = "Cannot open PDF file (" + open_error + ")";
+        return false;
+    }
+
+    std::string_view data = file.view();
+    if (data.size() < 5 || data.compare(0, 5, "%PDF-") != 0) {
+        error = "Not a valid PDF file";
+        return false;
+    }
+
+    out << "PDF file opened successfully" << std::endl;
+    out << "Checking PDF header..." << std::endl;
+    out << "Valid PDF header found" << std::endl;
+
+    // Built at most once, and only when a full-file answer is needed.
+    std::optional<StructureIndex> index;
+    auto structure_index = [&]() -> const StructureIndex& {
+        if (!index) {
+            file.advise(unlock_pdf::util::AccessPattern::Sequential);
+            index = StructureIndex::build(data);
+        }
+        return *index;
+    };
+
+    if (verbose) {
+        print_pdf_structure(data, structure_index(), out);
+    }
+
+    file.advise(unlock_pdf::util::AccessPattern::Random);
+    DictionaryRange encrypt_range;
+    std::vector<unsigned char> trailer_id;
+    EncryptLookup lookup = locate_encrypt_by_xref(data, encrypt_range, trailer_id, out);
+    bool from_xref = lookup != EncryptLookup::Failed;
+    if (!from_xref) {
+        out << "Cross-reference table unusable, scanning the whole file" << std::endl;
+        lookup = locate_encrypt_by_scan(data, structure_index(), encrypt_range, out);
+    }
+
+    if (lookup == EncryptLookup::NotEncrypted) {
+        out << "No /Encrypt dictionary found" << std::endl;
+        info = PDFEncryptInfo{};
+        info.encrypted = false;
+    } else if (lookup == EncryptLookup::Failed || !parse_encryption_dictionary(data, encrypt_range, info, out)) {
+        error = "Could not find encryption information";
+        return false;
+    }
+
+    info.id = from_xref ? trailer_id : extract_document_id(data, structure_index());
+
+    out << "PDF encryption detected:" << std::endl;
+    out << "  Version: " << info.version << std::endl;
+    out << "  Revision: " << info.revision << std::endl;
+    if (info.length > 0) {
+        out << "  Key Length: " << info.length << " bits" << std::endl;
+    }
+
+    EncryptionDescription description = describe_encryption(info);
+    out << "  Encryption: " << description.algorithm << std::endl;
+    out << "  Method: " << description.method << std::endl;
 
     auto describe_bytes = [](const std::vector<unsigned char>& bytes) {
         if (bytes.empty()) {
@@ -927,35 +1513,35 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
     perm_hex << std::hex << std::uppercase << std::setfill('0') << std::setw(8)
              << static_cast<std::uint32_t>(info.permissions);
 
-    std::cout << '\n';
-    std::cout << "Encryption dictionary details:" << std::endl;
-    std::cout << "  Filter: " << describe_name(info.filter) << std::endl;
-    std::cout << "  SubFilter: " << describe_name(info.sub_filter) << std::endl;
-    std::cout << "  Stream filter: " << describe_name(info.stream_filter) << std::endl;
-    std::cout << "  String filter: " << describe_name(info.string_filter) << std::endl;
-    std::cout << "  Embedded file filter: " << describe_name(info.ef_filter) << std::endl;
+    out << '\n';
+    out << "Encryption dictionary details:" << std::endl;
+    out << "  Filter: " << describe_name(info.filter) << std::endl;
+    out << "  SubFilter: " << describe_name(info.sub_filter) << std::endl;
+    out << "  Stream filter: " << describe_name(info.stream_filter) << std::endl;
+    out << "  String filter: " << describe_name(info.string_filter) << std::endl;
+    out << "  Embedded file filter: " << describe_name(info.ef_filter) << std::endl;
     if (!info.crypt_filter.empty() || !info.crypt_filter_method.empty()) {
-        std::cout << "  Crypt filter: " << describe_name(info.crypt_filter);
+        out << "  Crypt filter: " << describe_name(info.crypt_filter);
         if (!info.crypt_filter_method.empty()) {
-            std::cout << " (method: " << info.crypt_filter_method << ')';
+            out << " (method: " << info.crypt_filter_method << ')';
         }
-        std::cout << std::endl;
+        out << std::endl;
     }
-    std::cout << "  Version (V): " << info.version << std::endl;
-    std::cout << "  Revision (R): " << info.revision << std::endl;
-    std::cout << "  Permissions (P): " << info.permissions << " (0x" << perm_hex.str() << ')' << std::endl;
-    std::cout << "  Encrypt metadata: " << (info.encrypt_metadata ? "yes" : "no") << std::endl;
-    std::cout << "  Public-key security (Recipients): " << (info.has_recipients ? "yes" : "no")
-              << std::endl;
+    out << "  Version (V): " << info.version << std::endl;
+    out << "  Revision (R): " << info.revision << std::endl;
+    out << "  Permissions (P): " << info.permissions << " (0x" << perm_hex.str() << ')' << std::endl;
+    out << "  Encrypt metadata: " << (info.encrypt_metadata ? "yes" : "no") << std::endl;
+    out << "  Public-key security (Recipients): " << (info.has_recipients ? "yes" : "no")
+        << std::endl;
 
     auto print_binary_field = [&](const std::string& label, const std::vector<unsigned char>& bytes) {
-        std::cout << "  " << label << ':' << ' ';
+        out << "  " << label << ':' << ' ';
         if (bytes.empty()) {
-            std::cout << "(not present)";
+            out << "(not present)";
         } else {
-            std::cout << bytes.size() << " bytes (hex: " << describe_bytes(bytes) << ')';
+            out << bytes.size() << " bytes (hex: " << describe_bytes(bytes) << ')';
         }
-        std::cout << std::endl;
+        out << std::endl;
     };
 
     print_binary_field("Document ID", info.id);
@@ -967,12 +1553,12 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
         print_binary_field("Perms entry", info.perms);
     }
 
-    std::cout << '\n';
-    std::cout << "Permission summary:" << std::endl;
+    out << '\n';
+    out << "Permission summary:" << std::endl;
 
     std::uint32_t perm_bits = static_cast<std::uint32_t>(info.permissions);
-    auto print_permission = [](const std::string& label, bool allowed) {
-        std::cout << "    " << label << ": " << (allowed ? "allowed" : "not allowed") << std::endl;
+    auto print_permission = [&](const std::string& label, bool allowed) {
+        out << "    " << label << ": " << (allowed ? "allowed" : "not allowed") << std::endl;
     };
 
     bool can_print_low = (perm_bits & 0x4u) != 0u;
@@ -987,7 +1573,7 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
     if (info.revision >= 3) {
         print_permission("extract for accessibility", can_extract_accessibility);
     } else {
-        std::cout << "    extract for accessibility: not defined for revision " << info.revision << std::endl;
+        out << "    extract for accessibility: not defined for revision " << info.revision << std::endl;
     }
     print_permission("extract for any purpose", can_extract_all);
     print_permission("print low resolution", can_print_low);
@@ -1006,4 +1592,13 @@ bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info) {
     return true;
 }
 
-}  // namespace unlock_pdf::pdf
\ No newline at end of file
+bool read_pdf_encrypt_info(const std::string& filename, PDFEncryptInfo& info, bool verbose) {
+    std::string error;
+    if (!read_pdf_encrypt_info(filename, info, std::cout, error, verbose)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace unlock_pdf::pdf
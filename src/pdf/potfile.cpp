@@ -0,0 +1,168 @@
+#include "pdf/potfile.h"
+
+#include <filesystem>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "pdf/encryption/standard_security_utils.h"
+#include "pdf/pdf_hash.h"
+#include "util/hex.h"
+#include "util/system_info.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+constexpr const char* kPotfileName = "unlock_pdf.potfile";
+
+// Appends `data` with one write, so that concurrent runs never interleave
+// records. The file holds passwords in clear and is created readable and
+// writable by its owner only.
+bool append_private(const std::string& path, const std::string& data) {
+#if defined(_WIN32)
+    int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = _write(fd, data.data(), static_cast<unsigned int>(data.size())) == static_cast<int>(data.size());
+    return _close(fd) == 0 && written;
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t count = ::write(fd, data.data() + offset, data.size() - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        offset += static_cast<std::size_t>(count);
+    }
+    return ::close(fd) == 0 && offset == data.size();
+#endif
+}
+
+// Splits "digest\tkey\tvariant\tpassword"; the password is the rest of the
+// line and may itself contain tabs.
+bool parse_line(const std::string& line, std::string& digest, PotfileEntry& entry) {
+    std::size_t first = line.find('\t');
+    std::size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+    std::size_t third = second == std::string::npos ? second : line.find('\t', second + 1);
+    if (third == std::string::npos || first != 64) {
+        return false;
+    }
+    digest = line.substr(0, first);
+    entry.file_key = line.substr(first + 1, second - first - 1);
+    entry.variant = line.substr(second + 1, third - second - 1);
+    entry.password = line.substr(third + 1);
+    return true;
+}
+
+}  // namespace
+
+std::string default_potfile_path() {
+    std::string directory = unlock_pdf::util::user_cache_directory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    return (std::filesystem::path(directory) / kPotfileName).string();
+}
+
+bool Potfile::open(const std::string& path, std::string& error) {
+    path_ = path;
+    entries_.clear();
+    passwords_.clear();
+    distinct_passwords_.clear();
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return true;
+    }
+    std::ifstream input(path);
+    if (!input) {
+        error = "cannot open potfile '" + path + "'";
+        return false;
+    }
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::string digest;
+        PotfileEntry entry;
+        if (parse_line(line, digest, entry)) {
+            index(digest, std::move(entry));
+        }
+    }
+    if (input.bad()) {
+        error = "cannot read potfile '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+const PotfileEntry* Potfile::find(const PDFEncryptInfo& info) const {
+    std::string digest = document_digest(info);
+    if (digest.empty()) {
+        return nullptr;
+    }
+    auto it = entries_.find(digest);
+    return it == entries_.end() ? nullptr : &it->second;
+}
+
+bool Potfile::record(const PDFEncryptInfo& info,
+                     const std::string& password,
+                     const std::string& variant,
+                     std::string& error) {
+    std::string digest = document_digest(info);
+    if (digest.empty() || entries_.count(digest) != 0) {
+        return true;
+    }
+    if (password.find_first_of("\r\n") != std::string::npos) {
+        error = "passwords containing line breaks cannot be stored in the potfile";
+        return false;
+    }
+
+    PotfileEntry entry;
+    entry.password = password;
+    entry.variant = variant;
+    std::vector<unsigned char> file_key = standard_security::derive_file_key(password, info);
+    entry.file_key = unlock_pdf::util::to_hex(file_key.data(), file_key.size());
+
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path_).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::string line = digest + '\t' + entry.file_key + '\t' + entry.variant + '\t' + entry.password + '\n';
+    if (!append_private(path_, line)) {
+        error = "cannot append to potfile '" + path_ + "'";
+        return false;
+    }
+    index(digest, std::move(entry));
+    return true;
+}
+
+void Potfile::index(const std::string& digest, PotfileEntry entry) {
+    if (entries_.count(digest) != 0) {
+        return;
+    }
+    if (distinct_passwords_.insert(entry.password).second) {
+        passwords_.push_back(entry.password);
+    }
+    entries_.emplace(digest, std::move(entry));
+}
+
+}  // namespace unlock_pdf::pdf
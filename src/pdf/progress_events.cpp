@@ -0,0 +1,152 @@
+#include "pdf/progress_events.h"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "util/json.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#endif
+
+namespace unlock_pdf::pdf {
+namespace {
+
+std::string quoted(const std::string& value) {
+    return '"' + unlock_pdf::util::json_escape(value) + '"';
+}
+
+double unix_time() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::FILE* open_descriptor(int fd) {
+#if defined(_WIN32)
+    return _fdopen(fd, "w");
+#else
+    return fdopen(fd, "w");
+#endif
+}
+
+}  // namespace
+
+bool parse_progress_format(const std::string& text, ProgressFormat& format) {
+    if (text == "text") {
+        format = ProgressFormat::Text;
+        return true;
+    }
+    if (text == "jsonl") {
+        format = ProgressFormat::Jsonl;
+        return true;
+    }
+    return false;
+}
+
+ProgressEventSink::ProgressEventSink(int fd) : start_time_(std::chrono::steady_clock::now()) {
+    if (fd == 1) {
+        stream_ = stdout;
+    } else if (fd == 2) {
+        stream_ = stderr;
+    } else if (fd > 2) {
+        stream_ = open_descriptor(fd);
+        owns_stream_ = stream_ != nullptr;
+    }
+    if (stream_ == nullptr) {
+        std::cerr << "Error: cannot write progress events to file descriptor " << fd << std::endl;
+    }
+}
+
+ProgressEventSink::~ProgressEventSink() {
+    if (owns_stream_) {
+        std::fclose(stream_);
+    }
+}
+
+void ProgressEventSink::write_line(const std::string& line) {
+    if (stream_ == nullptr) {
+        return;
+    }
+    // main moves human-readable output off stdout when events use it; flush
+    // anyway so that other callers never interleave lines mid-way.
+    if (stream_ == stdout) {
+        std::cout.flush();
+    }
+    std::fwrite(line.data(), 1, line.size(), stream_);
+    std::fputc('\n', stream_);
+    std::fflush(stream_);
+}
+
+void ProgressEventSink::start(const StartEvent& event) {
+    std::ostringstream line;
+    line << "{\"event\": \"start\", \"time\": " << std::fixed << std::setprecision(3) << unix_time()
+         << ", \"pdf\": " << quoted(event.pdf_path) << ", \"mode\": " << quoted(event.mode)
+         << ", \"revision\": " << event.revision << ", \"threads\": " << event.threads
+         << ", \"batch_size\": " << event.batch_size << ", \"keyspace\": ";
+    if (event.keyspace_known && !event.keyspace.overflowed()) {
+        line << event.keyspace.to_string();
+    } else {
+        line << "null";
+    }
+    line << '}';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    start_time_ = std::chrono::steady_clock::now();
+    write_line(line.str());
+}
+
+void ProgressEventSink::progress(const ProgressEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (progress_written_ && now - last_progress_ < kMinProgressInterval) {
+        return;
+    }
+    last_progress_ = now;
+    progress_written_ = true;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3) << "{\"event\": \"progress\", \"elapsed\": " << event.elapsed_seconds
+         << ", \"tried\": " << event.tried << ", \"total\": ";
+    if (!event.total.is_zero() && !event.total.overflowed()) {
+        line << event.total.to_string() << ", \"percent\": "
+             << static_cast<double>(event.tried) / event.total.to_double() * 100.0;
+    } else {
+        line << "null, \"percent\": null";
+    }
+    line << ", \"rate\": " << event.rate << ", \"eta\": ";
+    if (event.eta_seconds >= 0.0) {
+        line << event.eta_seconds;
+    } else {
+        line << "null";
+    }
+    line << ", \"thread_rates\": [";
+    for (std::size_t i = 0; i < event.thread_rates.size(); ++i) {
+        line << (i == 0 ? "" : ", ") << event.thread_rates[i];
+    }
+    line << "]}";
+    write_line(line.str());
+}
+
+void ProgressEventSink::found(const std::string& password, const std::string& variant, std::uint64_t tried) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    std::ostringstream line;
+    line << "{\"event\": \"found\", \"password\": " << quoted(password) << ", \"variant\": " << quoted(variant)
+         << ", \"tried\": " << tried << ", \"elapsed\": " << std::fixed << std::setprecision(3) << elapsed << '}';
+    write_line(line.str());
+}
+
+void ProgressEventSink::finished(bool success, std::uint64_t tried, double elapsed_seconds) {
+    std::ostringstream line;
+    line << "{\"event\": \"finished\", \"success\": " << (success ? "true" : "false") << ", \"tried\": " << tried
+         << ", \"elapsed\": " << std::fixed << std::setprecision(3) << elapsed_seconds << '}';
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_line(line.str());
+}
+
+void ProgressEventSink::error(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_line("{\"event\": \"error\", \"message\": " + quoted(message) + '}');
+}
+
+}  // namespace unlock_pdf::pdf
@@ -0,0 +1,191 @@
+#include "pdf/progress_reporter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace unlock_pdf::pdf {
+namespace {
+
+std::string format_rate(double per_second) {
+    static const char* const suffixes[] = {"", "k", "M", "G"};
+    std::size_t suffix_index = 0;
+    while (per_second >= 1000.0 && suffix_index + 1 < sizeof(suffixes) / sizeof(suffixes[0])) {
+        per_second /= 1000.0;
+        ++suffix_index;
+    }
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(suffix_index == 0 ? 0 : 2) << per_second << suffixes[suffix_index];
+    return oss.str();
+}
+
+std::string format_duration(double seconds) {
+    if (seconds < 0.0 || seconds > 1e12) {
+        return "--:--:--";
+    }
+    auto total = static_cast<std::uint64_t>(seconds + 0.5);
+    std::uint64_t days = total / 86400;
+    std::uint64_t hours = (total / 3600) % 24;
+    std::uint64_t minutes = (total / 60) % 60;
+    std::uint64_t secs = total % 60;
+
+    std::ostringstream oss;
+    if (days > 0) {
+        oss << days << "d ";
+    }
+    oss << std::setfill('0') << std::setw(2) << hours << ':' << std::setw(2) << minutes << ':' << std::setw(2)
+        << secs;
+    return oss.str();
+}
+
+// Listing every thread is only readable for small pools; larger pools get a
+// min/max summary instead.
+constexpr std::size_t kMaxThreadsListed = 8;
+
+}  // namespace
+
+ProgressReporter::ProgressReporter(std::size_t thread_count,
+                                   const unlock_pdf::util::Keyspace& total,
+                                   std::chrono::milliseconds interval)
+    : counters_(std::max<std::size_t>(thread_count, 1)),
+      previous_counts_(counters_.size(), 0),
+      total_(total),
+      interval_(interval.count() > 0 ? interval : std::chrono::milliseconds(500)) {}
+
+ProgressReporter::~ProgressReporter() { stop(); }
+
+void ProgressReporter::set_total(const unlock_pdf::util::Keyspace& total) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_ = total;
+}
+
+void ProgressReporter::start() {
+    start_time_ = std::chrono::steady_clock::now();
+    previous_time_ = start_time_;
+    stop_requested_ = false;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ProgressReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+        if (printed_) {
+            std::cout << std::endl;
+        }
+        if (metrics_ != nullptr) {
+            std::vector<std::uint64_t> counts(counters_.size(), 0);
+            for (std::size_t i = 0; i < counters_.size(); ++i) {
+                counts[i] = counters_[i].load();
+            }
+            metrics_->on_report(std::chrono::steady_clock::now(), counts, true);
+        }
+    }
+}
+
+std::uint64_t ProgressReporter::total_tried() const {
+    std::uint64_t sum = 0;
+    for (const auto& counter : counters_) {
+        sum += counter.load();
+    }
+    return sum;
+}
+
+void ProgressReporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_requested_) {
+        if (wake_.wait_for(lock, interval_, [this]() { return stop_requested_; })) {
+            break;
+        }
+        lock.unlock();
+        report();
+        lock.lock();
+    }
+}
+
+void ProgressReporter::report() {
+    auto now = std::chrono::steady_clock::now();
+    double interval_seconds = std::chrono::duration<double>(now - previous_time_).count();
+    double elapsed_seconds = std::chrono::duration<double>(now - start_time_).count();
+    previous_time_ = now;
+
+    std::uint64_t tried = 0;
+    std::vector<double> thread_rates(counters_.size(), 0.0);
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        std::uint64_t count = counters_[i].load();
+        tried += count;
+        if (interval_seconds > 0.0) {
+            thread_rates[i] = static_cast<double>(count - previous_counts_[i]) / interval_seconds;
+        }
+        previous_counts_[i] = count;
+    }
+
+    double rate = 0.0;
+    for (double thread_rate : thread_rates) {
+        rate += thread_rate;
+    }
+    double average_rate = elapsed_seconds > 0.0 ? static_cast<double>(tried) / elapsed_seconds : 0.0;
+    unlock_pdf::util::Keyspace total;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        total = total_;
+    }
+
+    if (events_ != nullptr) {
+        ProgressEvent event;
+        event.elapsed_seconds = elapsed_seconds;
+        event.tried = tried;
+        event.total = total;
+        event.rate = rate;
+        if (!total.is_zero() && average_rate > 0.0) {
+            event.eta_seconds = total.saturating_sub(tried).to_double() / average_rate;
+        }
+        event.thread_rates = std::move(thread_rates);
+        events_->progress(event);
+        if (metrics_ != nullptr) {
+            metrics_->on_report(now, previous_counts_, false);
+        }
+        return;
+    }
+
+    std::ostringstream line;
+    line << "\rPasswords tried: " << tried;
+    if (!total.is_zero()) {
+        double percent = static_cast<double>(tried) / total.to_double() * 100.0;
+        line << '/' << total.to_string() << " (" << std::fixed << std::setprecision(2) << percent << "%)";
+    }
+    line << " | " << format_rate(rate) << "/s";
+    if (!total.is_zero() && average_rate > 0.0) {
+        double remaining = total.saturating_sub(tried).to_double();
+        line << " | ETA " << format_duration(remaining / average_rate);
+    }
+
+    if (thread_rates.size() > 1) {
+        if (thread_rates.size() <= kMaxThreadsListed) {
+            line << " | per thread:";
+            for (double thread_rate : thread_rates) {
+                line << ' ' << format_rate(thread_rate);
+            }
+        } else {
+            auto [min_it, max_it] = std::minmax_element(thread_rates.begin(), thread_rates.end());
+            line << " | per thread: min " << format_rate(*min_it) << " max " << format_rate(*max_it);
+        }
+    }
+    line << "   ";
+
+    std::cout << line.str() << std::flush;
+    printed_ = true;
+
+    if (metrics_ != nullptr) {
+        metrics_->on_report(now, previous_counts_, false);
+    }
+}
+
+}  // namespace unlock_pdf::pdf
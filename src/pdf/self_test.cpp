@@ -0,0 +1,644 @@
+#include "pdf/self_test.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "crypto/aes.h"
+#include "crypto/md5.h"
+#include "crypto/rc4.h"
+#include "crypto/sha2.h"
+#include "pdf/encryption/encryption_handler_registry.h"
+#include "pdf/encryption/standard_security_utils.h"
+#include "pdf/test_pdf_generator.h"
+#include "util/hex.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+using Bytes = std::vector<unsigned char>;
+
+// Random inputs for the R6 reference comparison; each one costs two full
+// algorithm 2.B evaluations, so it does not scale with random_iterations.
+constexpr std::size_t kHashReferenceInputs = 24;
+constexpr std::size_t kDigestSweepLength = 300;
+
+using unlock_pdf::util::to_hex;
+
+Bytes from_hex(const std::string& hex) {
+    Bytes data;
+    data.reserve(hex.size() / 2);
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        data.push_back(static_cast<unsigned char>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return data;
+}
+
+Bytes to_bytes(const std::string& text) {
+    return Bytes(text.begin(), text.end());
+}
+
+Bytes random_bytes(std::mt19937& rng, std::size_t count) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    Bytes data(count);
+    for (auto& value : data) {
+        value = static_cast<unsigned char>(byte(rng));
+    }
+    return data;
+}
+
+std::string random_password(std::mt19937& rng, std::size_t length) {
+    std::uniform_int_distribution<int> printable(0x21, 0x7e);
+    std::string password(length, ' ');
+    for (auto& ch : password) {
+        ch = static_cast<char>(printable(rng));
+    }
+    return password;
+}
+
+// Collects results per group so a failing run names the exact check and the
+// inputs that broke it, while a passing run stays a handful of lines.
+class Checker {
+public:
+    Checker(std::ostream& out, bool verbose) : out_(out), verbose_(verbose) {}
+
+    void begin(const std::string& group) {
+        group_ = group;
+        group_passed_ = 0;
+        group_failed_ = 0;
+    }
+
+    bool expect(bool ok, const std::string& what) {
+        if (ok) {
+            ++group_passed_;
+        } else {
+            ++group_failed_;
+            out_ << "  FAIL " << group_ << ": " << what << '\n';
+        }
+        return ok;
+    }
+
+    bool expect_hex(const Bytes& actual, const std::string& expected, const std::string& what) {
+        std::string hex = to_hex(actual);
+        if (hex == expected) {
+            return expect(true, what);
+        }
+        return expect(false, what + " (got " + hex + ", expected " + expected + ")");
+    }
+
+    void end() {
+        summary_.passed += group_passed_;
+        summary_.failed += group_failed_;
+        if (verbose_ || group_failed_ > 0) {
+            out_ << "  " << (group_failed_ == 0 ? "ok  " : "FAIL") << "  " << group_ << " (" << group_passed_ << '/'
+                 << (group_passed_ + group_failed_) << ")\n";
+        }
+    }
+
+    SelfTestSummary summary() const { return summary_; }
+
+private:
+    std::ostream& out_;
+    bool verbose_ = false;
+    std::string group_;
+    std::size_t group_passed_ = 0;
+    std::size_t group_failed_ = 0;
+    SelfTestSummary summary_;
+};
+
+// ---------------------------------------------------------------------------
+// Published test vectors
+// ---------------------------------------------------------------------------
+
+void check_md5_vectors(Checker& checker) {
+    struct Vector {
+        const char* message;
+        const char* digest;
+    };
+    // RFC 1321, appendix A.5.
+    static const Vector vectors[] = {
+        {"", "d41d8cd98f00b204e9800998ecf8427e"},
+        {"a", "0cc175b9c0f1b6a831c399e269772661"},
+        {"abc", "900150983cd24fb0d6963f7d28e17f72"},
+        {"message digest", "f96b697d7cb7938d525a2f31aaf161d0"},
+        {"abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"},
+        {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789", "d174ab98d277d9f5a5611c2c9f419d9f"},
+        {"12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+         "57edf4a22be3c955ac49da2e2107b67a"},
+    };
+
+    checker.begin("MD5 RFC 1321 vectors");
+    for (const auto& vector : vectors) {
+        checker.expect_hex(unlock_pdf::crypto::md5_bytes(to_bytes(vector.message)),
+                           vector.digest,
+                           "md5(\"" + std::string(vector.message) + "\")");
+    }
+    checker.end();
+}
+
+void check_sha2_vectors(Checker& checker) {
+    const std::string m448 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    const std::string m896 =
+        "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu";
+
+    struct Vector {
+        std::size_t bits;
+        std::string message;
+        const char* label;
+        const char* digest;
+    };
+    // FIPS 180-4 examples (NIST CSRC "Examples with Intermediate Values").
+    const std::vector<Vector> vectors = {
+        {256, "", "empty", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {256, "abc", "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {256, m448, "448-bit", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {256, m896, "896-bit", "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+        {384, "", "empty",
+         "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b"},
+        {384, "abc", "abc",
+         "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7"},
+        {384, m448, "448-bit",
+         "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6b0455a8520bc4e6f5fe95b1fe3c8452b"},
+        {384, m896, "896-bit",
+         "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039"},
+        {512, "", "empty",
+         "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+         "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e"},
+        {512, "abc", "abc",
+         "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+         "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"},
+        {512, m448, "448-bit",
+         "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+         "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445"},
+        {512, m896, "896-bit",
+         "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+         "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"},
+    };
+
+    checker.begin("SHA-2 FIPS 180-4 vectors");
+    for (const auto& vector : vectors) {
+        checker.expect_hex(unlock_pdf::crypto::sha2_hash(to_bytes(vector.message), vector.bits),
+                           vector.digest,
+                           "sha" + std::to_string(vector.bits) + " " + vector.label);
+    }
+    checker.end();
+}
+
+void check_aes_vectors(Checker& checker) {
+    // FIPS 197 appendix C.1 (AES-128) and C.3 (AES-256).
+    const Bytes plaintext = from_hex("00112233445566778899aabbccddeeff");
+    Bytes key128(16);
+    Bytes key256(32);
+    for (std::size_t i = 0; i < key256.size(); ++i) {
+        key256[i] = static_cast<unsigned char>(i);
+        if (i < key128.size()) {
+            key128[i] = static_cast<unsigned char>(i);
+        }
+    }
+
+    checker.begin("AES FIPS 197 vectors");
+    Bytes block(16);
+    unlock_pdf::crypto::AES128Encryptor aes128(key128);
+    if (checker.expect(aes128.valid(), "AES-128 key schedule")) {
+        aes128.encrypt_block(plaintext.data(), block.data());
+        checker.expect_hex(block, "69c4e0d86a7b0430d8cdb78070b4c55a", "C.1 AES-128 encrypt");
+    }
+
+    unlock_pdf::crypto::AES256Encryptor aes256(key256);
+    if (checker.expect(aes256.valid(), "AES-256 key schedule")) {
+        aes256.encrypt_block(plaintext.data(), block.data());
+        checker.expect_hex(block, "8ea2b7ca516745bfeafc49904b496089", "C.3 AES-256 encrypt");
+    }
+
+    unlock_pdf::crypto::AES256Decryptor aes256_inverse(key256);
+    if (checker.expect(aes256_inverse.valid(), "AES-256 inverse key schedule")) {
+        Bytes ciphertext = from_hex("8ea2b7ca516745bfeafc49904b496089");
+        aes256_inverse.decrypt_block(ciphertext.data(), block.data());
+        checker.expect_hex(block, to_hex(plaintext), "C.3 AES-256 decrypt");
+    }
+    checker.end();
+}
+
+void check_rc4_vectors(Checker& checker) {
+    struct Vector {
+        const char* key;
+        const char* plaintext;
+        const char* ciphertext;
+    };
+    static const Vector vectors[] = {
+        {"Key", "Plaintext", "bbf316e8d940af0ad3"},
+        {"Wiki", "pedia", "1021bf0420"},
+        {"Secret", "Attack at dawn", "45a01f645fc35b383552544b9bf5"},
+    };
+
+    checker.begin("RC4 vectors");
+    for (const auto& vector : vectors) {
+        Bytes input = to_bytes(vector.plaintext);
+        Bytes output(input.size());
+        unlock_pdf::crypto::RC4 rc4(to_bytes(vector.key));
+        rc4.crypt(input.data(), output.data(), input.size());
+        checker.expect_hex(output, vector.ciphertext, "key \"" + std::string(vector.key) + "\"");
+    }
+    checker.end();
+}
+
+// Hashes every message length from 0 to 299 so each padding boundary
+// (55/56/64 bytes for MD5 and SHA-256, 111/112/128 for SHA-384/512) is hit,
+// and folds the digests into one SHA-256 value. The expected values were
+// produced with an independent implementation.
+void check_digest_sweeps(Checker& checker) {
+    struct Sweep {
+        const char* name;
+        std::size_t bits;  // 0 = MD5
+        const char* expected;
+    };
+    static const Sweep sweeps[] = {
+        {"md5", 0, "b713081a17442fabf760faf8216463598eb1f0a9deb166063dbf63f7c82073fb"},
+        {"sha256", 256, "7b074096cabb18dd0d1b468a173cb2f97f80e952525bca29542e606fd6d0753a"},
+        {"sha384", 384, "0d865f7fe4b437472808551a29954f6d3ff6752b50c62e8905048b0f289ae391"},
+        {"sha512", 512, "b649c4e6577be3c259289c2fd6b50826e79fce7f8ca8e0f5080b42ace0aafb64"},
+    };
+
+    checker.begin("Digest length sweeps 0-299 bytes");
+    for (const auto& sweep : sweeps) {
+        Bytes concatenated;
+        Bytes message;
+        for (std::size_t length = 0; length < kDigestSweepLength; ++length) {
+            message.resize(length);
+            for (std::size_t i = 0; i < length; ++i) {
+                message[i] = static_cast<unsigned char>((i * 7 + 3) & 0xff);
+            }
+            Bytes digest = sweep.bits == 0 ? unlock_pdf::crypto::md5_bytes(message)
+                                           : unlock_pdf::crypto::sha2_hash(message, sweep.bits);
+            concatenated.insert(concatenated.end(), digest.begin(), digest.end());
+        }
+        checker.expect_hex(unlock_pdf::crypto::sha256_bytes(concatenated), sweep.expected, sweep.name);
+    }
+    checker.end();
+}
+
+// ---------------------------------------------------------------------------
+// Differential checks on random inputs
+// ---------------------------------------------------------------------------
+
+void check_sha256_entry_points(Checker& checker, std::mt19937& rng, std::size_t iterations) {
+    std::uniform_int_distribution<std::size_t> length(0, 300);
+
+    checker.begin("SHA-256 entry points agree on random inputs");
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        Bytes message = random_bytes(rng, length(rng));
+        Bytes reference = unlock_pdf::crypto::sha256_bytes(message);
+        Bytes raw(32);
+        unlock_pdf::crypto::sha256_digest(message.data(), message.size(), raw.data());
+        Bytes generic = unlock_pdf::crypto::sha2_hash(message, 256);
+        if ((raw != reference || generic != reference) && mismatches++ == 0) {
+            checker.expect(false, "input " + to_hex(message));
+        }
+    }
+    checker.expect(mismatches == 0, std::to_string(mismatches) + " mismatching inputs");
+    checker.end();
+}
+
+// Textbook RC4 kept deliberately separate from crypto/rc4.cpp.
+Bytes reference_rc4(const Bytes& key, const Bytes& input) {
+    std::array<unsigned char, 256> s{};
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        s[i] = static_cast<unsigned char>(i);
+    }
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        j = (j + s[i] + key[i % key.size()]) & 0xff;
+        std::swap(s[i], s[j]);
+    }
+    Bytes output(input.size());
+    std::size_t x = 0;
+    std::size_t y = 0;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        x = (x + 1) & 0xff;
+        y = (y + s[x]) & 0xff;
+        std::swap(s[x], s[y]);
+        output[i] = input[i] ^ s[(s[x] + s[y]) & 0xff];
+    }
+    return output;
+}
+
+void check_rc4_differential(Checker& checker, std::mt19937& rng, std::size_t iterations) {
+    std::uniform_int_distribution<std::size_t> key_length(1, 32);
+    std::uniform_int_distribution<std::size_t> data_length(0, 256);
+
+    checker.begin("RC4 matches reference, whole and split calls");
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        Bytes key = random_bytes(rng, key_length(rng));
+        Bytes input = random_bytes(rng, data_length(rng));
+        Bytes expected = reference_rc4(key, input);
+
+        Bytes whole(input.size());
+        unlock_pdf::crypto::RC4 rc4(key);
+        rc4.crypt(input.data(), whole.data(), input.size());
+
+        // Reusing one object through set_key and splitting the stream must not
+        // change the key stream.
+        Bytes split(input.size());
+        rc4.set_key(key);
+        std::size_t cut = input.empty() ? 0 : std::uniform_int_distribution<std::size_t>(0, input.size())(rng);
+        rc4.crypt(input.data(), split.data(), cut);
+        rc4.crypt(input.data() + cut, split.data() + cut, input.size() - cut);
+
+        if ((whole != expected || split != expected) && mismatches++ == 0) {
+            checker.expect(false, "key " + to_hex(key) + ", " + std::to_string(input.size()) + " bytes");
+        }
+    }
+    checker.expect(mismatches == 0, std::to_string(mismatches) + " mismatching inputs");
+    checker.end();
+}
+
+void check_aes_differential(Checker& checker, std::mt19937& rng, std::size_t iterations) {
+    using unlock_pdf::crypto::aes128_cbc_encrypt;
+    using unlock_pdf::crypto::aes256_cbc_decrypt;
+    using unlock_pdf::crypto::aes256_cbc_encrypt;
+    std::uniform_int_distribution<std::size_t> blocks(1, 16);
+
+    checker.begin("AES CBC matches block-wise chaining and round-trips");
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        Bytes key128 = random_bytes(rng, 16);
+        Bytes key256 = random_bytes(rng, 32);
+        Bytes iv = random_bytes(rng, 16);
+        Bytes plaintext = random_bytes(rng, blocks(rng) * 16);
+
+        // CBC chaining done by hand over the single-block encryptors.
+        unlock_pdf::crypto::AES128Encryptor block128(key128);
+        unlock_pdf::crypto::AES256Encryptor block256(key256);
+        Bytes chained128(plaintext.size());
+        Bytes chained256(plaintext.size());
+        Bytes previous128 = iv;
+        Bytes previous256 = iv;
+        Bytes block(16);
+        for (std::size_t offset = 0; offset < plaintext.size(); offset += 16) {
+            for (std::size_t b = 0; b < 16; ++b) {
+                block[b] = plaintext[offset + b] ^ previous128[b];
+            }
+            block128.encrypt_block(block.data(), chained128.data() + offset);
+            previous128.assign(chained128.begin() + offset, chained128.begin() + offset + 16);
+
+            for (std::size_t b = 0; b < 16; ++b) {
+                block[b] = plaintext[offset + b] ^ previous256[b];
+            }
+            block256.encrypt_block(block.data(), chained256.data() + offset);
+            previous256.assign(chained256.begin() + offset, chained256.begin() + offset + 16);
+        }
+
+        Bytes cbc128;
+        Bytes cbc256;
+        Bytes decrypted;
+        bool ok = aes128_cbc_encrypt(key128, iv, plaintext, cbc128) && cbc128 == chained128 &&
+                  aes256_cbc_encrypt(key256, iv, plaintext, cbc256) && cbc256 == chained256 &&
+                  aes256_cbc_decrypt(key256, iv, cbc256, decrypted, false) && decrypted == plaintext;
+        if (!ok && mismatches++ == 0) {
+            checker.expect(false, "key " + to_hex(key256) + ", " + std::to_string(plaintext.size()) + " bytes");
+        }
+    }
+    checker.expect(mismatches == 0, std::to_string(mismatches) + " mismatching inputs");
+    checker.end();
+}
+
+// ---------------------------------------------------------------------------
+// Revision 5/6 password hash
+// ---------------------------------------------------------------------------
+
+// ISO 32000-2 algorithm 2.B written as directly as possible, without the
+// buffer reuse of the production version.
+Bytes reference_hash_r6(const std::string& password, const Bytes& salt, const Bytes& user_data) {
+    Bytes input = to_bytes(password);
+    input.insert(input.end(), salt.begin(), salt.end());
+    input.insert(input.end(), user_data.begin(), user_data.end());
+    Bytes k = unlock_pdf::crypto::sha256_bytes(input);
+
+    for (std::size_t round = 0;; ++round) {
+        Bytes k1;
+        for (int i = 0; i < 64; ++i) {
+            k1.insert(k1.end(), password.begin(), password.end());
+            k1.insert(k1.end(), k.begin(), k.end());
+            k1.insert(k1.end(), user_data.begin(), user_data.end());
+        }
+
+        unlock_pdf::crypto::AES128Encryptor aes(Bytes(k.begin(), k.begin() + 16));
+        Bytes e(k1.size());
+        Bytes chain(k.begin() + 16, k.begin() + 32);
+        for (std::size_t offset = 0; offset < k1.size(); offset += 16) {
+            unsigned char block[16];
+            for (std::size_t b = 0; b < 16; ++b) {
+                block[b] = k1[offset + b] ^ chain[b];
+            }
+            aes.encrypt_block(block, e.data() + offset);
+            chain.assign(e.begin() + offset, e.begin() + offset + 16);
+        }
+
+        unsigned int sum = 0;
+        for (std::size_t i = 0; i < 16; ++i) {
+            sum += e[i];
+        }
+        static const std::size_t bits[] = {256, 384, 512};
+        k = unlock_pdf::crypto::sha2_hash(e, bits[sum % 3]);
+
+        // Round numbers in the specification start at 1.
+        if (round + 1 >= 64 && static_cast<std::size_t>(e.back()) <= round + 1 - 32) {
+            break;
+        }
+    }
+    k.resize(32);
+    return k;
+}
+
+std::string kat_password(std::size_t length) {
+    std::string password(length, ' ');
+    for (std::size_t i = 0; i < length; ++i) {
+        password[i] = static_cast<char>((i * 11 + 0x21) % 94 + 0x21);
+    }
+    return password;
+}
+
+void check_hash_v5(Checker& checker, std::mt19937& rng) {
+    using standard_security::compute_hash_v5;
+
+    struct Vector {
+        std::size_t length;
+        const char* user_hash;   // no /U data, as for user passwords
+        const char* owner_hash;  // with 48 bytes of /U data, as for owner passwords
+    };
+    // Password lengths straddle the 16-byte AES blocks of the K1 buffer and
+    // the 127-byte limit. The expected values were produced with an
+    // independent implementation of algorithm 2.B.
+    static const Vector vectors[] = {
+        {0, "8d1efb4f1bdbb651341704c2139de4f6be05d6d4609af56916b21646ed74825c",
+         "6cdf2143ee8ca33f9120f90363cf0f95b4c53a05e1cf931cea738205c8e30ef7"},
+        {1, "918bcdde0836da7c485f1002cc47be804297125971f40a5834c4bfeb44c708da",
+         "5f32cbc053b8d24067b306c84738b945737da985bbc3ef2922b3861352932685"},
+        {8, "d757115e0d7efee366d54f1a37d19929fa58dd377f3f0d035ac535cc3f6da67b",
+         "a2fde7d3850e3c2086ea178a1ac8cf3532a281d74cc47b4b009803746ada4db0"},
+        {15, "26f28eea64805f2681b7f589ad9f3aa75c1061f5ce5cada0639c11d59c6e317e",
+         "b3474218667ffa16f42ca540137d325086998cf84c14891311bf40d137208508"},
+        {16, "c31b71a99dbd934c416d8ac1a42e4aa8e766dd7d80a62f469ba3e6977e55e91f",
+         "b8a82395aed7f10035be015fde4b8b463fac22b6760fd01b51f58275aadc8f46"},
+        {17, "83c22606fc979667dfb1e8d4d85cb2dd3616d9986c4e411e47fd00ead2bdf4e1",
+         "6938fcd6d81b518ca8d3440b060a6ae83043e9253f585df89f52a6fd6c298645"},
+        {31, "365df2ab8c7fafefdd1d4543ac2c84706910144aecb801b314e61eacc32346bd",
+         "fd129a4d18b8c893f2781d7dc02666df863691d7ae5aed2f2f563cdd4e3d150a"},
+        {32, "d569dc3b996e5cd17cf7c9a1272f47614eb7fd9b89b0ac2a5944acca50672bee",
+         "ca2458d1c68c3cc9d9f3af78530b42112897566162f52c43bef667cd1c8ec444"},
+        {33, "714eef73eafae5b496202f8937408842936440e257e8ba6bac0d9f8c2b763fb2",
+         "6933a6699d5a68a6df0133160c6f8d87f6bcfda1262b31deda48bfeed100ccd7"},
+        {47, "6ade7ea25eab93b6112a504171773c5868b14470dc20e3e0a0c6d264c11857a8",
+         "30714c4ca4eea7d58464d35b7863193c417babfcb7660fd6db0052c2ef6c5c47"},
+        {48, "11600d30fc4961e58ae4b0cf0135db89521e1ca85d0870a6a175d2e60674a2b3",
+         "b3eb2adac0920b4ade5799924ec5da74833cce774ba0b76ab06eaa5bd27e06a8"},
+        {49, "f286e436953591b9db3da153e1443a3fd9c5c08e741f1889cf46f1acf9e09f89",
+         "8680a5e536ffdf7e8b927d7248cb4dcf1bc250c4977f56267fcdeaa87241b16d"},
+        {64, "3d19a10daee15de218eb69c23c351e13353bf3219804eb4f1eac6a3d6e78110c",
+         "a79b30851e6973532148bd5324a9f4608d301436f2b59fcb64a9671a565edc02"},
+        {100, "a3398c196e0ea9d267e9000315f8255e19b9de83158b14d900461e37e1732361",
+         "5ceecebc82bd795d28153f99bcfbbfe53fadbb16b4b201434342ad36a1546bef"},
+        {126, "fa31fa455f3a484e22d4e4c5ee7027a58d27f5b69a26826c05b43a6ab54e6d04",
+         "b2a6202341c48cafd24beea6679f9d4458f0944f5326ee69c1fff4a07de9c4c6"},
+        {127, "9ec13a729a5dc1f7db7f1a7bd2988639f5c8e63db1affbcf8307a5d843944164",
+         "777fcbb974d83a91338989cc855eeedf5ec99a0503af7386a82fd4b32a49e766"},
+    };
+
+    const Bytes salt = {1, 2, 3, 4, 5, 6, 7, 8};
+    Bytes user_data(48);
+    for (std::size_t i = 0; i < user_data.size(); ++i) {
+        user_data[i] = static_cast<unsigned char>((i * 5) & 0xff);
+    }
+
+    checker.begin("R6 hash (algorithm 2.B) known answers");
+    for (const auto& vector : vectors) {
+        std::string password = kat_password(vector.length);
+        std::string label = std::to_string(vector.length) + "-byte password";
+        checker.expect_hex(compute_hash_v5(password, salt.data(), salt.size(), nullptr, 0, 6),
+                           vector.user_hash,
+                           label);
+        checker.expect_hex(
+            compute_hash_v5(password, salt.data(), salt.size(), user_data.data(), user_data.size(), 6),
+            vector.owner_hash,
+            label + " with /U data");
+    }
+    checker.end();
+
+    checker.begin("R5/R6 hash matches reference on random inputs");
+    std::uniform_int_distribution<std::size_t> length(0, 127);
+    for (std::size_t i = 0; i < kHashReferenceInputs; ++i) {
+        std::string password = random_password(rng, length(rng));
+        Bytes random_salt = random_bytes(rng, 8);
+        Bytes udata = (i % 2 == 0) ? Bytes() : random_bytes(rng, 48);
+        const unsigned char* udata_ptr = udata.empty() ? nullptr : udata.data();
+        std::string label = "password \"" + password + "\"" + (udata.empty() ? "" : " with /U data");
+
+        Bytes r5_input = to_bytes(password);
+        r5_input.insert(r5_input.end(), random_salt.begin(), random_salt.end());
+        r5_input.insert(r5_input.end(), udata.begin(), udata.end());
+        checker.expect(compute_hash_v5(password, random_salt.data(), 8, udata_ptr, udata.size(), 5) ==
+                           unlock_pdf::crypto::sha256_bytes(r5_input),
+                       "R5 " + label);
+
+        Bytes hash = compute_hash_v5(password, random_salt.data(), 8, udata_ptr, udata.size(), 6);
+        hash.resize(std::min<std::size_t>(hash.size(), 32));
+        checker.expect(hash == reference_hash_r6(password, random_salt, udata), "R6 " + label);
+    }
+    checker.end();
+}
+
+// ---------------------------------------------------------------------------
+// Handlers against generated files
+// ---------------------------------------------------------------------------
+
+void check_handlers(Checker& checker, std::mt19937& rng) {
+    struct Variant {
+        int revision;
+        TestPdfCipher cipher;
+    };
+    static const Variant variants[] = {
+        {2, TestPdfCipher::Rc4},
+        {3, TestPdfCipher::Rc4},
+        {4, TestPdfCipher::Rc4},
+        {4, TestPdfCipher::Aes},
+        {5, TestPdfCipher::Aes},
+        {6, TestPdfCipher::Aes},
+    };
+    // Covers the empty password, the 32-byte padding limit of R2-R4 and the
+    // 127-byte limit of R5/R6 from both sides.
+    static const std::size_t lengths[] = {0, 1, 7, 31, 32, 33, 127, 140};
+
+    auto handlers = create_default_encryption_handlers();
+    for (const auto& variant : variants) {
+        TestPdfOptions options;
+        options.revision = variant.revision;
+        options.cipher = variant.cipher;
+        checker.begin("Handlers on generated " + describe_test_pdf(options));
+
+        for (std::size_t index = 0; index < std::size(lengths); ++index) {
+            const std::size_t length = lengths[index];
+            options.user_password = random_password(rng, length);
+            options.owner_password = random_password(rng, 12 + index);
+            options.encrypt_metadata = index % 2 == 0;
+            options.seed = static_cast<std::uint32_t>(rng()) | 1u;
+
+            std::string pdf;
+            PDFEncryptInfo info;
+            std::string label = std::to_string(length) + "-byte user password";
+            if (!checker.expect(build_test_pdf(options, pdf, info), label + ": build")) {
+                continue;
+            }
+
+            auto password_handlers = collect_password_handlers(info, handlers);
+            auto accepted = [&](const std::string& password) {
+                std::string variant_name;
+                for (const auto* handler : password_handlers) {
+                    if (handler->check_password(password, info, variant_name)) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            // Changing the first byte keeps the candidate inside every
+            // truncation limit, so it must be rejected.
+            std::string wrong = options.user_password.empty() ? std::string("x") : options.user_password;
+            wrong[0] = wrong[0] == 'A' ? 'B' : 'A';
+
+            checker.expect(accepted(options.user_password), label + ": user password accepted");
+            checker.expect(accepted(options.owner_password), label + ": owner password accepted");
+            checker.expect(!accepted(wrong), label + ": wrong password rejected");
+        }
+        checker.end();
+    }
+}
+
+}  // namespace
+
+SelfTestSummary run_self_tests(const SelfTestOptions& options, std::ostream& out) {
+    std::uint32_t seed = options.seed != 0 ? options.seed : std::random_device{}();
+    std::mt19937 rng(seed);
+    Checker checker(out, options.verbose);
+
+    check_md5_vectors(checker);
+    check_sha2_vectors(checker);
+    check_aes_vectors(checker);
+    check_rc4_vectors(checker);
+    check_digest_sweeps(checker);
+    check_sha256_entry_points(checker, rng, options.random_iterations);
+    check_rc4_differential(checker, rng, options.random_iterations);
+    check_aes_differential(checker, rng, options.random_iterations);
+    check_hash_v5(checker, rng);
+    check_handlers(checker, rng);
+
+    SelfTestSummary summary = checker.summary();
+    summary.seed = seed;
+    return summary;
+}
+
+}  // namespace unlock_pdf::pdf
@@ -0,0 +1,326 @@
+#include "pdf/session_coverage.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/locking.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#include "util/system_info.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+constexpr const char* kCoverageFileName = "coverage.tsv";
+
+bool parse_position(const std::string& text, std::uint64_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    try {
+        value = std::stoull(text);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+// "begin-end,begin-end,..."; false on anything else so that a damaged line
+// is dropped rather than trusted.
+bool parse_ranges(const std::string& text, IntervalSet& ranges) {
+    std::istringstream input(text);
+    std::string range;
+    while (std::getline(input, range, ',')) {
+        std::size_t dash = range.find('-');
+        std::uint64_t begin = 0;
+        std::uint64_t end = 0;
+        if (dash == std::string::npos || !parse_position(range.substr(0, dash), begin) ||
+            !parse_position(range.substr(dash + 1), end) || end < begin) {
+            return false;
+        }
+        ranges.add(begin, end);
+    }
+    return true;
+}
+
+using Records = std::map<std::pair<std::string, std::string>, IntervalSet>;
+
+// Merges the records of `path` into `records`; a missing file adds nothing.
+bool read_records(const std::string& path, Records& records, std::string& error) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return true;
+    }
+    std::ifstream input(path);
+    if (!input) {
+        error = "cannot open coverage database '" + path + "'";
+        return false;
+    }
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        std::size_t first = line.find('\t');
+        std::size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+        IntervalSet ranges;
+        if (second == std::string::npos || !parse_ranges(line.substr(second + 1), ranges)) {
+            continue;
+        }
+        records[{line.substr(0, first), line.substr(first + 1, second - first - 1)}].add(ranges);
+    }
+    if (input.bad()) {
+        error = "cannot read coverage database '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+// Exclusive lock on `<database>.lock`, held until destruction, so that runs
+// sharing the database save one after another.
+class DatabaseLock {
+public:
+    explicit DatabaseLock(const std::string& database) {
+        std::string path = database + ".lock";
+#if defined(_WIN32)
+        fd_ = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+        // _LK_LOCK gives up after ten attempts a second apart.
+        while (fd_ >= 0 && !locked_) {
+            locked_ = _locking(fd_, _LK_LOCK, 1) == 0;
+        }
+#else
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        while (fd_ >= 0 && !locked_) {
+            if (::flock(fd_, LOCK_EX) == 0) {
+                locked_ = true;
+            } else if (errno != EINTR) {
+                break;
+            }
+        }
+#endif
+    }
+
+    ~DatabaseLock() {
+        if (fd_ < 0) {
+            return;
+        }
+#if defined(_WIN32)
+        if (locked_) {
+            _locking(fd_, _LK_UNLCK, 1);
+        }
+        _close(fd_);
+#else
+        ::close(fd_);  // releases the lock
+#endif
+    }
+
+    DatabaseLock(const DatabaseLock&) = delete;
+    DatabaseLock& operator=(const DatabaseLock&) = delete;
+
+    bool locked() const { return locked_; }
+
+private:
+    int fd_ = -1;
+    bool locked_ = false;
+};
+
+}  // namespace
+
+void IntervalSet::add(std::uint64_t begin, std::uint64_t end) {
+    if (begin >= end) {
+        return;
+    }
+    // First range that ends at or after `begin`; everything from there that
+    // starts at or before `end` merges with the new range.
+    auto first = std::lower_bound(ranges_.begin(), ranges_.end(), begin, [](const Range& range, std::uint64_t value) {
+        return range.second < value;
+    });
+    auto last = first;
+    while (last != ranges_.end() && last->first <= end) {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->second);
+        ++last;
+    }
+    first = ranges_.erase(first, last);
+    ranges_.insert(first, Range{begin, end});
+}
+
+void IntervalSet::add(const IntervalSet& other) {
+    for (const Range& range : other.ranges_) {
+        add(range.first, range.second);
+    }
+}
+
+bool IntervalSet::contains(std::uint64_t position) const {
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), position, [](std::uint64_t value, const Range& range) {
+        return value < range.second;
+    });
+    return it != ranges_.end() && it->first <= position;
+}
+
+bool IntervalSet::covers(std::uint64_t begin, std::uint64_t end) const {
+    return begin >= end || count_within(begin, end) == end - begin;
+}
+
+std::uint64_t IntervalSet::count_within(std::uint64_t begin, std::uint64_t end) const {
+    std::uint64_t count = 0;
+    for (const Range& range : ranges_) {
+        if (range.first >= end) {
+            break;
+        }
+        std::uint64_t low = std::max(begin, range.first);
+        std::uint64_t high = std::min(end, range.second);
+        if (low < high) {
+            count += high - low;
+        }
+    }
+    return count;
+}
+
+IntervalSet IntervalSet::intersect(const IntervalSet& other) const {
+    IntervalSet result;
+    auto a = ranges_.begin();
+    auto b = other.ranges_.begin();
+    while (a != ranges_.end() && b != other.ranges_.end()) {
+        std::uint64_t low = std::max(a->first, b->first);
+        std::uint64_t high = std::min(a->second, b->second);
+        if (low < high) {
+            result.ranges_.push_back(Range{low, high});
+        }
+        if (a->second < b->second) {
+            ++a;
+        } else {
+            ++b;
+        }
+    }
+    return result;
+}
+
+bool SessionCoverage::open(const std::string& path, std::string& error) {
+    path_ = path;
+    records_.clear();
+    return read_records(path, records_, error);
+}
+
+IntervalSet SessionCoverage::covered(const std::vector<std::string>& documents, const std::string& generator) const {
+    IntervalSet result;
+    for (std::size_t i = 0; i < documents.size(); ++i) {
+        auto it = records_.find({documents[i], generator});
+        if (it == records_.end()) {
+            return IntervalSet();
+        }
+        result = i == 0 ? it->second : result.intersect(it->second);
+    }
+    return result;
+}
+
+std::string SessionCoverage::generator_kind(const std::string& generator) {
+    std::string kind;
+    std::size_t begin = 0;
+    while (begin <= generator.size()) {
+        std::size_t end = generator.find('+', begin);
+        if (end == std::string::npos) {
+            end = generator.size();
+        }
+        std::string part = generator.substr(begin, end - begin);
+        if (begin > 0) {
+            kind += '+';
+        }
+        kind += part.substr(0, part.find(':'));
+        if (part.find(":rules:") != std::string::npos) {
+            kind += ":rules";
+        }
+        begin = end + 1;
+    }
+    return kind;
+}
+
+bool SessionCoverage::has_records(const std::string& document, const std::string& kind) const {
+    for (auto it = records_.lower_bound({document, std::string()});
+         it != records_.end() && it->first.first == document; ++it) {
+        if (generator_kind(it->first.second) == kind) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SessionCoverage::add(const std::string& document, const std::string& generator, const IntervalSet& done) {
+    if (document.empty() || generator.empty() || done.empty()) {
+        return;
+    }
+    records_[{document, generator}].add(done);
+}
+
+bool SessionCoverage::save(std::string& error) const {
+    std::filesystem::path path(path_);
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    DatabaseLock lock(path_);
+    if (!lock.locked()) {
+        error = "cannot lock coverage database '" + path_ + "'";
+        return false;
+    }
+    // Other runs may have saved since this one opened the database; their
+    // records are merged in rather than overwritten.
+    Records records;
+    if (!read_records(path_, records, error)) {
+        return false;
+    }
+    for (const auto& [key, ranges] : records_) {
+        records[key].add(ranges);
+    }
+
+    std::filesystem::path temporary = path;
+    temporary += "." + std::to_string(unlock_pdf::util::current_process_id()) + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::trunc);
+        output << "# document\tgenerator\tcompleted ranges\n";
+        for (const auto& [key, ranges] : records) {
+            output << key.first << '\t' << key.second << '\t';
+            const char* separator = "";
+            for (const IntervalSet::Range& range : ranges.ranges()) {
+                output << separator << range.first << '-' << range.second;
+                separator = ",";
+            }
+            output << '\n';
+        }
+        if (!output) {
+            error = "cannot write coverage database '" + path_ + "'";
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        error = "cannot replace coverage database '" + path_ + "': " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::string default_session_coverage_path() {
+    std::string directory = unlock_pdf::util::user_cache_directory();
+    if (directory.empty()) {
+        return std::string();
+    }
+    return (std::filesystem::path(directory) / kCoverageFileName).string();
+}
+
+}  // namespace unlock_pdf::pdf
@@ -0,0 +1,188 @@
+#include "pdf/structure_index.h"
+
+#include <cctype>
+#include <deque>
+#include <string>
+
+namespace unlock_pdf::pdf {
+namespace {
+
+struct KeywordSpec {
+    std::string_view token;
+    bool require_word_boundaries;
+};
+
+constexpr KeywordSpec kKeywords[kStructureKeywordCount] = {
+    {"/Encrypt", true}, {"obj", true},     {"endobj", true},  {"/Filter", true},
+    {"/V ", false},     {"/R ", false},    {"/O", true},      {"/U", true},
+    {"/Length", true},  {"/CF", true},     {"/StmF", true},   {"/StrF", true},
+    {"/AESV3", true},   {"/ID", true},     {"trailer", true}, {"xref", true},
+    {"startxref", true}};
+
+bool is_word_char(char ch) {
+    return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+}
+
+bool has_word_boundaries(std::string_view data, std::size_t start, std::size_t length) {
+    if (start > 0 && is_word_char(data[start - 1])) {
+        return false;
+    }
+    std::size_t end = start + length;
+    return end >= data.size() || !is_word_char(data[end]);
+}
+
+// Deterministic Aho-Corasick automaton over kKeywords. The goto and failure
+// functions are folded into one dense transition table, so the scan is a
+// single table lookup per byte; states that complete a keyword (directly or
+// through a failure link) carry the list of keywords ending there.
+class KeywordAutomaton {
+public:
+    KeywordAutomaton() {
+        add_state();
+        for (std::size_t id = 0; id < kStructureKeywordCount; ++id) {
+            std::uint16_t state = 0;
+            for (char ch : kKeywords[id].token) {
+                auto byte = static_cast<unsigned char>(ch);
+                if (next_[state][byte] == 0) {
+                    next_[state][byte] = add_state();
+                }
+                state = next_[state][byte];
+            }
+            outputs_[state].push_back(static_cast<std::uint8_t>(id));
+        }
+
+        std::vector<std::uint16_t> fail(next_.size(), 0);
+        std::deque<std::uint16_t> queue;
+        for (std::uint16_t& child : next_[0]) {
+            if (child != 0) {
+                queue.push_back(child);
+            }
+        }
+        while (!queue.empty()) {
+            std::uint16_t state = queue.front();
+            queue.pop_front();
+            const std::vector<std::uint8_t>& inherited = outputs_[fail[state]];
+            outputs_[state].insert(outputs_[state].end(), inherited.begin(), inherited.end());
+            for (std::size_t byte = 0; byte < 256; ++byte) {
+                std::uint16_t child = next_[state][byte];
+                if (child != 0) {
+                    fail[child] = next_[fail[state]][byte];
+                    queue.push_back(child);
+                } else {
+                    next_[state][byte] = next_[fail[state]][byte];
+                }
+            }
+        }
+    }
+
+    std::uint16_t step(std::uint16_t state, char ch) const {
+        return next_[state][static_cast<unsigned char>(ch)];
+    }
+
+    const std::vector<std::uint8_t>& outputs(std::uint16_t state) const { return outputs_[state]; }
+
+private:
+    std::uint16_t add_state() {
+        next_.emplace_back();
+        next_.back().fill(0);
+        outputs_.emplace_back();
+        return static_cast<std::uint16_t>(next_.size() - 1);
+    }
+
+    std::vector<std::array<std::uint16_t, 256>> next_;
+    std::vector<std::vector<std::uint8_t>> outputs_;
+};
+
+const KeywordAutomaton& keyword_automaton() {
+    static const KeywordAutomaton automaton;
+    return automaton;
+}
+
+bool is_pdf_space(char ch) {
+    return std::isspace(static_cast<unsigned char>(ch)) || ch == '\0';
+}
+
+// Reads the decimal number ending just before `end`, moving `end` to its
+// first digit. Numbers longer than 19 digits are not object numbers.
+bool parse_number_backwards(std::string_view data, std::size_t& end, std::uint64_t& value) {
+    std::size_t start = end;
+    while (start > 0 && std::isdigit(static_cast<unsigned char>(data[start - 1]))) {
+        --start;
+    }
+    if (start == end || end - start > 19) {
+        return false;
+    }
+    value = std::stoull(std::string(data.substr(start, end - start)));
+    end = start;
+    return true;
+}
+
+// Recognises "N G obj" ending at the "obj" found at `obj_pos`.
+bool parse_object_header(std::string_view data, std::size_t obj_pos, ObjectHeader& header) {
+    std::size_t pos = obj_pos;
+    if (pos == 0 || !is_pdf_space(data[pos - 1])) {
+        return false;
+    }
+    while (pos > 0 && is_pdf_space(data[pos - 1])) {
+        --pos;
+    }
+    if (!parse_number_backwards(data, pos, header.generation)) {
+        return false;
+    }
+    if (pos == 0 || !is_pdf_space(data[pos - 1])) {
+        return false;
+    }
+    while (pos > 0 && is_pdf_space(data[pos - 1])) {
+        --pos;
+    }
+    if (!parse_number_backwards(data, pos, header.number)) {
+        return false;
+    }
+    if (pos > 0 && is_word_char(data[pos - 1])) {
+        return false;
+    }
+    header.offset = pos;
+    return true;
+}
+
+}  // namespace
+
+std::string_view structure_keyword_token(StructureKeyword keyword) {
+    return kKeywords[static_cast<std::size_t>(keyword)].token;
+}
+
+StructureIndex StructureIndex::build(std::string_view data) {
+    StructureIndex index;
+    const KeywordAutomaton& automaton = keyword_automaton();
+    const auto obj_id = static_cast<std::uint8_t>(StructureKeyword::Obj);
+
+    std::uint16_t state = 0;
+    for (std::size_t pos = 0; pos < data.size(); ++pos) {
+        state = automaton.step(state, data[pos]);
+        const std::vector<std::uint8_t>& matched = automaton.outputs(state);
+        for (std::uint8_t id : matched) {
+            const KeywordSpec& spec = kKeywords[id];
+            std::size_t start = pos + 1 - spec.token.size();
+            if (spec.require_word_boundaries && !has_word_boundaries(data, start, spec.token.size())) {
+                continue;
+            }
+            index.offsets_[id].push_back(start);
+            ObjectHeader header;
+            if (id == obj_id && parse_object_header(data, start, header)) {
+                index.objects_.push_back(header);
+            }
+        }
+    }
+    return index;
+}
+
+std::size_t StructureIndex::find_object(std::uint64_t number, std::uint64_t generation) const {
+    for (auto it = objects_.rbegin(); it != objects_.rend(); ++it) {
+        if (it->number == number && it->generation == generation) {
+            return it->offset;
+        }
+    }
+    return std::string_view::npos;
+}
+
+}  // namespace unlock_pdf::pdf
@@ -0,0 +1,431 @@
+#include "pdf/test_pdf_generator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "crypto/aes.h"
+#include "crypto/md5.h"
+#include "crypto/rc4.h"
+#include "pdf/encryption/standard_security_utils.h"
+#include "util/hex.h"
+
+namespace unlock_pdf::pdf {
+namespace {
+
+using Bytes = std::vector<unsigned char>;
+
+enum class ObjectCipher { Rc4, AesV2, AesV3 };
+
+struct EncryptionContext {
+    int revision = 0;
+    ObjectCipher cipher = ObjectCipher::Rc4;
+    Bytes file_key;
+    std::mt19937* rng = nullptr;
+};
+
+Bytes random_bytes(std::mt19937& rng, std::size_t count) {
+    std::uniform_int_distribution<int> distribution(0, 255);
+    Bytes bytes(count);
+    for (auto& byte : bytes) {
+        byte = static_cast<unsigned char>(distribution(rng));
+    }
+    return bytes;
+}
+
+using unlock_pdf::util::to_hex;
+
+void rc4_in_place(const Bytes& key, Bytes& data) {
+    unlock_pdf::crypto::RC4 rc4(key);
+    rc4.crypt(data.data(), data.data(), data.size());
+}
+
+// Applies the R3+ "19 more RC4 passes with the key XORed by the pass number"
+// step shared by the O and U computations.
+void rc4_iterations(const Bytes& key, Bytes& data) {
+    for (int i = 1; i <= 19; ++i) {
+        Bytes iteration_key = key;
+        for (auto& byte : iteration_key) {
+            byte ^= static_cast<unsigned char>(i);
+        }
+        rc4_in_place(iteration_key, data);
+    }
+}
+
+// ISO 32000-1 algorithm 3.
+Bytes compute_owner_entry(const std::string& owner_password,
+                          const std::string& user_password,
+                          int revision,
+                          std::size_t key_length_bytes) {
+    using unlock_pdf::crypto::md5_bytes;
+    using standard_security::pad_password;
+
+    Bytes digest = md5_bytes(pad_password(owner_password));
+    if (revision >= 3) {
+        for (int i = 0; i < 50; ++i) {
+            digest = md5_bytes(digest);
+        }
+    }
+    digest.resize(key_length_bytes);
+
+    Bytes data = pad_password(user_password);
+    rc4_in_place(digest, data);
+    if (revision >= 3) {
+        rc4_iterations(digest, data);
+    }
+    return data;
+}
+
+// ISO 32000-1 algorithms 4 and 5.
+Bytes compute_user_entry(const Bytes& file_key, const PDFEncryptInfo& info, int revision, std::mt19937& rng) {
+    Bytes padding = standard_security::pad_password(std::string());
+    if (revision <= 2) {
+        rc4_in_place(file_key, padding);
+        return padding;
+    }
+
+    Bytes input = padding;
+    input.insert(input.end(), info.id.begin(), info.id.end());
+    Bytes data = unlock_pdf::crypto::md5_bytes(input);
+    rc4_in_place(file_key, data);
+    rc4_iterations(file_key, data);
+
+    Bytes arbitrary = random_bytes(rng, 16);
+    data.insert(data.end(), arbitrary.begin(), arbitrary.end());
+    return data;
+}
+
+std::string truncate_utf8_password(const std::string& password) {
+    return password.size() > 127 ? password.substr(0, 127) : password;
+}
+
+// ISO 32000-2 algorithms 8 and 9: returns hash || validation salt || key salt
+// and the wrapped file key.
+bool compute_v5_entry(const std::string& password,
+                      const Bytes& user_entry,
+                      const Bytes& file_key,
+                      int revision,
+                      std::mt19937& rng,
+                      Bytes& entry,
+                      Bytes& wrapped_key) {
+    using standard_security::compute_hash_v5;
+
+    Bytes validation_salt = random_bytes(rng, 8);
+    Bytes key_salt = random_bytes(rng, 8);
+    const unsigned char* user_data = user_entry.empty() ? nullptr : user_entry.data();
+
+    entry = compute_hash_v5(password, validation_salt.data(), 8, user_data, user_entry.size(), revision);
+    if (entry.size() < 32) {
+        return false;
+    }
+    entry.resize(32);
+    entry.insert(entry.end(), validation_salt.begin(), validation_salt.end());
+    entry.insert(entry.end(), key_salt.begin(), key_salt.end());
+
+    Bytes intermediate = compute_hash_v5(password, key_salt.data(), 8, user_data, user_entry.size(), revision);
+    if (intermediate.size() < 32) {
+        return false;
+    }
+    intermediate.resize(32);
+    return unlock_pdf::crypto::aes256_cbc_encrypt(intermediate, Bytes(16, 0), file_key, wrapped_key);
+}
+
+// ISO 32000-2 algorithm 10.
+Bytes compute_perms_entry(const Bytes& file_key, const PDFEncryptInfo& info, std::mt19937& rng) {
+    auto permissions = static_cast<std::uint32_t>(info.permissions);
+    Bytes block(16);
+    for (int i = 0; i < 4; ++i) {
+        block[i] = static_cast<unsigned char>((permissions >> (8 * i)) & 0xFFu);
+        block[4 + i] = 0xFF;
+    }
+    block[8] = info.encrypt_metadata ? 'T' : 'F';
+    block[9] = 'a';
+    block[10] = 'd';
+    block[11] = 'b';
+    Bytes tail = random_bytes(rng, 4);
+    std::copy(tail.begin(), tail.end(), block.begin() + 12);
+
+    Bytes encrypted(16);
+    unlock_pdf::crypto::AES256Encryptor encryptor(file_key);
+    encryptor.encrypt_block(block.data(), encrypted.data());
+    return encrypted;
+}
+
+Bytes add_pkcs7_padding(Bytes data) {
+    std::size_t padding = 16 - (data.size() % 16);
+    data.insert(data.end(), padding, static_cast<unsigned char>(padding));
+    return data;
+}
+
+// ISO 32000-1 algorithm 1 (and the AESV3 rule of using the file key as is).
+std::string encrypt_object_data(const std::string& plain, int object_number, const EncryptionContext& context) {
+    Bytes data(plain.begin(), plain.end());
+
+    Bytes key = context.file_key;
+    if (context.cipher != ObjectCipher::AesV3) {
+        Bytes input = context.file_key;
+        input.push_back(static_cast<unsigned char>(object_number & 0xFF));
+        input.push_back(static_cast<unsigned char>((object_number >> 8) & 0xFF));
+        input.push_back(static_cast<unsigned char>((object_number >> 16) & 0xFF));
+        input.push_back(0);
+        input.push_back(0);
+        if (context.cipher == ObjectCipher::AesV2) {
+            const unsigned char salt[4] = {'s', 'A', 'l', 'T'};
+            input.insert(input.end(), std::begin(salt), std::end(salt));
+        }
+        key = unlock_pdf::crypto::md5_bytes(input);
+        key.resize(std::min<std::size_t>(context.file_key.size() + 5, 16));
+    }
+
+    if (context.cipher == ObjectCipher::Rc4) {
+        rc4_in_place(key, data);
+        return std::string(data.begin(), data.end());
+    }
+
+    Bytes iv = random_bytes(*context.rng, 16);
+    Bytes ciphertext;
+    Bytes padded = add_pkcs7_padding(std::move(data));
+    bool ok = context.cipher == ObjectCipher::AesV2
+                  ? unlock_pdf::crypto::aes128_cbc_encrypt(key, iv, padded, ciphertext)
+                  : unlock_pdf::crypto::aes256_cbc_encrypt(key, iv, padded, ciphertext);
+    if (!ok) {
+        return std::string();
+    }
+    std::string out(iv.begin(), iv.end());
+    out.append(ciphertext.begin(), ciphertext.end());
+    return out;
+}
+
+int default_key_length(const TestPdfOptions& options) {
+    if (options.revision <= 2) {
+        return 40;
+    }
+    if (options.revision <= 4) {
+        return 128;
+    }
+    return 256;
+}
+
+bool validate_options(const TestPdfOptions& options, int key_length_bits) {
+    if (options.revision < 2 || options.revision > 6) {
+        std::cerr << "Error: revision must be between 2 and 6" << std::endl;
+        return false;
+    }
+    if (options.revision == 2 && key_length_bits != 40) {
+        std::cerr << "Error: revision 2 only supports 40-bit keys" << std::endl;
+        return false;
+    }
+    if (options.revision >= 5 && key_length_bits != 256) {
+        std::cerr << "Error: revisions 5 and 6 only support 256-bit keys" << std::endl;
+        return false;
+    }
+    if (options.revision == 4 && options.cipher == TestPdfCipher::Aes && key_length_bits != 128) {
+        std::cerr << "Error: AESV2 only supports 128-bit keys" << std::endl;
+        return false;
+    }
+    if ((options.revision == 3 || options.revision == 4) &&
+        (key_length_bits < 40 || key_length_bits > 128 || key_length_bits % 8 != 0)) {
+        std::cerr << "Error: RC4 key length must be a multiple of 8 between 40 and 128 bits" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* header_version(int revision) {
+    switch (revision) {
+        case 2:
+            return "1.3";
+        case 3:
+            return "1.4";
+        case 4:
+            return "1.6";
+        case 5:
+            return "1.7";
+        default:
+            return "2.0";
+    }
+}
+
+std::string build_encrypt_dictionary(const PDFEncryptInfo& info) {
+    std::ostringstream dict;
+    dict << "<< ";
+    if (info.version >= 4) {
+        dict << "/CF << /StdCF << /AuthEvent /DocOpen /CFM /" << info.crypt_filter_method << " /Length "
+             << info.length / 8 << " >> >> ";
+        if (!info.encrypt_metadata) {
+            dict << "/EncryptMetadata false ";
+        }
+    }
+    dict << "/Filter /Standard /Length " << info.length << " /O <" << to_hex(info.o_string) << "> ";
+    if (info.revision >= 5) {
+        dict << "/OE <" << to_hex(info.oe_string) << "> ";
+    }
+    dict << "/P " << info.permissions << ' ';
+    if (info.revision >= 5) {
+        dict << "/Perms <" << to_hex(info.perms) << "> ";
+    }
+    dict << "/R " << info.revision << ' ';
+    if (info.version >= 4) {
+        dict << "/StmF /StdCF /StrF /StdCF ";
+    }
+    dict << "/U <" << to_hex(info.u_string) << "> ";
+    if (info.revision >= 5) {
+        dict << "/UE <" << to_hex(info.ue_string) << "> ";
+    }
+    dict << "/V " << info.version << " >>";
+    return dict.str();
+}
+
+}  // namespace
+
+std::string describe_test_pdf(const TestPdfOptions& options) {
+    int key_length_bits = options.key_length_bits > 0 ? options.key_length_bits : default_key_length(options);
+    std::string method;
+    if (options.revision >= 5) {
+        method = "AESV3";
+    } else if (options.revision == 4 && options.cipher == TestPdfCipher::Aes) {
+        method = "AESV2";
+    } else {
+        method = "RC4";
+    }
+    return "R" + std::to_string(options.revision) + ' ' + method + ' ' + std::to_string(key_length_bits) + "-bit";
+}
+
+bool build_test_pdf(const TestPdfOptions& options, std::string& pdf, PDFEncryptInfo& info) {
+    int key_length_bits = options.key_length_bits > 0 ? options.key_length_bits : default_key_length(options);
+    if (!validate_options(options, key_length_bits)) {
+        return false;
+    }
+
+    std::mt19937 rng(options.seed != 0 ? options.seed : std::random_device{}());
+    const int revision = options.revision;
+    const std::string& owner_password = options.owner_password.empty() ? options.user_password : options.owner_password;
+
+    info = PDFEncryptInfo{};
+    info.encrypted = true;
+    info.filter = "Standard";
+    info.revision = revision;
+    info.length = key_length_bits;
+    info.permissions = options.permissions;
+    info.encrypt_metadata = revision >= 4 ? options.encrypt_metadata : true;
+    info.id = random_bytes(rng, 16);
+
+    EncryptionContext context;
+    context.revision = revision;
+    context.rng = &rng;
+
+    if (revision <= 4) {
+        info.version = revision == 2 ? 1 : (revision == 3 ? 2 : 4);
+        context.cipher = (revision == 4 && options.cipher == TestPdfCipher::Aes) ? ObjectCipher::AesV2 : ObjectCipher::Rc4;
+        if (revision == 4) {
+            info.crypt_filter = "StdCF";
+            info.stream_filter = "StdCF";
+            info.string_filter = "StdCF";
+            info.crypt_filter_method = context.cipher == ObjectCipher::AesV2 ? "AESV2" : "V2";
+        }
+
+        std::size_t key_length_bytes = static_cast<std::size_t>(key_length_bits / 8);
+        info.o_string = compute_owner_entry(owner_password, options.user_password, revision, key_length_bytes);
+        context.file_key =
+            standard_security::compute_encryption_key(options.user_password, info, revision, key_length_bits);
+        if (context.file_key.empty()) {
+            std::cerr << "Error: failed to derive the file encryption key" << std::endl;
+            return false;
+        }
+        info.u_string = compute_user_entry(context.file_key, info, revision, rng);
+    } else {
+        info.version = 5;
+        info.crypt_filter = "StdCF";
+        info.stream_filter = "StdCF";
+        info.string_filter = "StdCF";
+        info.crypt_filter_method = "AESV3";
+        context.cipher = ObjectCipher::AesV3;
+        context.file_key = random_bytes(rng, 32);
+
+        std::string user = truncate_utf8_password(options.user_password);
+        std::string owner = truncate_utf8_password(owner_password);
+        if (!compute_v5_entry(user, Bytes(), context.file_key, revision, rng, info.u_string, info.ue_string) ||
+            !compute_v5_entry(owner, info.u_string, context.file_key, revision, rng, info.o_string, info.oe_string)) {
+            std::cerr << "Error: failed to compute the revision " << revision << " password entries" << std::endl;
+            return false;
+        }
+        info.perms = compute_perms_entry(context.file_key, info, rng);
+    }
+
+    const std::string content =
+        "BT /F1 24 Tf 72 720 Td (unlock_pdf test document) Tj ET\n"
+        "BT /F1 12 Tf 72 690 Td (" + describe_test_pdf(options) + ") Tj ET\n";
+    const std::string metadata =
+        "<?xpacket begin=\"\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>\n"
+        "<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"><rdf:RDF xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\">"
+        "<rdf:Description rdf:about=\"\" xmlns:pdf=\"http://ns.adobe.com/pdf/1.3/\">"
+        "<pdf:Producer>unlock_pdf make_test_pdf</pdf:Producer></rdf:Description></rdf:RDF></x:xmpmeta>\n"
+        "<?xpacket end=\"w\"?>";
+
+    std::string encrypted_content = encrypt_object_data(content, 4, context);
+    std::string stored_metadata = info.encrypt_metadata ? encrypt_object_data(metadata, 6, context) : metadata;
+    if (encrypted_content.empty() || stored_metadata.empty()) {
+        std::cerr << "Error: failed to encrypt the document streams" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> objects;
+    objects.push_back("<< /Metadata 6 0 R /Pages 2 0 R /Type /Catalog >>");
+    objects.push_back("<< /Count 1 /Kids [ 3 0 R ] /MediaBox [ 0 0 612 792 ] /Type /Pages >>");
+    objects.push_back("<< /Contents 4 0 R /Parent 2 0 R /Resources << /Font << /F1 5 0 R >> >> /Type /Page >>");
+    objects.push_back("<< /Length " + std::to_string(encrypted_content.size()) + " >>\nstream\n" + encrypted_content +
+                      "\nendstream");
+    objects.push_back("<< /BaseFont /Helvetica /Encoding /WinAnsiEncoding /Subtype /Type1 /Type /Font >>");
+    objects.push_back("<< /Length " + std::to_string(stored_metadata.size()) +
+                      " /Subtype /XML /Type /Metadata >>\nstream\n" + stored_metadata + "\nendstream");
+    objects.push_back(build_encrypt_dictionary(info));
+
+    pdf.clear();
+    pdf += "%PDF-";
+    pdf += header_version(revision);
+    pdf += "\n%\xE2\xE3\xCF\xD3\n";
+
+    std::vector<std::size_t> offsets;
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+
+    std::size_t xref_offset = pdf.size();
+    std::ostringstream xref;
+    xref << "xref\n0 " << objects.size() + 1 << "\n0000000000 65535 f \n";
+    for (std::size_t offset : offsets) {
+        xref << std::setw(10) << std::setfill('0') << offset << " 00000 n \n";
+    }
+    std::string id_hex = to_hex(info.id);
+    xref << "trailer\n<< /Encrypt " << objects.size() << " 0 R /ID [ <" << id_hex << "> <" << id_hex
+         << "> ] /Root 1 0 R /Size " << objects.size() + 1 << " >>\nstartxref\n"
+         << xref_offset << "\n%%EOF\n";
+    pdf += xref.str();
+    return true;
+}
+
+bool write_test_pdf(const TestPdfOptions& options, const std::string& path, PDFEncryptInfo& info) {
+    std::string pdf;
+    if (!build_test_pdf(options, pdf, info)) {
+        return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: cannot write " << path << std::endl;
+        return false;
+    }
+    out.write(pdf.data(), static_cast<std::streamsize>(pdf.size()));
+    if (!out) {
+        std::cerr << "Error: failed while writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace unlock_pdf::pdf
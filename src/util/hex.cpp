@@ -0,0 +1,20 @@
+#include "util/hex.h"
+
+namespace unlock_pdf::util {
+
+std::string to_hex(const unsigned char* data, std::size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (std::size_t i = 0; i < size; ++i) {
+        hex += digits[data[i] >> 4];
+        hex += digits[data[i] & 0x0F];
+    }
+    return hex;
+}
+
+std::string to_hex(const std::vector<unsigned char>& data) {
+    return to_hex(data.data(), data.size());
+}
+
+}  // namespace unlock_pdf::util
@@ -0,0 +1,449 @@
+#include "util/inflate.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr int kMaxCodeBits = 15;
+constexpr std::size_t kMaxLiteralCodes = 288;
+constexpr std::size_t kMaxDistanceCodes = 30;
+
+constexpr std::array<std::uint16_t, 29> kLengthBase = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<std::uint8_t, 29> kLengthExtra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                                       2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<std::uint16_t, 30> kDistanceBase = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                                         33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                                         1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<std::uint8_t, 30> kDistanceExtra = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                                         6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order in which code length code lengths are stored in a dynamic block header.
+constexpr std::array<std::uint8_t, 19> kCodeLengthOrder = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                           11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+// LSB-first bit reader over the compressed bytes. At most seven unread bits
+// are buffered between calls, so aligning to a byte boundary just drops them.
+class BitReader {
+public:
+    BitReader(const unsigned char* data, std::size_t size) : data_(data), size_(size) {}
+
+    bool bits(int count, std::uint32_t& value) {
+        while (bit_count_ < count) {
+            if (position_ >= size_) {
+                return false;
+            }
+            buffer_ |= static_cast<std::uint32_t>(data_[position_++]) << bit_count_;
+            bit_count_ += 8;
+        }
+        value = buffer_ & ((1u << count) - 1u);
+        buffer_ >>= count;
+        bit_count_ -= count;
+        return true;
+    }
+
+    void align() {
+        buffer_ = 0;
+        bit_count_ = 0;
+    }
+
+    bool byte(std::uint8_t& value) {
+        if (position_ >= size_) {
+            return false;
+        }
+        value = data_[position_++];
+        return true;
+    }
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    std::size_t position_ = 0;
+    std::uint32_t buffer_ = 0;
+    int bit_count_ = 0;
+};
+
+// Canonical Huffman code: number of codes of each length and the symbols
+// ordered by code.
+struct Huffman {
+    std::array<std::uint16_t, kMaxCodeBits + 1> count{};
+    std::vector<std::uint16_t> symbols;
+};
+
+// Rejects over-subscribed code sets. Incomplete sets are allowed: deflate
+// uses them for single-code distance trees, and a code that is never sent
+// cannot be decoded anyway.
+bool build_huffman(Huffman& huffman, const std::uint8_t* lengths, std::size_t symbol_count) {
+    huffman.count.fill(0);
+    for (std::size_t i = 0; i < symbol_count; ++i) {
+        ++huffman.count[lengths[i]];
+    }
+    int left = 1;
+    for (int length = 1; length <= kMaxCodeBits; ++length) {
+        left <<= 1;
+        left -= huffman.count[length];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    std::array<std::uint16_t, kMaxCodeBits + 1> offsets{};
+    for (int length = 1; length < kMaxCodeBits; ++length) {
+        offsets[length + 1] = static_cast<std::uint16_t>(offsets[length] + huffman.count[length]);
+    }
+    huffman.symbols.assign(symbol_count, 0);
+    for (std::size_t symbol = 0; symbol < symbol_count; ++symbol) {
+        if (lengths[symbol] != 0) {
+            huffman.symbols[offsets[lengths[symbol]]++] = static_cast<std::uint16_t>(symbol);
+        }
+    }
+    return true;
+}
+
+// Decodes one symbol bit by bit; -1 on truncated input or an unused code.
+int decode_symbol(BitReader& reader, const Huffman& huffman) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length <= kMaxCodeBits; ++length) {
+        std::uint32_t bit = 0;
+        if (!reader.bits(1, bit)) {
+            return -1;
+        }
+        code |= static_cast<int>(bit);
+        int count = huffman.count[length];
+        if (code - count < first) {
+            return huffman.symbols[static_cast<std::size_t>(index + (code - first))];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+class Inflater {
+public:
+    Inflater(BitReader& reader, std::vector<unsigned char>& output, std::size_t max_output)
+        : reader_(reader), output_(output), max_output_(max_output) {}
+
+    bool run(std::string& error) {
+        bool last = false;
+        while (!last) {
+            std::uint32_t header = 0;
+            if (!reader_.bits(3, header)) {
+                error = "truncated deflate block header";
+                return false;
+            }
+            last = (header & 1u) != 0;
+            bool ok = false;
+            switch (header >> 1) {
+                case 0:
+                    ok = stored(error);
+                    break;
+                case 1:
+                    ok = fixed(error);
+                    break;
+                case 2:
+                    ok = dynamic(error);
+                    break;
+                default:
+                    error = "invalid deflate block type";
+                    return false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool emit(unsigned char value, std::string& error) {
+        if (output_.size() >= max_output_) {
+            error = "decoded data exceeds the size limit";
+            return false;
+        }
+        output_.push_back(value);
+        return true;
+    }
+
+    bool stored(std::string& error) {
+        reader_.align();
+        std::uint8_t bytes[4];
+        for (auto& value : bytes) {
+            if (!reader_.byte(value)) {
+                error = "truncated stored block";
+                return false;
+            }
+        }
+        unsigned int length = bytes[0] | (bytes[1] << 8);
+        unsigned int complement = bytes[2] | (bytes[3] << 8);
+        if (length != (~complement & 0xffffu)) {
+            error = "stored block length mismatch";
+            return false;
+        }
+        for (unsigned int i = 0; i < length; ++i) {
+            std::uint8_t value = 0;
+            if (!reader_.byte(value)) {
+                error = "truncated stored block";
+                return false;
+            }
+            if (!emit(value, error)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool fixed(std::string& error) {
+        static const auto tables = [] {
+            std::array<Huffman, 2> built;
+            std::array<std::uint8_t, kMaxLiteralCodes> lengths{};
+            for (std::size_t i = 0; i < kMaxLiteralCodes; ++i) {
+                lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+            }
+            build_huffman(built[0], lengths.data(), kMaxLiteralCodes);
+            lengths.fill(5);
+            build_huffman(built[1], lengths.data(), kMaxDistanceCodes);
+            return built;
+        }();
+        return codes(tables[0], tables[1], error);
+    }
+
+    bool dynamic(std::string& error) {
+        std::uint32_t literal_count = 0;
+        std::uint32_t distance_count = 0;
+        std::uint32_t code_length_count = 0;
+        if (!reader_.bits(5, literal_count) || !reader_.bits(5, distance_count) ||
+            !reader_.bits(4, code_length_count)) {
+            error = "truncated dynamic block header";
+            return false;
+        }
+        literal_count += 257;
+        distance_count += 1;
+        code_length_count += 4;
+        if (literal_count > 286 || distance_count > kMaxDistanceCodes) {
+            error = "invalid dynamic block code counts";
+            return false;
+        }
+
+        std::array<std::uint8_t, 19> code_lengths{};
+        for (std::uint32_t i = 0; i < code_length_count; ++i) {
+            std::uint32_t value = 0;
+            if (!reader_.bits(3, value)) {
+                error = "truncated dynamic block header";
+                return false;
+            }
+            code_lengths[kCodeLengthOrder[i]] = static_cast<std::uint8_t>(value);
+        }
+        Huffman code_length_code;
+        if (!build_huffman(code_length_code, code_lengths.data(), code_lengths.size())) {
+            error = "invalid code length code";
+            return false;
+        }
+
+        std::array<std::uint8_t, kMaxLiteralCodes + kMaxDistanceCodes> lengths{};
+        std::uint32_t index = 0;
+        while (index < literal_count + distance_count) {
+            int symbol = decode_symbol(reader_, code_length_code);
+            if (symbol < 0) {
+                error = "invalid code length symbol";
+                return false;
+            }
+            if (symbol < 16) {
+                lengths[index++] = static_cast<std::uint8_t>(symbol);
+                continue;
+            }
+
+            std::uint8_t repeated = 0;
+            std::uint32_t repeat = 0;
+            bool ok = false;
+            if (symbol == 16) {
+                if (index == 0) {
+                    error = "code length repeat without a previous length";
+                    return false;
+                }
+                repeated = lengths[index - 1];
+                ok = reader_.bits(2, repeat);
+                repeat += 3;
+            } else if (symbol == 17) {
+                ok = reader_.bits(3, repeat);
+                repeat += 3;
+            } else {
+                ok = reader_.bits(7, repeat);
+                repeat += 11;
+            }
+            if (!ok || index + repeat > literal_count + distance_count) {
+                error = "invalid code length repeat";
+                return false;
+            }
+            while (repeat-- > 0) {
+                lengths[index++] = repeated;
+            }
+        }
+        if (lengths[256] == 0) {
+            error = "dynamic block has no end-of-block code";
+            return false;
+        }
+
+        Huffman literal_code;
+        Huffman distance_code;
+        if (!build_huffman(literal_code, lengths.data(), literal_count) ||
+            !build_huffman(distance_code, lengths.data() + literal_count, distance_count)) {
+            error = "invalid dynamic block codes";
+            return false;
+        }
+        return codes(literal_code, distance_code, error);
+    }
+
+    bool codes(const Huffman& literal_code, const Huffman& distance_code, std::string& error) {
+        while (true) {
+            int symbol = decode_symbol(reader_, literal_code);
+            if (symbol < 0) {
+                error = "invalid literal/length code";
+                return false;
+            }
+            if (symbol < 256) {
+                if (!emit(static_cast<unsigned char>(symbol), error)) {
+                    return false;
+                }
+                continue;
+            }
+            if (symbol == 256) {
+                return true;
+            }
+
+            std::size_t length_index = static_cast<std::size_t>(symbol - 257);
+            if (length_index >= kLengthBase.size()) {
+                error = "invalid length code";
+                return false;
+            }
+            std::uint32_t extra = 0;
+            if (!reader_.bits(kLengthExtra[length_index], extra)) {
+                error = "truncated length";
+                return false;
+            }
+            std::size_t length = kLengthBase[length_index] + extra;
+
+            int distance_symbol = decode_symbol(reader_, distance_code);
+            if (distance_symbol < 0 || static_cast<std::size_t>(distance_symbol) >= kDistanceBase.size()) {
+                error = "invalid distance code";
+                return false;
+            }
+            if (!reader_.bits(kDistanceExtra[distance_symbol], extra)) {
+                error = "truncated distance";
+                return false;
+            }
+            std::size_t distance = kDistanceBase[distance_symbol] + extra;
+            if (distance > output_.size()) {
+                error = "distance points before the start of the data";
+                return false;
+            }
+            // Byte by byte: the source may overlap the bytes being written.
+            for (std::size_t i = 0; i < length; ++i) {
+                if (!emit(output_[output_.size() - distance], error)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    BitReader& reader_;
+    std::vector<unsigned char>& output_;
+    std::size_t max_output_;
+};
+
+unsigned char paeth(unsigned char left, unsigned char up, unsigned char up_left) {
+    int estimate = static_cast<int>(left) + static_cast<int>(up) - static_cast<int>(up_left);
+    int distance_left = std::abs(estimate - static_cast<int>(left));
+    int distance_up = std::abs(estimate - static_cast<int>(up));
+    int distance_up_left = std::abs(estimate - static_cast<int>(up_left));
+    if (distance_left <= distance_up && distance_left <= distance_up_left) {
+        return left;
+    }
+    return distance_up <= distance_up_left ? up : up_left;
+}
+
+}  // namespace
+
+bool inflate_zlib(std::string_view input,
+                  std::vector<unsigned char>& output,
+                  std::size_t max_output,
+                  std::string& error) {
+    output.clear();
+    const auto* bytes = reinterpret_cast<const unsigned char*>(input.data());
+    std::size_t offset = 0;
+    if (input.size() >= 2) {
+        unsigned int method = bytes[0];
+        unsigned int flags = bytes[1];
+        bool zlib_header = (method & 0x0fu) == 8 && (method >> 4) <= 7 && ((method << 8) | flags) % 31 == 0;
+        if (zlib_header) {
+            if ((flags & 0x20u) != 0) {
+                error = "zlib preset dictionaries are not supported";
+                return false;
+            }
+            offset = 2;
+        }
+    }
+
+    BitReader reader(bytes + offset, input.size() - offset);
+    Inflater inflater(reader, output, max_output);
+    return inflater.run(error);
+}
+
+bool undo_png_predictor(const std::vector<unsigned char>& input,
+                        std::size_t colors,
+                        std::size_t bits_per_component,
+                        std::size_t columns,
+                        std::vector<unsigned char>& output,
+                        std::string& error) {
+    output.clear();
+    if (colors == 0 || bits_per_component == 0 || columns == 0) {
+        error = "invalid predictor parameters";
+        return false;
+    }
+    std::size_t bytes_per_pixel = (colors * bits_per_component + 7) / 8;
+    std::size_t row_size = (columns * colors * bits_per_component + 7) / 8;
+
+    std::vector<unsigned char> previous(row_size, 0);
+    std::vector<unsigned char> row(row_size, 0);
+    output.reserve(input.size() / (row_size + 1) * row_size);
+    for (std::size_t start = 0; start + row_size + 1 <= input.size(); start += row_size + 1) {
+        unsigned char filter = input[start];
+        const unsigned char* source = input.data() + start + 1;
+        for (std::size_t i = 0; i < row_size; ++i) {
+            unsigned char left = i >= bytes_per_pixel ? row[i - bytes_per_pixel] : 0;
+            unsigned char up = previous[i];
+            unsigned char up_left = i >= bytes_per_pixel ? previous[i - bytes_per_pixel] : 0;
+            switch (filter) {
+                case 0:
+                    row[i] = source[i];
+                    break;
+                case 1:
+                    row[i] = static_cast<unsigned char>(source[i] + left);
+                    break;
+                case 2:
+                    row[i] = static_cast<unsigned char>(source[i] + up);
+                    break;
+                case 3:
+                    row[i] = static_cast<unsigned char>(source[i] + ((left + up) >> 1));
+                    break;
+                case 4:
+                    row[i] = static_cast<unsigned char>(source[i] + paeth(left, up, up_left));
+                    break;
+                default:
+                    error = "invalid PNG filter type " + std::to_string(filter);
+                    return false;
+            }
+        }
+        output.insert(output.end(), row.begin(), row.end());
+        previous.swap(row);
+    }
+    return true;
+}
+
+}  // namespace unlock_pdf::util
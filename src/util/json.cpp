@@ -0,0 +1,73 @@
+#include "util/json.h"
+
+namespace unlock_pdf::util {
+namespace {
+
+// Bytes in the well-formed UTF-8 sequence starting at `value[i]`, 0 when the
+// byte there does not start one.
+std::size_t utf8_sequence_length(const std::string& value, std::size_t i) {
+    auto byte = [&](std::size_t offset) {
+        return i + offset < value.size() ? static_cast<unsigned char>(value[i + offset]) : 0;
+    };
+    auto continuation = [](unsigned char ch, unsigned char low = 0x80, unsigned char high = 0xBF) {
+        return ch >= low && ch <= high;
+    };
+    unsigned char lead = byte(0);
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        return continuation(byte(1)) ? 2 : 0;
+    }
+    if (lead >= 0xE0 && lead <= 0xEF) {
+        unsigned char low = lead == 0xE0 ? 0xA0 : 0x80;   // overlong
+        unsigned char high = lead == 0xED ? 0x9F : 0xBF;  // surrogates
+        return continuation(byte(1), low, high) && continuation(byte(2)) ? 3 : 0;
+    }
+    if (lead >= 0xF0 && lead <= 0xF4) {
+        unsigned char low = lead == 0xF0 ? 0x90 : 0x80;   // overlong
+        unsigned char high = lead == 0xF4 ? 0x8F : 0xBF;  // past U+10FFFF
+        return continuation(byte(1), low, high) && continuation(byte(2)) && continuation(byte(3)) ? 4 : 0;
+    }
+    return 0;
+}
+
+}  // namespace
+
+std::string json_escape(const std::string& value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string escaped;
+    escaped.reserve(value.size() + 2);
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        char ch = value[i];
+        switch (ch) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default: {
+                unsigned char byte = static_cast<unsigned char>(ch);
+                std::size_t length = byte >= 0x80 ? utf8_sequence_length(value, i) : 1;
+                if (byte >= 0x20 && length > 0) {
+                    escaped.append(value, i, length);
+                    i += length - 1;
+                } else {
+                    escaped += "\\u00";
+                    escaped += digits[byte >> 4];
+                    escaped += digits[byte & 0x0F];
+                }
+            }
+        }
+    }
+    return escaped;
+}
+
+}  // namespace unlock_pdf::util
@@ -0,0 +1,142 @@
+#include "util/keyspace.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr std::uint64_t kMax64 = std::numeric_limits<std::uint64_t>::max();
+
+// Full 64x64 -> 128-bit product from 32-bit partial products.
+void multiply_64(std::uint64_t a, std::uint64_t b, std::uint64_t& high, std::uint64_t& low) {
+    std::uint64_t a_low = a & 0xffffffffu;
+    std::uint64_t a_high = a >> 32;
+    std::uint64_t b_low = b & 0xffffffffu;
+    std::uint64_t b_high = b >> 32;
+
+    std::uint64_t p0 = a_low * b_low;
+    std::uint64_t p1 = a_low * b_high;
+    std::uint64_t p2 = a_high * b_low;
+    std::uint64_t p3 = a_high * b_high;
+
+    std::uint64_t middle = (p0 >> 32) + (p1 & 0xffffffffu) + (p2 & 0xffffffffu);
+    low = (middle << 32) | (p0 & 0xffffffffu);
+    high = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+}
+
+}  // namespace
+
+Keyspace Keyspace::from_parts(std::uint64_t high, std::uint64_t low) {
+    Keyspace value;
+    value.high_ = high;
+    value.low_ = low;
+    return value;
+}
+
+Keyspace Keyspace::saturated() {
+    Keyspace value = from_parts(kMax64, kMax64);
+    value.overflowed_ = true;
+    return value;
+}
+
+Keyspace& Keyspace::operator+=(const Keyspace& other) {
+    if (overflowed_ || other.overflowed_) {
+        return *this = saturated();
+    }
+    std::uint64_t low = low_ + other.low_;
+    std::uint64_t carry = low < low_ ? 1 : 0;
+    if (high_ > kMax64 - other.high_ || high_ + other.high_ > kMax64 - carry) {
+        return *this = saturated();
+    }
+    high_ = high_ + other.high_ + carry;
+    low_ = low;
+    return *this;
+}
+
+Keyspace& Keyspace::operator*=(const Keyspace& other) {
+    if (is_zero() || other.is_zero()) {
+        return *this = Keyspace();
+    }
+    if (overflowed_ || other.overflowed_ || (high_ != 0 && other.high_ != 0)) {
+        return *this = saturated();
+    }
+
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+    multiply_64(low_, other.low_, high, low);
+
+    // At most one of the cross terms is non-zero; it must fit in the high half.
+    std::uint64_t cross_high = 0;
+    std::uint64_t cross_low = 0;
+    multiply_64(high_ != 0 ? high_ : other.high_, high_ != 0 ? other.low_ : low_, cross_high, cross_low);
+    if (cross_high != 0 || high > kMax64 - cross_low) {
+        return *this = saturated();
+    }
+    high_ = high + cross_low;
+    low_ = low;
+    return *this;
+}
+
+Keyspace Keyspace::saturating_sub(const Keyspace& other) const {
+    if (!(other < *this)) {
+        return Keyspace();
+    }
+    std::uint64_t borrow = low_ < other.low_ ? 1 : 0;
+    Keyspace result = from_parts(high_ - other.high_ - borrow, low_ - other.low_);
+    result.overflowed_ = overflowed_;
+    return result;
+}
+
+double Keyspace::to_double() const {
+    return static_cast<double>(high_) * 18446744073709551616.0 + static_cast<double>(low_);
+}
+
+std::string Keyspace::to_string() const {
+    if (high_ == 0) {
+        return (overflowed_ ? ">" : "") + std::to_string(low_);
+    }
+
+    // Long division by 10 over four 32-bit limbs, most significant first.
+    std::uint32_t limbs[4] = {static_cast<std::uint32_t>(high_ >> 32),
+                              static_cast<std::uint32_t>(high_),
+                              static_cast<std::uint32_t>(low_ >> 32),
+                              static_cast<std::uint32_t>(low_)};
+    std::string digits;
+    while (std::any_of(std::begin(limbs), std::end(limbs), [](std::uint32_t limb) { return limb != 0; })) {
+        std::uint64_t remainder = 0;
+        for (auto& limb : limbs) {
+            std::uint64_t current = (remainder << 32) | limb;
+            limb = static_cast<std::uint32_t>(current / 10);
+            remainder = current % 10;
+        }
+        digits.push_back(static_cast<char>('0' + remainder));
+    }
+    std::reverse(digits.begin(), digits.end());
+    return (overflowed_ ? ">" : "") + digits;
+}
+
+Keyspace keyspace_power(std::uint64_t base, std::size_t exponent) {
+    Keyspace result(1);
+    Keyspace factor(base);
+    for (std::size_t i = 0; i < exponent; ++i) {
+        result *= factor;
+        if (result.overflowed() || result.is_zero()) {
+            break;
+        }
+    }
+    return result;
+}
+
+Keyspace charset_keyspace(std::size_t alphabet_size, std::size_t min_length, std::size_t max_length) {
+    Keyspace total;
+    for (std::size_t length = min_length; length <= max_length; ++length) {
+        total += keyspace_power(alphabet_size, length);
+        if (total.overflowed()) {
+            break;
+        }
+    }
+    return total;
+}
+
+}  // namespace unlock_pdf::util
@@ -0,0 +1,174 @@
+#include "util/markov_model.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr char kMagic[8] = {'U', 'P', 'D', 'F', 'M', 'K', 'V', '1'};
+
+void write_le(std::ostream& output, std::uint64_t value, std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        output.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+bool read_le(std::istream& input, std::uint64_t& value, std::size_t bytes) {
+    value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        int byte = input.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(byte) << (8 * i);
+    }
+    return true;
+}
+
+}  // namespace
+
+void MarkovStatistics::add(const std::string& word) {
+    if (word.empty()) {
+        return;
+    }
+    std::size_t length = std::min(word.size(), kMaxPositions);
+    unsigned char previous = 0;
+    for (std::size_t position = 0; position < length; ++position) {
+        unsigned char next = static_cast<unsigned char>(word[position]);
+        ++counts_[key(position, previous, next)];
+        previous = next;
+    }
+    positions_ = std::max(positions_, length);
+    ++words_;
+}
+
+bool MarkovStatistics::train(const std::string& wordlist_path, std::string& error) {
+    std::ifstream input(wordlist_path, std::ios::binary);
+    if (!input) {
+        error = "cannot open training wordlist '" + wordlist_path + "'";
+        return false;
+    }
+    std::string line;
+    bool first = true;
+    while (std::getline(input, line)) {
+        if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            line.erase(0, 3);
+        }
+        first = false;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        add(line);
+    }
+    if (input.bad()) {
+        error = "cannot read training wordlist '" + wordlist_path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool MarkovStatistics::save(const std::string& path, std::string& error) const {
+    std::vector<std::pair<std::uint32_t, std::uint64_t>> entries(counts_.begin(), counts_.end());
+    std::sort(entries.begin(), entries.end());
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(kMagic, sizeof(kMagic));
+    write_le(output, positions_, 4);
+    write_le(output, words_, 8);
+    write_le(output, entries.size(), 4);
+    for (const auto& [entry_key, count] : entries) {
+        output.put(static_cast<char>(entry_key >> 16));
+        output.put(static_cast<char>((entry_key >> 8) & 0xFF));
+        output.put(static_cast<char>(entry_key & 0xFF));
+        write_le(output, std::min<std::uint64_t>(count, 0xFFFFFFFFu), 4);
+    }
+    if (!output.flush()) {
+        error = "cannot write Markov statistics '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool MarkovStatistics::load(const std::string& path, std::string& error) {
+    counts_.clear();
+    words_ = 0;
+    positions_ = 0;
+
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        error = "cannot open Markov statistics '" + path + "'";
+        return false;
+    }
+    char magic[sizeof(kMagic)] = {};
+    std::uint64_t positions = 0;
+    std::uint64_t entries = 0;
+    if (!input.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic) ||
+        !read_le(input, positions, 4) || !read_le(input, words_, 8) || !read_le(input, entries, 4) ||
+        positions == 0 || positions > kMaxPositions) {
+        error = "'" + path + "' is not a Markov statistics file";
+        return false;
+    }
+    positions_ = static_cast<std::size_t>(positions);
+    for (std::uint64_t i = 0; i < entries; ++i) {
+        std::uint64_t position = 0;
+        std::uint64_t previous = 0;
+        std::uint64_t next = 0;
+        std::uint64_t count = 0;
+        if (!read_le(input, position, 1) || !read_le(input, previous, 1) || !read_le(input, next, 1) ||
+            !read_le(input, count, 4) || position >= positions_) {
+            error = "Markov statistics '" + path + "' are truncated or damaged";
+            return false;
+        }
+        counts_[key(static_cast<std::size_t>(position), static_cast<unsigned char>(previous),
+                    static_cast<unsigned char>(next))] = count;
+    }
+    return true;
+}
+
+std::uint64_t MarkovStatistics::count(std::size_t position, unsigned char previous, unsigned char next) const {
+    auto it = counts_.find(key(position, previous, next));
+    return it == counts_.end() ? 0 : it->second;
+}
+
+MarkovOrder::MarkovOrder(const MarkovStatistics& statistics, const std::string& alphabet, std::size_t threshold)
+    : positions_(std::max<std::size_t>(statistics.positions(), 1)),
+      radix_(threshold == 0 ? alphabet.size() : std::min(threshold, alphabet.size())) {
+    if (radix_ == 0) {
+        return;
+    }
+    table_.resize(positions_ * 256 * radix_);
+    std::vector<std::size_t> ranks(alphabet.size());
+    std::vector<std::uint64_t> pair_counts(alphabet.size());
+    std::vector<std::uint64_t> position_counts(alphabet.size());
+    for (std::size_t position = 0; position < positions_; ++position) {
+        std::fill(position_counts.begin(), position_counts.end(), 0);
+        for (std::size_t previous = 0; previous < 256; ++previous) {
+            for (std::size_t i = 0; i < alphabet.size(); ++i) {
+                position_counts[i] += statistics.count(position, static_cast<unsigned char>(previous),
+                                                       static_cast<unsigned char>(alphabet[i]));
+            }
+        }
+        for (std::size_t previous = 0; previous < 256; ++previous) {
+            for (std::size_t i = 0; i < alphabet.size(); ++i) {
+                pair_counts[i] = statistics.count(position, static_cast<unsigned char>(previous),
+                                                  static_cast<unsigned char>(alphabet[i]));
+            }
+            std::iota(ranks.begin(), ranks.end(), std::size_t{0});
+            std::stable_sort(ranks.begin(), ranks.end(), [&](std::size_t a, std::size_t b) {
+                if (pair_counts[a] != pair_counts[b]) {
+                    return pair_counts[a] > pair_counts[b];
+                }
+                return position_counts[a] > position_counts[b];
+            });
+            char* row = &table_[(position * 256 + previous) * radix_];
+            for (std::size_t rank = 0; rank < radix_; ++rank) {
+                row[rank] = alphabet[ranks[rank]];
+            }
+        }
+    }
+}
+
+}  // namespace unlock_pdf::util
@@ -0,0 +1,90 @@
+#include "util/mask.h"
+
+#include <limits>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr const char* kLower = "abcdefghijklmnopqrstuvwxyz";
+constexpr const char* kUpper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+constexpr const char* kDigits = "0123456789";
+constexpr const char* kSymbols = " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+bool placeholder_charset(char placeholder, std::string& charset) {
+    switch (placeholder) {
+        case 'l':
+            charset = kLower;
+            return true;
+        case 'u':
+            charset = kUpper;
+            return true;
+        case 'd':
+            charset = kDigits;
+            return true;
+        case 's':
+            charset = kSymbols;
+            return true;
+        case 'a':
+            charset = std::string(kLower) + kUpper + kDigits + kSymbols;
+            return true;
+        case 'h':
+            charset = "0123456789abcdef";
+            return true;
+        case 'H':
+            charset = "0123456789ABCDEF";
+            return true;
+        case 'b':
+            charset.clear();
+            for (int byte = 0; byte < 256; ++byte) {
+                charset += static_cast<char>(byte);
+            }
+            return true;
+        case '?':
+            charset = "?";
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+bool Mask::parse(const std::string& text, Mask& mask, std::string& error) {
+    mask = Mask{};
+    mask.text_ = text;
+    mask.size_ = 1;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        std::string charset;
+        if (text[i] != '?') {
+            charset = std::string(1, text[i]);
+        } else if (i + 1 == text.size()) {
+            error = "mask '" + text + "' ends with a lone '?'";
+            return false;
+        } else if (!placeholder_charset(text[++i], charset)) {
+            error = std::string("unknown mask placeholder '?") + text[i] + "' in '" + text + "'";
+            return false;
+        }
+        if (mask.size_ > std::numeric_limits<std::uint64_t>::max() / charset.size()) {
+            error = "mask '" + text + "' has more than 2^64 expansions";
+            return false;
+        }
+        mask.size_ *= charset.size();
+        mask.positions_.push_back(std::move(charset));
+    }
+    if (mask.positions_.empty()) {
+        error = "empty mask";
+        return false;
+    }
+    return true;
+}
+
+void Mask::expansion(std::uint64_t index, std::string& out) const {
+    out.resize(positions_.size());
+    for (std::size_t i = positions_.size(); i-- > 0;) {
+        const std::string& charset = positions_[i];
+        out[i] = charset[static_cast<std::size_t>(index % charset.size())];
+        index /= charset.size();
+    }
+}
+
+}  // namespace unlock_pdf::util
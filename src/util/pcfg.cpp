@@ -0,0 +1,325 @@
+#include "util/pcfg.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr const char* kHeader = "# unlock_pdf PCFG grammar v1";
+
+char character_class(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        return 'L';
+    }
+    if (c >= '0' && c <= '9') {
+        return 'D';
+    }
+    return 'S';
+}
+
+// "L6D2S1" -> {"L6", "D2", "S1"}; false on anything else.
+bool split_structure(const std::string& text, std::vector<std::string>& segments, std::size_t& length) {
+    segments.clear();
+    length = 0;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        char kind = text[i];
+        std::size_t digits = text.find_first_not_of("0123456789", i + 1);
+        if (digits == std::string::npos) {
+            digits = text.size();
+        }
+        if ((kind != 'L' && kind != 'D' && kind != 'S') || digits == i + 1 || digits - i > 4) {
+            return false;
+        }
+        std::size_t run = static_cast<std::size_t>(std::stoul(text.substr(i + 1, digits - i - 1)));
+        if (run == 0) {
+            return false;
+        }
+        segments.push_back(text.substr(i, digits - i));
+        length += run;
+        i = digits;
+    }
+    return !segments.empty();
+}
+
+bool parse_count(const std::string& text, std::uint64_t& count) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    count = std::stoull(text);
+    return true;
+}
+
+std::uint64_t saturating_multiply(std::uint64_t a, std::uint64_t b) {
+    if (a != 0 && b > std::numeric_limits<std::uint64_t>::max() / a) {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+    return a * b;
+}
+
+std::uint64_t saturating_add(std::uint64_t a, std::uint64_t b) {
+    return b > std::numeric_limits<std::uint64_t>::max() - a ? std::numeric_limits<std::uint64_t>::max() : a + b;
+}
+
+}  // namespace
+
+void PcfgGrammar::add(const std::string& password) {
+    if (password.empty()) {
+        return;
+    }
+    std::string structure;
+    std::size_t begin = 0;
+    while (begin < password.size()) {
+        char kind = character_class(password[begin]);
+        std::size_t end = begin + 1;
+        while (end < password.size() && character_class(password[end]) == kind) {
+            ++end;
+        }
+        std::string name = kind + std::to_string(end - begin);
+        structure += name;
+        ++terminal_counts_[name][password.substr(begin, end - begin)];
+        begin = end;
+    }
+    ++structure_counts_[structure];
+    ++passwords_;
+}
+
+bool PcfgGrammar::train(const std::string& wordlist_path, std::string& error) {
+    std::ifstream input(wordlist_path, std::ios::binary);
+    if (!input) {
+        error = "cannot open training wordlist '" + wordlist_path + "'";
+        return false;
+    }
+    std::string line;
+    bool first = true;
+    while (std::getline(input, line)) {
+        if (first && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            line.erase(0, 3);
+        }
+        first = false;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        add(line);
+    }
+    if (input.bad()) {
+        error = "cannot read training wordlist '" + wordlist_path + "'";
+        return false;
+    }
+    finalize();
+    return true;
+}
+
+bool PcfgGrammar::save(const std::string& path, std::string& error) const {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << kHeader << '\n';
+    for (const auto& [structure, count] : structure_counts_) {
+        output << "S\t" << count << '\t' << structure << '\n';
+    }
+    for (const auto& [name, terminals] : terminal_counts_) {
+        for (const auto& [terminal, count] : terminals) {
+            output << "T\t" << name << '\t' << count << '\t' << terminal << '\n';
+        }
+    }
+    if (!output.flush()) {
+        error = "cannot write PCFG grammar '" + path + "'";
+        return false;
+    }
+    return true;
+}
+
+bool PcfgGrammar::load(const std::string& path, std::string& error) {
+    *this = PcfgGrammar{};
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        error = "cannot open PCFG grammar '" + path + "'";
+        return false;
+    }
+    std::string line;
+    if (!std::getline(input, line) || line != kHeader) {
+        error = "'" + path + "' is not a PCFG grammar";
+        return false;
+    }
+    std::size_t line_number = 1;
+    while (std::getline(input, line)) {
+        ++line_number;
+        if (line.empty()) {
+            continue;
+        }
+        bool structure_line = line.compare(0, 2, "S\t") == 0;
+        bool terminal_line = line.compare(0, 2, "T\t") == 0;
+        std::size_t name_end = terminal_line ? line.find('\t', 2) : 1;
+        std::size_t count_end = name_end == std::string::npos ? name_end : line.find('\t', name_end + 1);
+        std::uint64_t count = 0;
+        if ((!structure_line && !terminal_line) || count_end == std::string::npos ||
+            !parse_count(line.substr(name_end + 1, count_end - name_end - 1), count)) {
+            error = path + ":" + std::to_string(line_number) + ": malformed grammar line";
+            return false;
+        }
+        if (structure_line) {
+            structure_counts_[line.substr(count_end + 1)] += count;
+            passwords_ += count;
+        } else {
+            terminal_counts_[line.substr(2, name_end - 2)][line.substr(count_end + 1)] += count;
+        }
+    }
+    finalize();
+    if (structures_.empty()) {
+        error = "PCFG grammar '" + path + "' has no usable structures";
+        return false;
+    }
+    return true;
+}
+
+void PcfgGrammar::finalize() {
+    classes_.clear();
+    structures_.clear();
+    std::unordered_map<std::string, std::size_t> class_index;
+    for (const auto& [name, terminals] : terminal_counts_) {
+        std::uint64_t total = 0;
+        for (const auto& entry : terminals) {
+            total += entry.second;
+        }
+        if (total == 0) {
+            continue;
+        }
+        std::vector<std::pair<std::string, std::uint64_t>> sorted(terminals.begin(), terminals.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second > b.second;
+        });
+        TerminalClass terminal_class;
+        terminal_class.name = name;
+        for (const auto& [text, count] : sorted) {
+            terminal_class.terminals.push_back(Terminal{text, static_cast<double>(count) / total});
+        }
+        class_index[name] = classes_.size();
+        classes_.push_back(std::move(terminal_class));
+    }
+
+    std::uint64_t total = 0;
+    for (const auto& entry : structure_counts_) {
+        total += entry.second;
+    }
+    std::vector<std::string> segments;
+    for (const auto& [text, count] : structure_counts_) {
+        Structure structure;
+        structure.text = text;
+        if (count == 0 || !split_structure(text, segments, structure.length)) {
+            continue;
+        }
+        bool known = true;
+        for (const std::string& segment : segments) {
+            auto it = class_index.find(segment);
+            known = known && it != class_index.end();
+            if (known) {
+                structure.segments.push_back(it->second);
+            }
+        }
+        if (!known) {
+            continue;
+        }
+        structure.probability = static_cast<double>(count) / total;
+        structures_.push_back(std::move(structure));
+    }
+    std::stable_sort(structures_.begin(), structures_.end(), [](const Structure& a, const Structure& b) {
+        return a.probability > b.probability;
+    });
+}
+
+std::uint64_t PcfgGrammar::guess_count(std::size_t max_length) const {
+    std::uint64_t total = 0;
+    for (const auto& [length, count] : guess_lengths(max_length)) {
+        total = saturating_add(total, count);
+    }
+    return total;
+}
+
+std::map<std::size_t, std::uint64_t> PcfgGrammar::guess_lengths(std::size_t max_length) const {
+    std::map<std::size_t, std::uint64_t> lengths;
+    for (const Structure& structure : structures_) {
+        if (max_length > 0 && structure.length > max_length) {
+            continue;
+        }
+        std::uint64_t guesses = 1;
+        for (std::size_t segment : structure.segments) {
+            guesses = saturating_multiply(guesses, classes_[segment].terminals.size());
+        }
+        lengths[structure.length] = saturating_add(lengths[structure.length], guesses);
+    }
+    return lengths;
+}
+
+PcfgGenerator::PcfgGenerator(const PcfgGrammar& grammar, std::size_t max_length, std::size_t queue_limit)
+    : grammar_(grammar), queue_limit_(std::max<std::size_t>(queue_limit, 2)) {
+    const std::vector<PcfgGrammar::Structure>& structures = grammar_.structures();
+    for (std::size_t i = 0; i < structures.size(); ++i) {
+        if (max_length > 0 && structures[i].length > max_length) {
+            continue;
+        }
+        Entry entry;
+        entry.structure = i;
+        entry.choices.assign(structures[i].segments.size(), 0);
+        entry.probability = probability(entry);
+        push(std::move(entry));
+    }
+}
+
+bool PcfgGenerator::next(std::string& guess) {
+    if (heap_.empty()) {
+        return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), LessProbable());
+    Entry entry = std::move(heap_.back());
+    heap_.pop_back();
+
+    const PcfgGrammar::Structure& structure = grammar_.structures()[entry.structure];
+    const std::vector<PcfgGrammar::TerminalClass>& classes = grammar_.classes();
+    guess.clear();
+    for (std::size_t i = 0; i < entry.choices.size(); ++i) {
+        guess += classes[structure.segments[i]].terminals[entry.choices[i]].text;
+    }
+
+    // Successors only advance segments from the pivot on, so each choice
+    // vector has exactly one parent.
+    for (std::size_t i = entry.pivot; i < entry.choices.size(); ++i) {
+        if (entry.choices[i] + 1 >= classes[structure.segments[i]].terminals.size()) {
+            continue;
+        }
+        Entry child;
+        child.structure = entry.structure;
+        child.pivot = i;
+        child.choices = entry.choices;
+        ++child.choices[i];
+        child.probability = probability(child);
+        push(std::move(child));
+    }
+    return true;
+}
+
+double PcfgGenerator::probability(const Entry& entry) const {
+    const PcfgGrammar::Structure& structure = grammar_.structures()[entry.structure];
+    double probability = structure.probability;
+    for (std::size_t i = 0; i < entry.choices.size(); ++i) {
+        probability *= grammar_.classes()[structure.segments[i]].terminals[entry.choices[i]].probability;
+    }
+    return probability;
+}
+
+void PcfgGenerator::push(Entry entry) {
+    heap_.push_back(std::move(entry));
+    std::push_heap(heap_.begin(), heap_.end(), LessProbable());
+    if (heap_.size() <= queue_limit_) {
+        return;
+    }
+    std::size_t keep = queue_limit_ / 2;
+    std::nth_element(heap_.begin(), heap_.begin() + static_cast<std::ptrdiff_t>(keep), heap_.end(),
+                     [](const Entry& a, const Entry& b) { return a.probability > b.probability; });
+    dropped_ += heap_.size() - keep;
+    heap_.resize(keep);
+    std::make_heap(heap_.begin(), heap_.end(), LessProbable());
+}
+
+}  // namespace unlock_pdf::util
@@ -0,0 +1,161 @@
+#include "util/prince.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace unlock_pdf::util {
+namespace {
+
+constexpr std::uint64_t kSaturated = std::numeric_limits<std::uint64_t>::max();
+
+std::uint64_t saturating_multiply(std::uint64_t a, std::uint64_t b) {
+    if (a != 0 && b > kSaturated / a) {
+        return kSaturated;
+    }
+    return a * b;
+}
+
+}  // namespace
+
+void PrinceChains::add(const std::string& word) {
+    if (word.empty() || !seen_.insert(word).second) {
+        return;
+    }
+    if (by_length_.size() <= word.size()) {
+        by_length_.resize(word.size() + 1);
+    }
+    by_length_[word.size()].push_back(word);
+    ++word_count_;
+}
+
+bool PrinceChains::build(std::size_t min_length,
+                         std::size_t max_length,
+                         std::size_t max_elements,
+                         std::string& error) {
+    std::unordered_set<std::string>().swap(seen_);
+    chains_.clear();
+    element_lengths_.clear();
+    truncated_ = false;
+    if (max_elements == 0 || max_elements > kMaxElements) {
+        error = "a chain takes 1 to " + std::to_string(kMaxElements) + " elements";
+        return false;
+    }
+    if (min_length > max_length) {
+        error = "invalid chain length range";
+        return false;
+    }
+
+    std::vector<std::size_t> lengths;
+    for (std::size_t length = 1; length < by_length_.size() && length <= max_length; ++length) {
+        if (!by_length_[length].empty()) {
+            lengths.push_back(length);
+        }
+    }
+
+    // Chains of one element count, depth first in ascending lengths, then
+    // stable-sorted by size so that equal sizes keep that order.
+    std::vector<Chain> level;
+    std::vector<std::size_t> level_lengths;
+    std::vector<std::size_t> prefix;
+    bool too_many = false;
+    std::function<void(std::size_t, std::size_t, std::uint64_t)> extend = [&](std::size_t elements,
+                                                                              std::size_t length,
+                                                                              std::uint64_t size) {
+        if (too_many) {
+            return;
+        }
+        if (prefix.size() == elements) {
+            if (length < min_length) {
+                return;
+            }
+            if (chains_.size() + level.size() >= kMaxChains) {
+                too_many = true;
+                return;
+            }
+            Chain chain;
+            chain.size = size;
+            chain.length = length;
+            chain.first = level_lengths.size();
+            chain.count = elements;
+            level_lengths.insert(level_lengths.end(), prefix.begin(), prefix.end());
+            level.push_back(chain);
+            return;
+        }
+        std::size_t remaining = elements - prefix.size() - 1;
+        for (std::size_t next : lengths) {
+            if (length + next + remaining * lengths.front() > max_length) {
+                break;
+            }
+            prefix.push_back(next);
+            extend(elements, length + next, saturating_multiply(size, by_length_[next].size()));
+            prefix.pop_back();
+        }
+    };
+
+    std::uint64_t offset = 0;
+    for (std::size_t elements = 1; elements <= max_elements && !lengths.empty() && !truncated_; ++elements) {
+        level.clear();
+        level_lengths.clear();
+        extend(elements, 0, 1);
+        if (too_many) {
+            error = "more than " + std::to_string(kMaxChains) + " chains; lower the element count or the length range";
+            chains_.clear();
+            return false;
+        }
+        std::vector<std::size_t> order(level.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return level[a].size < level[b].size;
+        });
+        for (std::size_t index : order) {
+            Chain chain = level[index];
+            if (chain.size == kSaturated || chain.size > kSaturated - offset) {
+                truncated_ = true;
+                break;
+            }
+            chain.offset = offset;
+            offset += chain.size;
+            std::size_t first = element_lengths_.size();
+            element_lengths_.insert(element_lengths_.end(),
+                                    level_lengths.begin() + static_cast<std::ptrdiff_t>(chain.first),
+                                    level_lengths.begin() + static_cast<std::ptrdiff_t>(chain.first + chain.count));
+            chain.first = first;
+            chains_.push_back(chain);
+        }
+    }
+    if (chains_.empty()) {
+        error = "no chain of " + std::to_string(min_length) + " to " + std::to_string(max_length) +
+                " bytes can be built from the words";
+        return false;
+    }
+    return true;
+}
+
+void PrinceChains::candidate(std::uint64_t index, std::string& out) const {
+    auto it = std::upper_bound(chains_.begin(), chains_.end(), index, [](std::uint64_t value, const Chain& chain) {
+        return value < chain.offset;
+    });
+    const Chain& chain = *std::prev(it);
+    std::uint64_t local = index - chain.offset;
+    out.resize(chain.length);
+    std::size_t end = chain.length;
+    for (std::size_t i = chain.count; i-- > 0;) {
+        const std::vector<std::string>& words = by_length_[element_lengths_[chain.first + i]];
+        const std::string& word = words[static_cast<std::size_t>(local % words.size())];
+        local /= words.size();
+        end -= word.size();
+        std::copy(word.begin(), word.end(), out.begin() + static_cast<std::ptrdiff_t>(end));
+    }
+}
+
+std::map<std::size_t, std::uint64_t> PrinceChains::length_counts() const {
+    std::map<std::size_t, std::uint64_t> counts;
+    for (const Chain& chain : chains_) {
+        counts[chain.length] += chain.size;
+    }
+    return counts;
+}
+
+}  // namespace unlock_pdf::util
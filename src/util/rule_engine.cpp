@@ -0,0 +1,435 @@
+#include "util/rule_engine.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace unlock_pdf::util {
+namespace {
+
+enum class Arguments { None, Char, Position, PositionPosition, PositionChar, CharChar };
+
+bool rule_arguments(char function, Arguments& arguments) {
+    switch (function) {
+        case ':': case 'l': case 'u': case 'c': case 'C': case 't': case 'r': case 'd': case 'f':
+        case '{': case '}': case '[': case ']': case 'q': case 'k': case 'K': case 'E':
+            arguments = Arguments::None;
+            return true;
+        case '$': case '^': case '@': case 'e': case '!': case '/': case '(': case ')':
+            arguments = Arguments::Char;
+            return true;
+        case 'T': case 'p': case 'D': case '\'': case 'z': case 'Z': case 'y': case 'Y': case 'L': case 'R':
+        case '+': case '-': case '.': case ',': case '<': case '>': case '_':
+            arguments = Arguments::Position;
+            return true;
+        case 'x': case 'O': case '*':
+            arguments = Arguments::PositionPosition;
+            return true;
+        case 'i': case 'o': case '=': case '%':
+            arguments = Arguments::PositionChar;
+            return true;
+        case 's':
+            arguments = Arguments::CharChar;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool parse_position(char c, unsigned char& position) {
+    if (c >= '0' && c <= '9') {
+        position = static_cast<unsigned char>(c - '0');
+        return true;
+    }
+    if (c >= 'A' && c <= 'Z') {
+        position = static_cast<unsigned char>(c - 'A' + 10);
+        return true;
+    }
+    return false;
+}
+
+bool is_space(char c) { return c == ' ' || c == '\t'; }
+
+char to_lower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+char to_upper(char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c; }
+char toggle(char c) { return c >= 'a' && c <= 'z' ? to_upper(c) : to_lower(c); }
+
+void lower_all(std::string& word) { std::transform(word.begin(), word.end(), word.begin(), to_lower); }
+void upper_all(std::string& word) { std::transform(word.begin(), word.end(), word.begin(), to_upper); }
+
+// Lowercases the word and uppercases the first letter and every letter that
+// follows `separator`.
+void title_case(std::string& word, char separator) {
+    lower_all(word);
+    bool start = true;
+    for (char& c : word) {
+        if (start) {
+            c = to_upper(c);
+        }
+        start = c == separator;
+    }
+}
+
+}  // namespace
+
+bool Rule::parse(const std::string& text, Rule& rule, std::string& error) {
+    rule = Rule{};
+    rule.text_ = text;
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (is_space(text[i])) {
+            ++i;
+            continue;
+        }
+        Step step;
+        step.function = text[i];
+        std::size_t column = i + 1;
+        Arguments arguments = Arguments::None;
+        if (!rule_arguments(step.function, arguments)) {
+            error = std::string("unknown rule function '") + step.function + "' at column " + std::to_string(column);
+            return false;
+        }
+        std::size_t needed = 2;
+        if (arguments == Arguments::None) {
+            needed = 0;
+        } else if (arguments == Arguments::Char || arguments == Arguments::Position) {
+            needed = 1;
+        }
+        if (text.size() - i - 1 < needed) {
+            error = std::string("rule function '") + step.function + "' at column " + std::to_string(column) +
+                    " is missing its argument";
+            return false;
+        }
+        const char* args = text.data() + i + 1;
+        bool valid = true;
+        switch (arguments) {
+            case Arguments::None:
+                break;
+            case Arguments::Char:
+                step.first = static_cast<unsigned char>(args[0]);
+                break;
+            case Arguments::Position:
+                valid = parse_position(args[0], step.first);
+                break;
+            case Arguments::PositionPosition:
+                valid = parse_position(args[0], step.first) && parse_position(args[1], step.second);
+                break;
+            case Arguments::PositionChar:
+                valid = parse_position(args[0], step.first);
+                step.second = static_cast<unsigned char>(args[1]);
+                break;
+            case Arguments::CharChar:
+                step.first = static_cast<unsigned char>(args[0]);
+                step.second = static_cast<unsigned char>(args[1]);
+                break;
+        }
+        if (!valid) {
+            error = std::string("rule function '") + step.function + "' at column " + std::to_string(column) +
+                    " needs a position 0-9 or A-Z";
+            return false;
+        }
+        rule.steps_.push_back(step);
+        i += 1 + needed;
+    }
+    if (rule.steps_.empty()) {
+        error = "empty rule";
+        return false;
+    }
+    return true;
+}
+
+bool Rule::apply(const std::string& word, std::string& out) const {
+    out = word;
+    for (const Step& step : steps_) {
+        const std::size_t n = step.first;
+        const std::size_t m = step.second;
+        const char x = static_cast<char>(step.first);
+        const char y = static_cast<char>(step.second);
+        const std::size_t size = out.size();
+        switch (step.function) {
+            case ':':
+                break;
+            case 'l':
+                lower_all(out);
+                break;
+            case 'u':
+                upper_all(out);
+                break;
+            case 'c':
+                lower_all(out);
+                if (!out.empty()) {
+                    out[0] = to_upper(out[0]);
+                }
+                break;
+            case 'C':
+                upper_all(out);
+                if (!out.empty()) {
+                    out[0] = to_lower(out[0]);
+                }
+                break;
+            case 't':
+                std::transform(out.begin(), out.end(), out.begin(), toggle);
+                break;
+            case 'T':
+                if (n < size) {
+                    out[n] = toggle(out[n]);
+                }
+                break;
+            case 'E':
+                title_case(out, ' ');
+                break;
+            case 'e':
+                title_case(out, x);
+                break;
+            case 'r':
+                std::reverse(out.begin(), out.end());
+                break;
+            case 'd':
+                out += out;
+                break;
+            case 'p': {
+                std::string copy = out;
+                for (std::size_t k = 0; k < n && out.size() <= kMaxWordLength; ++k) {
+                    out += copy;
+                }
+                break;
+            }
+            case 'f': {
+                std::string reflected(out.rbegin(), out.rend());
+                out += reflected;
+                break;
+            }
+            case '{':
+                if (size > 1) {
+                    std::rotate(out.begin(), out.begin() + 1, out.end());
+                }
+                break;
+            case '}':
+                if (size > 1) {
+                    std::rotate(out.rbegin(), out.rbegin() + 1, out.rend());
+                }
+                break;
+            case 'q': {
+                std::string doubled;
+                doubled.reserve(size * 2);
+                for (char c : out) {
+                    doubled += c;
+                    doubled += c;
+                }
+                out = std::move(doubled);
+                break;
+            }
+            case 'k':
+                if (size >= 2) {
+                    std::swap(out[0], out[1]);
+                }
+                break;
+            case 'K':
+                if (size >= 2) {
+                    std::swap(out[size - 1], out[size - 2]);
+                }
+                break;
+            case '*':
+                if (n < size && m < size) {
+                    std::swap(out[n], out[m]);
+                }
+                break;
+            case '$':
+                out += x;
+                break;
+            case '^':
+                out.insert(out.begin(), x);
+                break;
+            case 'i':
+                if (n <= size) {
+                    out.insert(out.begin() + static_cast<std::ptrdiff_t>(n), y);
+                }
+                break;
+            case 'o':
+                if (n < size) {
+                    out[n] = y;
+                }
+                break;
+            case 's':
+                std::replace(out.begin(), out.end(), x, y);
+                break;
+            case '@':
+                out.erase(std::remove(out.begin(), out.end(), x), out.end());
+                break;
+            case '[':
+                if (size > 0) {
+                    out.erase(0, 1);
+                }
+                break;
+            case ']':
+                if (size > 0) {
+                    out.pop_back();
+                }
+                break;
+            case 'D':
+                if (n < size) {
+                    out.erase(n, 1);
+                }
+                break;
+            case 'x':
+                if (n + m <= size) {
+                    out = out.substr(n, m);
+                }
+                break;
+            case 'O':
+                if (n + m <= size) {
+                    out.erase(n, m);
+                }
+                break;
+            case '\'':
+                if (n < size) {
+                    out.resize(n);
+                }
+                break;
+            case 'z':
+                if (size > 0) {
+                    out.insert(std::size_t{0}, n, out[0]);
+                }
+                break;
+            case 'Z':
+                if (size > 0) {
+                    out.append(n, out[size - 1]);
+                }
+                break;
+            case 'y':
+                if (n <= size) {
+                    out.insert(0, out.substr(0, n));
+                }
+                break;
+            case 'Y':
+                if (n <= size) {
+                    out += out.substr(size - n);
+                }
+                break;
+            case 'L':
+                if (n < size) {
+                    out[n] = static_cast<char>(static_cast<unsigned char>(out[n]) << 1);
+                }
+                break;
+            case 'R':
+                if (n < size) {
+                    out[n] = static_cast<char>(static_cast<unsigned char>(out[n]) >> 1);
+                }
+                break;
+            case '+':
+                if (n < size) {
+                    ++out[n];
+                }
+                break;
+            case '-':
+                if (n < size) {
+                    --out[n];
+                }
+                break;
+            case '.':
+                if (n + 1 < size) {
+                    out[n] = out[n + 1];
+                }
+                break;
+            case ',':
+                if (n >= 1 && n < size) {
+                    out[n] = out[n - 1];
+                }
+                break;
+            case '<':
+                if (size > n) {
+                    return false;
+                }
+                break;
+            case '>':
+                if (size < n) {
+                    return false;
+                }
+                break;
+            case '_':
+                if (size != n) {
+                    return false;
+                }
+                break;
+            case '!':
+                if (out.find(x) != std::string::npos) {
+                    return false;
+                }
+                break;
+            case '/':
+                if (out.find(x) == std::string::npos) {
+                    return false;
+                }
+                break;
+            case '(':
+                if (size == 0 || out.front() != x) {
+                    return false;
+                }
+                break;
+            case ')':
+                if (size == 0 || out.back() != x) {
+                    return false;
+                }
+                break;
+            case '=':
+                if (n >= size || out[n] != y) {
+                    return false;
+                }
+                break;
+            case '%':
+                if (static_cast<std::size_t>(std::count(out.begin(), out.end(), y)) < n) {
+                    return false;
+                }
+                break;
+        }
+        if (out.size() > kMaxWordLength) {
+            return false;
+        }
+    }
+    return !out.empty();
+}
+
+bool RuleSet::load(const std::string& path, std::string& error) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        error = "cannot open rule file '" + path + "'";
+        return false;
+    }
+    std::string line;
+    std::size_t line_number = 0;
+    std::size_t before = rules_.size();
+    while (std::getline(input, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line.front() == '#' ||
+            std::all_of(line.begin(), line.end(), [](char c) { return is_space(c); })) {
+            continue;
+        }
+        std::string rule_error;
+        if (!add(line, rule_error)) {
+            error = path + ":" + std::to_string(line_number) + ": " + rule_error;
+            return false;
+        }
+    }
+    if (input.bad()) {
+        error = "cannot read rule file '" + path + "'";
+        return false;
+    }
+    if (rules_.size() == before) {
+        error = "rule file '" + path + "' contains no rules";
+        return false;
+    }
+    return true;
+}
+
+bool RuleSet::add(const std::string& text, std::string& error) {
+    Rule rule;
+    if (!Rule::parse(text, rule, error)) {
+        return false;
+    }
+    rules_.push_back(std::move(rule));
+    return true;
+}
+
+}  // namespace unlock_pdf::util
@@ -3,10 +3,16 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <cmath>
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <set>
 #include <sstream>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #if defined(_WIN32)
 #include <winsock2.h>
@@ -19,6 +25,7 @@
 #include <mach/mach_host.h>
 #include <mach/mach_init.h>
 #else
+#include <sched.h>
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
 #include <unistd.h>
@@ -210,8 +217,276 @@ std::string detect_hostname() {
 #endif
 }
 
+unsigned int detect_affinity_cpus() {
+#if defined(_WIN32)
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        unsigned int count = 0;
+        for (; process_mask != 0; process_mask &= process_mask - 1) {
+            ++count;
+        }
+        return count;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    return 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return static_cast<unsigned int>(CPU_COUNT(&set));
+    }
+    return 0;
+#endif
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+
+struct CgroupLimits {
+    double cpu_quota = 0.0;
+    std::uint64_t memory_limit = 0;
+};
+
+bool read_first_line(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return static_cast<bool>(std::getline(file, line));
+}
+
+// Values at or above this are the kernel's "no limit" sentinels
+// (PAGE_COUNTER_MAX rounded to the page size on cgroup v1).
+constexpr std::uint64_t kUnlimitedMemory = std::uint64_t{1} << 60;
+
+void merge_cpu_quota(CgroupLimits& limits, double quota) {
+    if (quota > 0.0 && (limits.cpu_quota == 0.0 || quota < limits.cpu_quota)) {
+        limits.cpu_quota = quota;
+    }
+}
+
+void merge_memory_limit(CgroupLimits& limits, const std::string& value) {
+    if (value.empty() || value == "max" || !std::isdigit(static_cast<unsigned char>(value.front()))) {
+        return;
+    }
+    std::uint64_t bytes = std::strtoull(value.c_str(), nullptr, 10);
+    if (bytes == 0 || bytes >= kUnlimitedMemory) {
+        return;
+    }
+    if (limits.memory_limit == 0 || bytes < limits.memory_limit) {
+        limits.memory_limit = bytes;
+    }
+}
+
+// Limits apply hierarchically, so walk from the process's own cgroup up to the
+// mount root and keep the tightest value. Inside a cgroup namespace the path is
+// usually "/", which resolves to the mount root directly.
+std::vector<std::string> cgroup_directories(const std::string& mount, const std::string& path) {
+    std::vector<std::string> directories;
+    std::string current = path;
+    while (true) {
+        directories.push_back(mount + current);
+        if (current.empty() || current == "/") {
+            break;
+        }
+        auto slash = current.find_last_of('/');
+        current = slash == 0 || slash == std::string::npos ? "/" : current.substr(0, slash);
+    }
+    return directories;
+}
+
+CgroupLimits detect_cgroup_limits() {
+    CgroupLimits limits;
+
+    std::string unified_path;
+    std::string cpu_path;
+    std::string memory_path;
+    bool has_unified = false;
+    bool has_cpu = false;
+    bool has_memory = false;
+
+    std::ifstream cgroup_file("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(cgroup_file, line)) {
+        auto first = line.find(':');
+        auto second = first == std::string::npos ? std::string::npos : line.find(':', first + 1);
+        if (second == std::string::npos) {
+            continue;
+        }
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        if (controllers.empty()) {
+            unified_path = path;
+            has_unified = true;
+            continue;
+        }
+        std::istringstream names(controllers);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (name == "cpu") {
+                cpu_path = path;
+                has_cpu = true;
+            } else if (name == "memory") {
+                memory_path = path;
+                has_memory = true;
+            }
+        }
+    }
+
+    std::string value;
+    if (has_unified) {
+        for (const auto& directory : cgroup_directories("/sys/fs/cgroup", unified_path)) {
+            if (read_first_line(directory + "/cpu.max", value)) {
+                std::istringstream fields(value);
+                std::string quota;
+                double period = 0.0;
+                if (fields >> quota >> period && quota != "max" && period > 0.0) {
+                    merge_cpu_quota(limits, std::strtod(quota.c_str(), nullptr) / period);
+                }
+            }
+            if (read_first_line(directory + "/memory.max", value)) {
+                merge_memory_limit(limits, value);
+            }
+        }
+    }
+
+    if (has_cpu) {
+        for (const char* mount : {"/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpuacct,cpu"}) {
+            for (const auto& directory : cgroup_directories(mount, cpu_path)) {
+                std::string quota;
+                std::string period;
+                if (read_first_line(directory + "/cpu.cfs_quota_us", quota) &&
+                    read_first_line(directory + "/cpu.cfs_period_us", period)) {
+                    double quota_us = std::strtod(quota.c_str(), nullptr);
+                    double period_us = std::strtod(period.c_str(), nullptr);
+                    if (quota_us > 0.0 && period_us > 0.0) {
+                        merge_cpu_quota(limits, quota_us / period_us);
+                    }
+                }
+            }
+        }
+    }
+
+    if (has_memory) {
+        for (const auto& directory : cgroup_directories("/sys/fs/cgroup/memory", memory_path)) {
+            if (read_first_line(directory + "/memory.limit_in_bytes", value)) {
+                merge_memory_limit(limits, value);
+            }
+        }
+    }
+
+    return limits;
+}
+
+#endif
+
+unsigned int combine_cpu_limits(unsigned int hardware_threads, unsigned int affinity_cpus, double cpu_quota) {
+    unsigned int effective = hardware_threads;
+    if (affinity_cpus > 0 && (effective == 0 || affinity_cpus < effective)) {
+        effective = affinity_cpus;
+    }
+    if (cpu_quota > 0.0) {
+        auto quota_cpus = static_cast<unsigned int>(std::ceil(cpu_quota));
+        quota_cpus = std::max(quota_cpus, 1u);
+        if (effective == 0 || quota_cpus < effective) {
+            effective = quota_cpus;
+        }
+    }
+    return std::max(effective, 1u);
+}
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+
+int read_sysfs_int(const std::string& path) {
+    std::string value;
+    if (!read_first_line(path, value) || value.empty()) {
+        return -1;
+    }
+    return std::atoi(value.c_str());
+}
+
+int detect_numa_node(const std::string& cpu_directory) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(cpu_directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::isdigit(static_cast<unsigned char>(name[4]))) {
+            return std::atoi(name.c_str() + 4);
+        }
+    }
+    return -1;
+}
+
+#endif
+
 }  // namespace
 
+std::vector<LogicalCpu> read_cpu_topology() {
+    std::vector<LogicalCpu> cpus;
+#if defined(_WIN32) || defined(__APPLE__)
+    unsigned int count = std::thread::hardware_concurrency();
+    for (unsigned int id = 0; id < count; ++id) {
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpus.push_back(cpu);
+    }
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return cpus;
+    }
+    for (unsigned int id = 0; id < CPU_SETSIZE; ++id) {
+        if (!CPU_ISSET(id, &set)) {
+            continue;
+        }
+        std::string directory = "/sys/devices/system/cpu/cpu" + std::to_string(id);
+        LogicalCpu cpu;
+        cpu.id = id;
+        cpu.core_id = read_sysfs_int(directory + "/topology/core_id");
+        cpu.package_id = read_sysfs_int(directory + "/topology/physical_package_id");
+        cpu.numa_node = detect_numa_node(directory);
+        cpus.push_back(cpu);
+    }
+#endif
+    return cpus;
+}
+
+unsigned int effective_cpu_count() {
+    double cpu_quota = 0.0;
+#if !defined(_WIN32) && !defined(__APPLE__)
+    cpu_quota = detect_cgroup_limits().cpu_quota;
+#endif
+    return combine_cpu_limits(std::thread::hardware_concurrency(), detect_affinity_cpus(), cpu_quota);
+}
+
+std::string cpu_model_name() { return detect_cpu_model(); }
+
+std::string user_cache_directory() {
+    std::filesystem::path base;
+#if defined(_WIN32)
+    if (const char* local_app_data = std::getenv("LOCALAPPDATA"); local_app_data && *local_app_data) {
+        base = local_app_data;
+    }
+#else
+    if (const char* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache && *xdg_cache) {
+        base = xdg_cache;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        base = std::filesystem::path(home) / ".cache";
+    }
+#endif
+    if (base.empty()) {
+        return std::string();
+    }
+    return (base / "unlock_pdf").string();
+}
+
+unsigned long current_process_id() {
+#if defined(_WIN32)
+    return static_cast<unsigned long>(GetCurrentProcessId());
+#else
+    return static_cast<unsigned long>(::getpid());
+#endif
+}
+
 SystemInfo collect_system_info() {
     SystemInfo info;
     info.os_name = detect_os_name();
@@ -219,8 +494,24 @@ SystemInfo collect_system_info() {
     info.architecture = detect_architecture();
     info.cpu_model = detect_cpu_model();
     info.cpu_threads = std::thread::hardware_concurrency();
+    info.affinity_cpus = detect_affinity_cpus();
     info.total_memory_bytes = detect_total_memory();
     info.available_memory_bytes = detect_available_memory();
+#if !defined(_WIN32) && !defined(__APPLE__)
+    CgroupLimits limits = detect_cgroup_limits();
+    info.cgroup_cpu_quota = limits.cpu_quota;
+    info.cgroup_memory_limit_bytes = limits.memory_limit;
+#endif
+    info.effective_cpus = combine_cpu_limits(info.cpu_threads, info.affinity_cpus, info.cgroup_cpu_quota);
+
+    std::set<std::pair<int, int>> cores;
+    std::set<int> nodes;
+    for (const auto& cpu : read_cpu_topology()) {
+        cores.emplace(cpu.package_id, cpu.core_id < 0 ? static_cast<int>(cpu.id) : cpu.core_id);
+        nodes.insert(cpu.numa_node);
+    }
+    info.physical_cores = static_cast<unsigned int>(cores.size());
+    info.numa_nodes = static_cast<unsigned int>(nodes.size());
     info.hostname = detect_hostname();
     return info;
 }
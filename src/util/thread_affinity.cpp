@@ -0,0 +1,185 @@
+#include "util/thread_affinity.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace unlock_pdf::util {
+namespace {
+
+using CoreKey = std::pair<int, int>;
+
+CoreKey core_key(const LogicalCpu& cpu) {
+    // Without sysfs topology every logical CPU is treated as its own core.
+    return {cpu.package_id, cpu.core_id < 0 ? static_cast<int>(cpu.id) : cpu.core_id};
+}
+
+bool compact_order(const LogicalCpu& lhs, const LogicalCpu& rhs) {
+    return std::make_tuple(lhs.numa_node, lhs.package_id, core_key(lhs).second, lhs.id) <
+           std::make_tuple(rhs.numa_node, rhs.package_id, core_key(rhs).second, rhs.id);
+}
+
+// Logical CPUs grouped by physical core, cores in compact order and siblings
+// sorted by CPU id.
+std::vector<std::vector<LogicalCpu>> group_by_core(std::vector<LogicalCpu> cpus) {
+    std::sort(cpus.begin(), cpus.end(), compact_order);
+    std::vector<std::vector<LogicalCpu>> cores;
+    std::map<CoreKey, std::size_t> index;
+    for (const auto& cpu : cpus) {
+        auto [it, inserted] = index.emplace(core_key(cpu), cores.size());
+        if (inserted) {
+            cores.emplace_back();
+        }
+        cores[it->second].push_back(cpu);
+    }
+    return cores;
+}
+
+}  // namespace
+
+bool parse_affinity_policy(const std::string& text, AffinityPolicy& policy) {
+    if (text == "none") {
+        policy = AffinityPolicy::None;
+    } else if (text == "compact") {
+        policy = AffinityPolicy::Compact;
+    } else if (text == "scatter") {
+        policy = AffinityPolicy::Scatter;
+    } else if (text == "physical-only") {
+        policy = AffinityPolicy::PhysicalOnly;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* affinity_policy_name(AffinityPolicy policy) {
+    switch (policy) {
+        case AffinityPolicy::Compact:
+            return "compact";
+        case AffinityPolicy::Scatter:
+            return "scatter";
+        case AffinityPolicy::PhysicalOnly:
+            return "physical-only";
+        case AffinityPolicy::None:
+        default:
+            return "none";
+    }
+}
+
+unsigned int count_physical_cores(const std::vector<LogicalCpu>& topology) {
+    return static_cast<unsigned int>(group_by_core(topology).size());
+}
+
+std::vector<LogicalCpu> plan_thread_placement(const std::vector<LogicalCpu>& topology,
+                                              AffinityPolicy policy,
+                                              unsigned int thread_count) {
+    std::vector<LogicalCpu> placement;
+    if (policy == AffinityPolicy::None || topology.empty() || thread_count == 0) {
+        return placement;
+    }
+
+    auto cores = group_by_core(topology);
+    std::vector<LogicalCpu> order;
+    order.reserve(topology.size());
+
+    switch (policy) {
+        case AffinityPolicy::Compact:
+            for (const auto& core : cores) {
+                order.insert(order.end(), core.begin(), core.end());
+            }
+            break;
+        case AffinityPolicy::PhysicalOnly:
+            for (const auto& core : cores) {
+                order.push_back(core.front());
+            }
+            break;
+        case AffinityPolicy::Scatter: {
+            // Interleave packages so consecutive threads land on different
+            // sockets, and only use second SMT siblings once every core is busy.
+            std::map<int, std::vector<const std::vector<LogicalCpu>*>> by_package;
+            std::size_t max_siblings = 0;
+            for (const auto& core : cores) {
+                by_package[core.front().package_id].push_back(&core);
+                max_siblings = std::max(max_siblings, core.size());
+            }
+            std::size_t max_cores = 0;
+            for (const auto& entry : by_package) {
+                max_cores = std::max(max_cores, entry.second.size());
+            }
+            for (std::size_t sibling = 0; sibling < max_siblings; ++sibling) {
+                for (std::size_t core = 0; core < max_cores; ++core) {
+                    for (const auto& entry : by_package) {
+                        if (core < entry.second.size() && sibling < entry.second[core]->size()) {
+                            order.push_back((*entry.second[core])[sibling]);
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        case AffinityPolicy::None:
+            break;
+    }
+
+    // physical-only never puts a second thread on a core, so threads past the
+    // core count get no slot and run unpinned.
+    std::size_t planned = thread_count;
+    if (policy == AffinityPolicy::PhysicalOnly) {
+        planned = std::min(planned, order.size());
+    }
+    placement.reserve(planned);
+    for (std::size_t i = 0; i < planned; ++i) {
+        placement.push_back(order[i % order.size()]);
+    }
+    return placement;
+}
+
+bool pin_current_thread(unsigned int cpu_id) {
+#if defined(_WIN32)
+    if (cpu_id >= sizeof(DWORD_PTR) * 8) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << cpu_id) != 0;
+#elif defined(__APPLE__)
+    (void)cpu_id;
+    return false;
+#else
+    if (cpu_id >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu_id, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+std::string describe_thread_placement(const std::vector<LogicalCpu>& placement) {
+    std::ostringstream oss;
+    for (std::size_t i = 0; i < placement.size(); ++i) {
+        const LogicalCpu& cpu = placement[i];
+        if (i > 0) {
+            oss << ", ";
+        }
+        oss << 't' << i << "->cpu" << cpu.id << " (core " << core_key(cpu).second;
+        if (cpu.package_id >= 0) {
+            oss << ", package " << cpu.package_id;
+        }
+        if (cpu.numa_node >= 0) {
+            oss << ", node " << cpu.numa_node;
+        }
+        oss << ')';
+    }
+    return oss.str();
+}
+
+}  // namespace unlock_pdf::util
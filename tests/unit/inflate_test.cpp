@@ -0,0 +1,108 @@
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "unit_test.h"
+#include "util/inflate.h"
+
+namespace unlock_pdf::tests {
+
+// Streams produced with Python's zlib module (the corrupt ones edited by
+// hand); each names the deflate block type it exercises.
+void check_inflate(Checker& checker) {
+    std::string numbered;
+    for (int i = 0; i < 40; ++i) {
+        numbered += std::to_string(i) + " 0 obj " + std::to_string(i * i * 7919 % 100003) + " endobj\n";
+    }
+    struct Vector {
+        const char* label;
+        const char* stream;
+        std::string expected;
+    };
+    const Vector vectors[] = {
+        {"stored block", "7801010c00f3ff73746f72656420626c6f636b1f8004bd", "stored block"},
+        {"fixed Huffman block", "78014b4c4a4e444500417c06e5", "abcabcabcabcabcabc"},
+        {"dynamic Huffman block",
+         "78da4d92396e04310c0473bf629fc043e2f11dc34e36b0ff9f5906d4cd490683428b62899497bc7e3fdfe7fbfdf3757e3ef4826c6d"
+         "30bbcc3532001d41b554c075a1450ae1beb0b3d300e3c2da9205988025c6645d183525fbb2a5cb0855709156b27985d12e9deb154e"
+         "4b5c9c14525ef6c8c26a9b3cea42ebbfec2285d7392f43476cdb26a5d98e1a8b66bf91cc1adc0e9324855b9be650cecba268617"
+         "0ab16e38b1bdc424d66e0705b6d8f2cdcb64b4d67704bcbe21a19dcca7520d5fa21ecc2a5a9a28453ad7da2c677540ecd2166be7d"
+         "2887b6a4a700c58ac37168c55964ca7a7241f2d115b47c454f05aee35ace47fc03db2ce507",
+         numbered},
+        {"raw deflate without zlib header", "2b4a2c5748494dcb492c495528cf2cc9c82f2d514854a8cac94c52c8484d4c492d0200",
+         "raw deflate without a zlib header"},
+        {"overlapping back-reference", "4b040200", "aaaa"},
+    };
+    const char* corrupt[] = {
+        "780107",                                            // reserved block type 3
+        "7801010c000cff73746f72656420626c6f636b1f8004bd",    // stored LEN/NLEN mismatch
+        "4b046200",                                          // distance before the start of the output
+        "78da4d92396e04310c0473bf629fc043e2f11dc34e36b0ff",  // dynamic block cut short
+    };
+
+    auto inflate = [](const char* stream, std::size_t max_output, Bytes& output, std::string& error) {
+        Bytes input = from_hex(stream);
+        std::string_view data(reinterpret_cast<const char*>(input.data()), input.size());
+        return unlock_pdf::util::inflate_zlib(data, output, max_output, error);
+    };
+
+    checker.begin("Inflate (RFC 1950/1951)");
+    for (const auto& vector : vectors) {
+        Bytes output;
+        std::string error;
+        bool ok = inflate(vector.stream, std::size_t{1} << 20, output, error);
+        checker.expect(ok && output == to_bytes(vector.expected),
+                       std::string(vector.label) + (ok ? "" : " (" + error + ")"));
+    }
+    for (const char* stream : corrupt) {
+        Bytes output;
+        std::string error;
+        checker.expect(!inflate(stream, std::size_t{1} << 20, output, error) && !error.empty(),
+                       "corrupt stream " + std::string(stream) + " rejected");
+    }
+    Bytes output;
+    std::string error;
+    checker.expect(!inflate(vectors[2].stream, numbered.size() - 1, output, error), "output past the limit rejected");
+    checker.end();
+}
+
+// Rows of a /W [1 2 1] cross-reference stream, one per PNG filter type and
+// a last Up row; the filtered inputs were produced by a reference encoder.
+void check_png_predictor(Checker& checker) {
+    struct Vector {
+        const char* label;
+        std::size_t colors;
+        std::size_t columns;
+        const char* filtered;
+        const char* rows;
+    };
+    static const Vector vectors[] = {
+        {"xref rows, filters 0-4 and 2",
+         1,
+         4,
+         "0001000f0001010029d60201ffdb0303001229e50400edf1110200000100",
+         "01000f0001012a00020005030112340001fff00101fff101"},
+        {"3 bytes per pixel, Sub and Paeth", 3, 2, "0110203030303004010203404040", "1020304050601122338090a0"},
+        {"trailing partial row dropped", 1, 4, "0001000f0001", "01000f00"},
+    };
+
+    checker.begin("PNG predictor (xref streams)");
+    for (const auto& vector : vectors) {
+        Bytes output;
+        std::string error;
+        bool ok = unlock_pdf::util::undo_png_predictor(
+            from_hex(vector.filtered), vector.colors, 8, vector.columns, output, error);
+        if (checker.expect(ok, std::string(vector.label) + (ok ? "" : " (" + error + ")"))) {
+            checker.expect_hex(output, vector.rows, vector.label);
+        }
+    }
+    Bytes output;
+    std::string error;
+    checker.expect(!unlock_pdf::util::undo_png_predictor(from_hex("0501020304"), 1, 8, 4, output, error),
+                   "filter type 5 rejected");
+    checker.expect(!unlock_pdf::util::undo_png_predictor(from_hex("0001020304"), 1, 8, 0, output, error),
+                   "zero columns rejected");
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "unit_test.h"
+#include "util/keyspace.h"
+
+namespace unlock_pdf::tests {
+
+void check_keyspace(Checker& checker) {
+    using unlock_pdf::util::Keyspace;
+    struct Vector {
+        const char* label;
+        Keyspace value;
+        const char* decimal;
+    };
+    const Keyspace max64(std::numeric_limits<std::uint64_t>::max());
+    // Expected values computed with arbitrary-precision integers.
+    const Vector vectors[] = {
+        {"2^64", unlock_pdf::util::keyspace_power(2, 64), "18446744073709551616"},
+        {"(2^64-1)^2", max64 * max64, "340282366920938463426481119284349108225"},
+        {"2^64*3", Keyspace::from_parts(1, 0) * 3, "55340232221128654848"},
+        {"10^38", unlock_pdf::util::keyspace_power(10, 38), "100000000000000000000000000000000000000"},
+        {"95^19", unlock_pdf::util::keyspace_power(95, 19), "37735360253530761511306362152099609375"},
+        {"95^20", unlock_pdf::util::keyspace_power(95, 20), ">340282366920938463463374607431768211455"},
+        {"2^128", unlock_pdf::util::keyspace_power(2, 128), ">340282366920938463463374607431768211455"},
+        {"(2^128-1)+1", Keyspace::from_parts(~std::uint64_t{0}, ~std::uint64_t{0}) + 1,
+         ">340282366920938463463374607431768211455"},
+        {"(2^64-1)+1", max64 + 1, "18446744073709551616"},
+        {"0*saturated", Keyspace() * Keyspace::saturated(), "0"},
+        {"26^1..26^3", unlock_pdf::util::charset_keyspace(26, 1, 3), "18278"},
+        {"95^1..95^8", unlock_pdf::util::charset_keyspace(95, 1, 8), "6704780954517120"},
+        {"2^64-1", unlock_pdf::util::keyspace_power(2, 64).saturating_sub(1), "18446744073709551615"},
+        {"5-7", Keyspace(5).saturating_sub(7), "0"},
+    };
+
+    checker.begin("Keyspace 128-bit arithmetic");
+    for (const auto& vector : vectors) {
+        std::string decimal = vector.value.to_string();
+        checker.expect(decimal == vector.decimal,
+                       std::string(vector.label) + " (got " + decimal + ", expected " + vector.decimal + ")");
+    }
+    checker.expect(unlock_pdf::util::keyspace_power(95, 20).overflowed(), "95^20 flagged as overflowed");
+    checker.expect(!(max64 * max64).overflowed(), "(2^64-1)^2 not flagged");
+    checker.expect((max64 + 0).fits_uint64() && !(max64 + 1).fits_uint64(), "fits_uint64 boundary");
+    checker.expect(Keyspace(7) < Keyspace::from_parts(1, 0) && !(Keyspace::from_parts(1, 0) < Keyspace(7)),
+                   "ordering across the 64-bit boundary");
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <string>
+
+#include "unit_test.h"
+#include "util/mask.h"
+
+namespace unlock_pdf::tests {
+
+// Sizes and indexed expansions of hashcat masks, then every expansion of a
+// two-position mask against a nested loop with the last position fastest.
+void check_mask(Checker& checker) {
+    struct Vector {
+        const char* mask;
+        std::uint64_t size;
+        std::uint64_t index;
+        std::string expected;
+    };
+    const Vector vectors[] = {
+        {"19?d?d", 100, 0, "1900"},
+        {"19?d?d", 100, 57, "1957"},
+        {"19?d?d", 100, 99, "1999"},
+        {"?l?u", 676, 27, "bB"},
+        {"?l?u", 676, 675, "zZ"},
+        {"?s", 33, 0, " "},
+        {"?s", 33, 32, "~"},
+        {"?a", 95, 0, "a"},
+        {"?a", 95, 61, "9"},
+        {"?a", 95, 94, "~"},
+        {"?h?H", 256, 171, "aB"},
+        {"??x", 1, 0, "?x"},
+        {"?b", 256, 200, std::string(1, '\xc8')},
+        {"?b?b?b?b?b?b?b?d", 720575940379279360ULL, 720575940379279359ULL, std::string(7, '\xff') + "9"},
+    };
+
+    checker.begin("Mask expansion");
+    for (const auto& vector : vectors) {
+        unlock_pdf::util::Mask mask;
+        std::string error;
+        if (!checker.expect(unlock_pdf::util::Mask::parse(vector.mask, mask, error),
+                            std::string("parse '") + vector.mask + "' (" + error + ")")) {
+            continue;
+        }
+        checker.expect(mask.size() == vector.size, std::string("'") + vector.mask + "' size");
+        std::string out;
+        mask.expansion(vector.index, out);
+        checker.expect(out == vector.expected,
+                       std::string("'") + vector.mask + "' expansion " + std::to_string(vector.index));
+    }
+
+    unlock_pdf::util::Mask mask;
+    std::string error;
+    if (checker.expect(unlock_pdf::util::Mask::parse("?d-?h", mask, error), "parse '?d-?h'")) {
+        const std::string digits = "0123456789";
+        const std::string hex = "0123456789abcdef";
+        bool ordered = mask.size() == digits.size() * hex.size();
+        std::uint64_t index = 0;
+        std::string out;
+        for (std::size_t i = 0; ordered && i < digits.size(); ++i) {
+            for (std::size_t j = 0; ordered && j < hex.size(); ++j) {
+                mask.expansion(index++, out);
+                ordered = out == std::string{digits[i], '-', hex[j]};
+            }
+        }
+        checker.expect(ordered, "'?d-?h' expands in odometer order");
+    }
+    for (const char* text : {"", "abc?", "?z", "?b?b?b?b?b?b?b?b"}) {
+        checker.expect(!unlock_pdf::util::Mask::parse(text, mask, error), std::string("'") + text + "' rejected");
+    }
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
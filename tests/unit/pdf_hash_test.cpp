@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "pdf/encryption/encryption_handler_registry.h"
+#include "pdf/pdf_hash.h"
+#include "pdf/test_pdf_generator.h"
+#include "unit_test.h"
+
+namespace unlock_pdf::tests {
+
+using namespace unlock_pdf::pdf;
+
+// A record extracted from an R3 document whose user password is
+// "summer2019", then every generated variant through format and parse.
+void check_pdf_hash(Checker& checker, std::mt19937& rng) {
+    const std::string record =
+        "$pdf$2*3*128*-4*1*16*5fb1e0e8f84953c6921d98cb4c70e903*32*"
+        "ce8140ce917bd298e5aed90e7be0f0041e82606228c1ba93937249e67d8d9ad2*32*"
+        "2c72d83aab256bda611a184cd598470caaca76895bc64a83bda20b1a3bf70d1d";
+    auto handlers = create_default_encryption_handlers();
+    auto accepted = [&](const std::string& password, const PDFEncryptInfo& info) {
+        std::string variant;
+        for (const auto* handler : collect_password_handlers(info, handlers)) {
+            if (handler->check_password(password, info, variant)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    checker.begin("Hash records (format/parse)");
+    CrackTarget target;
+    std::string error;
+    if (checker.expect(parse_pdf_hash("doc.pdf:" + record, target, error), "known R3 record parses")) {
+        checker.expect(target.label == "doc.pdf", "label before the record");
+        checker.expect(target.info.revision == 3 && target.info.permissions == -4 && target.info.encrypt_metadata,
+                       "numeric fields");
+        checker.expect_hex(target.info.id, "5fb1e0e8f84953c6921d98cb4c70e903", "ID field");
+        checker.expect(accepted("summer2019", target.info), "known R3 record opens with its password");
+        std::string formatted;
+        checker.expect(format_pdf_hash(target.info, formatted, error) && formatted == record,
+                       "known R3 record formats back unchanged");
+    }
+    // Some writers print /P as unsigned 32-bit; a trailing '*' is tolerated.
+    std::string unsigned_p = record;
+    unsigned_p.replace(unsigned_p.find("*-4*"), 4, "*4294967292*");
+    checker.expect(parse_pdf_hash(unsigned_p + "*", target, error) && target.info.permissions == -4,
+                   "unsigned /P and trailing '*' accepted");
+
+    const std::string malformed[] = {
+        record.substr(0, record.rfind('*')),                          // O missing
+        std::string(record).replace(record.find("*16*"), 4, "*15*"),  // ID length mismatch
+        std::string(record).replace(record.find("5fb1"), 4, "5fz1"),  // not hex
+        std::string(record).replace(5, 3, "2*9"),                     // revision 9
+        "pdf$" + record.substr(5),                                    // no prefix
+    };
+    for (const std::string& line : malformed) {
+        checker.expect(!parse_pdf_hash(line, target, error), "malformed record rejected: " + line.substr(0, 48));
+    }
+
+    static const std::pair<int, TestPdfCipher> variants[] = {
+        {2, TestPdfCipher::Rc4},
+        {3, TestPdfCipher::Rc4},
+        {4, TestPdfCipher::Rc4},
+        {4, TestPdfCipher::Aes},
+        {5, TestPdfCipher::Aes},
+        {6, TestPdfCipher::Aes},
+    };
+    for (const auto& [revision, cipher] : variants) {
+        TestPdfOptions options;
+        options.revision = revision;
+        options.cipher = cipher;
+        options.user_password = random_password(rng, 9);
+        options.owner_password = random_password(rng, 11);
+        options.seed = static_cast<std::uint32_t>(rng()) | 1u;
+        std::string label = describe_test_pdf(options);
+        std::string pdf;
+        PDFEncryptInfo info;
+        std::string formatted;
+        std::string reformatted;
+        if (!checker.expect(build_test_pdf(options, pdf, info), label + ": build") ||
+            !checker.expect(format_pdf_hash(info, formatted, error), label + ": format") ||
+            !checker.expect(parse_pdf_hash(formatted, target, error), label + ": parse")) {
+            continue;
+        }
+        checker.expect(format_pdf_hash(target.info, reformatted, error) && reformatted == formatted,
+                       label + ": round trip");
+        checker.expect(accepted(options.user_password, target.info), label + ": parsed record opens");
+        checker.expect(document_digest(target.info) == document_digest(info), label + ": same document digest");
+    }
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
@@ -0,0 +1,61 @@
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <string>
+
+#include "unit_test.h"
+#include "util/prince.h"
+
+namespace unlock_pdf::tests {
+
+// The full candidate order of a small word list, worked out by hand and by
+// an independent script: fewer elements first, then smaller chains, the
+// leftmost element turning slowest. Then a list whose eight-word chain
+// passes 2^64 and must be left out.
+void check_prince(Checker& checker) {
+    static const char* const expected[] = {
+        "a", "ddd", "bb", "cc", "aa", "addd", "ddda", "abb", "acc", "bba", "cca", "bbbb", "bbcc", "ccbb", "cccc",
+    };
+
+    checker.begin("PRINCE chain indexing");
+    unlock_pdf::util::PrinceChains chains;
+    for (const char* word : {"a", "bb", "cc", "bb", "", "ddd"}) {
+        chains.add(word);
+    }
+    std::string error;
+    if (checker.expect(chains.build(1, 4, 2, error), "build 1-4 bytes, 2 elements (" + error + ")")) {
+        checker.expect(chains.words() == 4, "repeated and empty words ignored");
+        checker.expect(chains.size() == std::size(expected) && !chains.truncated(), "candidate count");
+        std::string out;
+        for (std::size_t i = 0; i < std::size(expected) && i < chains.size(); ++i) {
+            chains.candidate(i, out);
+            checker.expect(out == expected[i],
+                           "candidate " + std::to_string(i) + " (got " + out + ", expected " + expected[i] + ")");
+        }
+        std::map<std::size_t, std::uint64_t> lengths = chains.length_counts();
+        checker.expect(lengths == std::map<std::size_t, std::uint64_t>{{1, 1}, {2, 3}, {3, 5}, {4, 6}},
+                       "candidates per length");
+    }
+    if (checker.expect(chains.build(3, 4, 2, error), "build 3-4 bytes, 2 elements (" + error + ")")) {
+        std::string out;
+        chains.candidate(0, out);
+        checker.expect(chains.size() == 11 && out == "ddd", "shorter chains left out");
+    }
+    checker.expect(!chains.build(1, 4, 0, error) && !chains.build(1, 4, 9, error), "element count outside 1-8");
+    checker.expect(!chains.build(5, 4, 2, error), "inverted length range");
+    checker.expect(!chains.build(9, 12, 2, error), "no chain long enough");
+
+    unlock_pdf::util::PrinceChains bytes;
+    for (int byte = 0; byte < 256; ++byte) {
+        bytes.add(std::string(1, static_cast<char>(byte)));
+    }
+    if (checker.expect(bytes.build(1, 8, 8, error), "build 256 one-byte words, 8 elements (" + error + ")")) {
+        std::string out;
+        bytes.candidate(bytes.size() - 1, out);
+        checker.expect(bytes.truncated() && bytes.size() == 72340172838076672ULL, "2^64 chain left out");
+        checker.expect(out == std::string(7, '\xff'), "last candidate before the cut");
+    }
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
@@ -0,0 +1,113 @@
+#include <string>
+
+#include "unit_test.h"
+#include "util/rule_engine.h"
+
+namespace unlock_pdf::tests {
+
+// Expected results are the examples of the hashcat rule reference
+// ("p@ssW0rd" throughout) plus the out-of-range and rejection cases it
+// describes; an empty expectation means the word is rejected.
+void check_rules(Checker& checker) {
+    struct Vector {
+        const char* rule;
+        const char* word;
+        const char* expected;
+    };
+    static const Vector vectors[] = {
+        {":", "p@ssW0rd", "p@ssW0rd"},
+        {"l", "p@ssW0rd", "p@ssw0rd"},
+        {"u", "p@ssW0rd", "P@SSW0RD"},
+        {"c", "p@ssW0rd", "P@ssw0rd"},
+        {"C", "p@ssW0rd", "p@SSW0RD"},
+        {"t", "p@ssW0rd", "P@SSw0RD"},
+        {"T3", "p@ssW0rd", "p@sSW0rd"},
+        {"TA", "passwordabcd", "passwordabCd"},
+        {"r", "p@ssW0rd", "dr0Wss@p"},
+        {"d", "p@ssW0rd", "p@ssW0rdp@ssW0rd"},
+        {"p2", "p@ssW0rd", "p@ssW0rdp@ssW0rdp@ssW0rd"},
+        {"f", "p@ssW0rd", "p@ssW0rddr0Wss@p"},
+        {"{", "p@ssW0rd", "@ssW0rdp"},
+        {"}", "p@ssW0rd", "dp@ssW0r"},
+        {"$1", "p@ssW0rd", "p@ssW0rd1"},
+        {"^1", "p@ssW0rd", "1p@ssW0rd"},
+        {"[", "p@ssW0rd", "@ssW0rd"},
+        {"]", "p@ssW0rd", "p@ssW0r"},
+        {"D3", "p@ssW0rd", "p@sW0rd"},
+        {"x04", "p@ssW0rd", "p@ss"},
+        {"O12", "p@ssW0rd", "psW0rd"},
+        {"i4!", "p@ssW0rd", "p@ss!W0rd"},
+        {"o3$", "p@ssW0rd", "p@s$W0rd"},
+        {"'6", "p@ssW0rd", "p@ssW0"},
+        {"ss$", "p@ssW0rd", "p@$$W0rd"},
+        {"@s", "p@ssW0rd", "p@W0rd"},
+        {"z2", "p@ssW0rd", "ppp@ssW0rd"},
+        {"Z2", "p@ssW0rd", "p@ssW0rddd"},
+        {"q", "p@ssW0rd", "pp@@ssssWW00rrdd"},
+        {"k", "p@ssW0rd", "@pssW0rd"},
+        {"K", "p@ssW0rd", "p@ssW0dr"},
+        {"*34", "p@ssW0rd", "p@sWs0rd"},
+        {"L2", "p@ssW0rd", "p@\xe6sW0rd"},
+        {"R2", "p@ssW0rd", "p@9sW0rd"},
+        {"+2", "p@ssW0rd", "p@tsW0rd"},
+        {"-1", "p@ssW0rd", "p?ssW0rd"},
+        {".1", "p@ssW0rd", "psssW0rd"},
+        {",1", "p@ssW0rd", "ppssW0rd"},
+        {"y2", "p@ssW0rd", "p@p@ssW0rd"},
+        {"Y2", "p@ssW0rd", "p@ssW0rdrd"},
+        {"E", "p@ssW0rd w0rld", "P@ssw0rd W0rld"},
+        {"e-", "pass-word", "Pass-Word"},
+        {"c $1 $2", "password", "Password12"},
+        {"sa@ so0 ]", "password", "p@ssw0r"},
+        // Positions past the end leave the word unchanged.
+        {"D9", "p@ssW0rd", "p@ssW0rd"},
+        {"T9", "p@ssW0rd", "p@ssW0rd"},
+        {"o9x", "p@ssW0rd", "p@ssW0rd"},
+        {"x57", "p@ssW0rd", "p@ssW0rd"},
+        {"*09", "p@ssW0rd", "p@ssW0rd"},
+        // Rejections.
+        {"<7", "p@ssW0rd", ""},
+        {"<8", "p@ssW0rd", "p@ssW0rd"},
+        {">9", "p@ssW0rd", ""},
+        {">8", "p@ssW0rd", "p@ssW0rd"},
+        {"_7", "p@ssW0rd", ""},
+        {"_8", "p@ssW0rd", "p@ssW0rd"},
+        {"!@", "p@ssW0rd", ""},
+        {"!z", "p@ssW0rd", "p@ssW0rd"},
+        {"/z", "p@ssW0rd", ""},
+        {"/@", "p@ssW0rd", "p@ssW0rd"},
+        {"(@", "p@ssW0rd", ""},
+        {"(p", "p@ssW0rd", "p@ssW0rd"},
+        {")r", "p@ssW0rd", ""},
+        {")d", "p@ssW0rd", "p@ssW0rd"},
+        {"=1p", "p@ssW0rd", ""},
+        {"=1@", "p@ssW0rd", "p@ssW0rd"},
+        {"%3s", "p@ssW0rd", ""},
+        {"%2s", "p@ssW0rd", "p@ssW0rd"},
+        {"]]]]]]]]", "p@ssW0rd", ""},
+    };
+
+    checker.begin("Rules (hashcat reference)");
+    for (const auto& vector : vectors) {
+        unlock_pdf::util::Rule rule;
+        std::string error;
+        if (!checker.expect(unlock_pdf::util::Rule::parse(vector.rule, rule, error),
+                            std::string("parse '") + vector.rule + "' (" + error + ")")) {
+            continue;
+        }
+        std::string out;
+        bool kept = rule.apply(vector.word, out);
+        std::string actual = kept ? out : std::string();
+        checker.expect(actual == vector.expected,
+                       std::string("'") + vector.rule + "' on " + vector.word + " (got \"" + actual +
+                           "\", expected \"" + vector.expected + "\")");
+    }
+    for (const char* text : {"T", "s@", "Q", "x0", "i"}) {
+        unlock_pdf::util::Rule rule;
+        std::string error;
+        checker.expect(!unlock_pdf::util::Rule::parse(text, rule, error), std::string("'") + text + "' rejected");
+    }
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+#include <system_error>
+
+#include "pdf/session_coverage.h"
+#include "unit_test.h"
+
+namespace unlock_pdf::tests {
+
+using unlock_pdf::pdf::IntervalSet;
+using unlock_pdf::pdf::SessionCoverage;
+
+namespace {
+
+std::string describe_ranges(const IntervalSet& set) {
+    std::string text;
+    for (const IntervalSet::Range& range : set.ranges()) {
+        text += (text.empty() ? "" : ",") + std::to_string(range.first) + "-" + std::to_string(range.second);
+    }
+    return text;
+}
+
+}  // namespace
+
+// Merging, counting and intersection on hand-checked ranges, then two
+// databases saved one after the other, which must keep both records.
+void check_interval_set(Checker& checker, std::mt19937& rng) {
+    checker.begin("IntervalSet and coverage database");
+    auto expect_ranges = [&](const IntervalSet& set, const std::string& expected, const std::string& what) {
+        std::string actual = describe_ranges(set);
+        checker.expect(actual == expected, what + " (got " + actual + ", expected " + expected + ")");
+    };
+
+    IntervalSet set;
+    set.add(10, 20);
+    set.add(30, 40);
+    set.add(5, 5);
+    expect_ranges(set, "10-20,30-40", "disjoint ranges kept apart, empty range ignored");
+    set.add(20, 25);
+    expect_ranges(set, "10-25,30-40", "adjacent range merged");
+    set.add(50, 60);
+    set.add(24, 52);
+    expect_ranges(set, "10-60", "range bridging three merged");
+    set.add(0, 3);
+    set.add(std::numeric_limits<std::uint64_t>::max() - 1, std::numeric_limits<std::uint64_t>::max());
+    expect_ranges(set, "0-3,10-60,18446744073709551614-18446744073709551615", "ranges at both ends");
+
+    checker.expect(set.count_within(0, 100) == 53, "count_within over everything");
+    checker.expect(set.count_within(2, 12) == 3, "count_within across a gap");
+    checker.expect(set.count_within(3, 10) == 0, "count_within inside a gap");
+    checker.expect(set.count_within(20, 20) == 0, "count_within of an empty range");
+    checker.expect(set.contains(10) && !set.contains(60) && !set.contains(3), "contains at the boundaries");
+    checker.expect(set.covers(10, 60) && !set.covers(9, 60) && set.covers(7, 7), "covers");
+
+    IntervalSet other;
+    other.add(2, 12);
+    other.add(55, 70);
+    expect_ranges(set.intersect(other), "2-3,10-12,55-60", "intersect");
+    expect_ranges(IntervalSet().intersect(set), "", "intersect with an empty set");
+
+    checker.expect(SessionCoverage::generator_kind("wordlist:ab12") == "wordlist", "kind of a plain wordlist");
+    checker.expect(SessionCoverage::generator_kind("wordlist:ab12:rules:cd34") == "wordlist:rules",
+                   "kind of a rule-expanded wordlist");
+    checker.expect(SessionCoverage::generator_kind("mask:ef56+wordlist:ab12") == "mask+wordlist",
+                   "kind of a prepended mask");
+    checker.expect(SessionCoverage::generator_kind("prince:wordlist:ab12:4:1-16") == "prince", "kind of PRINCE");
+    SessionCoverage kinds;
+    kinds.add("doc", "mask:ef56+wordlist:ab12", set);
+    kinds.add("doc", "wordlist:ab12:rules:cd34", set);
+    checker.expect(!kinds.has_records("doc", "wordlist"), "combined and rule records are not plain wordlist ones");
+    checker.expect(kinds.has_records("doc", "mask+wordlist") && kinds.has_records("doc", "wordlist:rules"),
+                   "records found by kind");
+    checker.expect(!kinds.has_records("doc2", "mask+wordlist"), "records of another document ignored");
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("unlock_pdf_unit_test_" + std::to_string(rng()) + ".tsv");
+    std::string error;
+    SessionCoverage first;
+    SessionCoverage second;
+    if (checker.expect(first.open(path.string(), error) && second.open(path.string(), error), "open database")) {
+        first.add("doc", "gen", set);
+        second.add("doc", "gen", other);
+        second.add("doc2", "gen", other);
+        checker.expect(first.save(error) && second.save(error), "save from two handles");
+        SessionCoverage merged;
+        if (checker.expect(merged.open(path.string(), error), "reopen database")) {
+            IntervalSet both = set;
+            both.add(other);
+            expect_ranges(merged.covered({"doc"}, "gen"), describe_ranges(both), "earlier save merged, not replaced");
+            expect_ranges(merged.covered({"doc", "doc2"}, "gen"), "2-12,55-70", "covered by both documents");
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path.string() + ".lock", ec);
+    checker.end();
+}
+
+}  // namespace unlock_pdf::tests
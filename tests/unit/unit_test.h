@@ -0,0 +1,103 @@
+#ifndef UNLOCK_PDF_TESTS_UNIT_TEST_H
+#define UNLOCK_PDF_TESTS_UNIT_TEST_H
+
+#include <cstddef>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/hex.h"
+
+namespace unlock_pdf::tests {
+
+using Bytes = std::vector<unsigned char>;
+
+inline Bytes from_hex(const std::string& hex) {
+    Bytes data;
+    data.reserve(hex.size() / 2);
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 2) {
+        data.push_back(static_cast<unsigned char>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return data;
+}
+
+inline Bytes to_bytes(const std::string& text) {
+    return Bytes(text.begin(), text.end());
+}
+
+inline std::string random_password(std::mt19937& rng, std::size_t length) {
+    std::uniform_int_distribution<int> printable(0x21, 0x7e);
+    std::string password(length, ' ');
+    for (auto& ch : password) {
+        ch = static_cast<char>(printable(rng));
+    }
+    return password;
+}
+
+// Collects results per group so a failing run names the exact check and the
+// inputs that broke it, while a passing run stays a handful of lines. Same
+// report format as crypto_bench --verify.
+class Checker {
+public:
+    Checker(std::ostream& out, bool verbose) : out_(out), verbose_(verbose) {}
+
+    void begin(const std::string& group) {
+        group_ = group;
+        group_passed_ = 0;
+        group_failed_ = 0;
+    }
+
+    bool expect(bool ok, const std::string& what) {
+        if (ok) {
+            ++group_passed_;
+        } else {
+            ++group_failed_;
+            out_ << "  FAIL " << group_ << ": " << what << '\n';
+        }
+        return ok;
+    }
+
+    bool expect_hex(const Bytes& actual, const std::string& expected, const std::string& what) {
+        std::string hex = unlock_pdf::util::to_hex(actual);
+        if (hex == expected) {
+            return expect(true, what);
+        }
+        return expect(false, what + " (got " + hex + ", expected " + expected + ")");
+    }
+
+    void end() {
+        passed_ += group_passed_;
+        failed_ += group_failed_;
+        if (verbose_ || group_failed_ > 0) {
+            out_ << "  " << (group_failed_ == 0 ? "ok  " : "FAIL") << "  " << group_ << " (" << group_passed_ << '/'
+                 << (group_passed_ + group_failed_) << ")\n";
+        }
+    }
+
+    std::size_t passed() const { return passed_; }
+    std::size_t failed() const { return failed_; }
+
+private:
+    std::ostream& out_;
+    bool verbose_ = false;
+    std::string group_;
+    std::size_t group_passed_ = 0;
+    std::size_t group_failed_ = 0;
+    std::size_t passed_ = 0;
+    std::size_t failed_ = 0;
+};
+
+// One entry point per feature, each in its own <feature>_test.cpp.
+void check_keyspace(Checker& checker);
+void check_inflate(Checker& checker);
+void check_png_predictor(Checker& checker);
+void check_pdf_hash(Checker& checker, std::mt19937& rng);
+void check_interval_set(Checker& checker, std::mt19937& rng);
+void check_rules(Checker& checker);
+void check_mask(Checker& checker);
+void check_prince(Checker& checker);
+
+}  // namespace unlock_pdf::tests
+
+#endif  // UNLOCK_PDF_TESTS_UNIT_TEST_H
@@ -0,0 +1,60 @@
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "unit_test.h"
+
+namespace {
+
+void print_help(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n\n"
+              << "Checks the parsers, candidate generators and stores against known results.\n"
+              << "The crypto kernels are checked by crypto_bench --verify.\n\n"
+              << "Options:\n"
+              << "  --seed <n>           Seed for the randomized inputs (default: random)\n"
+              << "  --verbose            List every group, not only failures\n"
+              << "  --help               Show this help message\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::uint32_t seed = 0;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        if (arg == "--help" || arg == "-h") {
+            print_help(argv[0]);
+            return 0;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else {
+            throw std::runtime_error("Unknown option: " + std::string(arg));
+        }
+    }
+
+    if (seed == 0) {
+        seed = std::random_device{}();
+    }
+    std::mt19937 rng(seed);
+    unlock_pdf::tests::Checker checker(std::cout, verbose);
+
+    unlock_pdf::tests::check_keyspace(checker);
+    unlock_pdf::tests::check_inflate(checker);
+    unlock_pdf::tests::check_png_predictor(checker);
+    unlock_pdf::tests::check_pdf_hash(checker, rng);
+    unlock_pdf::tests::check_interval_set(checker, rng);
+    unlock_pdf::tests::check_rules(checker);
+    unlock_pdf::tests::check_mask(checker);
+    unlock_pdf::tests::check_prince(checker);
+
+    std::cout << (checker.failed() == 0 ? "PASSED" : "FAILED") << ": " << checker.passed() << " checks passed, "
+              << checker.failed() << " failed (seed " << seed << ")" << std::endl;
+    return checker.failed() == 0 ? 0 : 1;
+}